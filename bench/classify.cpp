@@ -0,0 +1,219 @@
+/*
+ * Copyright (c) Przemyslaw Skibinski <inikep@gmail.com>
+ * All rights reserved.
+ *
+ * This source code is dual-licensed under the GPLv2 and GPLv3 licenses.
+ * For additional details, refer to the LICENSE file located in the root
+ * directory of this source tree.
+ *
+ * classify.cpp: data class of every input and the best codec per class (--classify)
+ *
+ * Every input (a file, a -m part or the joined files of -j) is tagged with a class from magic
+ * bytes and statistics of up to CLASSIFY_BLOCKS sampled blocks: compressed, executable, text,
+ * utf8, numeric (text tables of numbers), structured (binary with 2-4 byte records, e.g. audio
+ * samples, found by the libbsc record size detector) or binary. After the benchmark the results
+ * of each class are summed over its files and the best codec is reported (by ratio, or by
+ * --recommend queries).
+ */
+
+#include "lzbench.h"
+#include <algorithm> // find
+#include <math.h>    // log2
+#include <string.h>
+
+#ifndef BENCH_REMOVE_BSC
+#include "bwt/libbsc/libbsc/libbsc.h"
+#include "bwt/libbsc/libbsc/filters.h"
+#endif
+
+#define CLASSIFY_BLOCKS       16
+#define CLASSIFY_BLOCK_SIZE   (64 << 10)
+#define CLASSIFY_TEXT_SHARE   0.98   // printable ASCII, whitespace and valid UTF-8 sequences
+#define CLASSIFY_DIGIT_SHARE  0.6    // digits and number punctuation among non-whitespace text
+#define CLASSIFY_ENTROPY      7.9    // order-0 bits per byte of compressed or encrypted data
+
+typedef struct
+{
+    size_t size;
+    const char* magic;
+} magic_t;
+
+static const magic_t compressed_magics[] = {
+    { 2, "\x1F\x8B" }, { 4, "\x28\xB5\x2F\xFD" }, { 6, "\xFD" "7zXZ\x00" }, { 3, "BZh" }, { 4, "\x04\x22\x4D\x18" },
+    { 4, "PK\x03\x04" }, { 6, "7z\xBC\xAF\x27\x1C" }, { 4, "Rar!" }, { 8, "\x89PNG\r\n\x1A\n" }, { 3, "\xFF\xD8\xFF" },
+    { 0, NULL }
+};
+static const magic_t executable_magics[] = {
+    { 4, "\x7F" "ELF" }, { 2, "MZ" }, { 4, "\xCF\xFA\xED\xFE" }, { 4, "\xCE\xFA\xED\xFE" }, { 0, NULL }
+};
+
+
+static bool has_magic(const uint8_t* buf, size_t size, const magic_t* magics)
+{
+    for (int i=0; magics[i].magic; i++)
+        if (size >= magics[i].size && !memcmp(buf, magics[i].magic, magics[i].size))
+            return true;
+    return false;
+}
+
+
+// the length of a valid UTF-8 multi-byte sequence at p, 0 if there is none
+static size_t utf8_sequence(const uint8_t* p, const uint8_t* end)
+{
+    size_t len = (*p >= 0xC2 && *p <= 0xDF) ? 2 : (*p >= 0xE0 && *p <= 0xEF) ? 3 : (*p >= 0xF0 && *p <= 0xF4) ? 4 : 0;
+    if (len == 0 || (size_t)(end - p) < len) return 0;
+    for (size_t i=1; i<len; i++)
+        if ((p[i] & 0xC0) != 0x80) return 0;
+    return len;
+}
+
+
+const char* lzbench_classify(const uint8_t* inbuf, size_t insize)
+{
+    std::vector<uint8_t> sample;
+    uint64_t hist[256] = { 0 };
+    size_t text = 0, utf8 = 0, digits = 0, visible = 0;
+
+    if (insize == 0) return "binary";
+    if (has_magic(inbuf, insize, compressed_magics)) return "compressed";
+    if (has_magic(inbuf, insize, executable_magics)) return "executable";
+
+    if (insize <= CLASSIFY_BLOCKS * CLASSIFY_BLOCK_SIZE)
+        sample.assign(inbuf, inbuf + insize);
+    else
+        for (size_t b=0; b<CLASSIFY_BLOCKS; b++)
+        {
+            const uint8_t* block = inbuf + (insize - CLASSIFY_BLOCK_SIZE) / (CLASSIFY_BLOCKS - 1) * b;
+            sample.insert(sample.end(), block, block + CLASSIFY_BLOCK_SIZE);
+        }
+
+    const uint8_t* end = &sample[0] + sample.size();
+    for (const uint8_t* p = &sample[0]; p < end; )
+    {
+        size_t len;
+        hist[*p]++;
+        if ((*p >= 0x20 && *p < 0x7F) || *p == '\t' || *p == '\n' || *p == '\r' || *p == '\f') {
+            text++;
+            if (*p > 0x20) visible++;
+            if ((*p >= '0' && *p <= '9') || *p == '.' || *p == ',' || *p == ';' || *p == '-' || *p == '+' || *p == 'e' || *p == 'E') digits++;
+            p++;
+        } else if ((len = utf8_sequence(p, end)) != 0) {
+            for (size_t i=1; i<len; i++) hist[p[i]]++;
+            utf8 += len;
+            visible++;
+            p += len;
+        } else
+            p++;
+    }
+
+    if (text + utf8 >= CLASSIFY_TEXT_SHARE * sample.size())
+    {
+        if (visible && digits >= CLASSIFY_DIGIT_SHARE * visible) return "numeric";
+        return (utf8 * 1000 > sample.size()) ? "utf8" : "text";
+    }
+
+    double entropy = 0;
+    for (int i=0; i<256; i++)
+        if (hist[i]) entropy -= hist[i] * log2((double)hist[i] / sample.size());
+    if (entropy / sample.size() >= CLASSIFY_ENTROPY) return "compressed";
+
+#ifndef BENCH_REMOVE_BSC
+    if (sample.size() >= 4096 && bsc_detect_recordsize(&sample[0], (int)sample.size(), LIBBSC_FEATURE_FASTMODE) > 1)
+        return "structured";
+#endif
+    return "binary";
+}
+
+
+/*
+ * Sums results of every codec/level/parameters over the files of each class (codecs that
+ * failed on a file of the class are left out) and answers the --recommend queries, or
+ * "ratio" by default, for every class.
+ */
+void lzbench_classify_report(lzbench_params_t *params)
+{
+    std::vector<std::string> classes;
+    std::vector<pareto_query_t> queries = params->recommend;
+
+    if (queries.empty()) {
+        pareto_query_t q;
+        pareto_parse_query("ratio", q);
+        queries.push_back(q);
+    }
+
+    for (size_t i=0; i<params->results.size(); i++)
+        if (!params->results[i].data_class.empty() && std::find(classes.begin(), classes.end(), params->results[i].data_class) == classes.end())
+            classes.push_back(params->results[i].data_class);
+
+    for (size_t c=0; c<classes.size(); c++)
+    {
+        std::vector<std::string> files;
+        std::vector<string_table_t> rows;
+        std::vector<int> counts;
+        uint64_t size = 0;
+
+        for (size_t i=0; i<params->results.size(); i++)
+        {
+            const string_table_t& r = params->results[i];
+            if (r.data_class != classes[c]) continue;
+            if (std::find(files.begin(), files.end(), r.col6_filename) == files.end()) {
+                files.push_back(r.col6_filename);
+                size += r.col5_origsize;
+            }
+
+            size_t j;
+            for (j=0; j<rows.size(); j++)
+                if (rows[j].codec == r.codec && rows[j].level == r.level && rows[j].codec_params == r.codec_params && (rows[j].chunk_size == r.chunk_size || params->chunk_sweep.size() <= 1))
+                    break;
+            if (j == rows.size()) {
+                rows.push_back(string_table_t(r.col1_algname, 0, 0, 0, 0, ""));
+                rows.back().codec = r.codec;
+                rows.back().level = r.level;
+                rows.back().codec_params = r.codec_params;
+                rows.back().chunk_size = r.chunk_size;
+                counts.push_back(0);
+            }
+            if (!r.col2_ctime || (!r.col3_dtime && !params->compress_only)) counts[j] = -1;
+            if (counts[j] < 0) continue;
+            counts[j]++;
+            rows[j].col2_ctime += r.col2_ctime;
+            rows[j].col3_dtime += r.col3_dtime;
+            rows[j].col4_comprsize += r.col4_comprsize;
+            rows[j].col5_origsize += r.col5_origsize;
+        }
+
+        std::vector<string_table_t> complete;
+        std::string label;
+        if (params->textformat == NDJSON)
+            label = classes[c];
+        else
+            format(label, "class %s", classes[c].c_str());
+        for (size_t j=0; j<rows.size(); j++)
+            if (counts[j] == (int)files.size()) {
+                complete.push_back(rows[j]);
+                complete.back().col6_filename = label;
+            }
+
+        if (params->textformat == NDJSON)
+        {
+            printf("{\"type\":\"class\",\"class\":%s,\"size\":%llu,\"files\":[", json_string(classes[c]).c_str(), (unsigned long long)size);
+            for (size_t f=0; f<files.size(); f++)
+                printf("%s%s", f ? "," : "", json_string(files[f]).c_str());
+            printf("],\"codecs\":%d}\n", (int)complete.size());
+            for (size_t q=0; q<queries.size() && !complete.empty(); q++)
+                pareto_recommend_json(queries[q], complete, "class");
+            continue;
+        }
+
+        printf("\nClass %s: %d files, %llu bytes (", classes[c].c_str(), (int)files.size(), (unsigned long long)size);
+        for (size_t f=0; f<files.size() && f<5; f++)
+            printf("%s%s", f ? ", " : "", files[f].c_str());
+        printf("%s)\n", files.size() > 5 ? ", ..." : "");
+        if (complete.empty()) {
+            printf("  no codec succeeded on all files of the class\n");
+            continue;
+        }
+        for (size_t q=0; q<queries.size(); q++)
+            pareto_recommend(queries[q], complete);
+    }
+}
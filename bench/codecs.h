@@ -12,19 +12,30 @@
 
 #include <stdlib.h>
 #include <stdint.h> // int64_t
-
-typedef struct
-{
-    int level;
-    int additional_param;
-    char* work_mem;
-//    int threads;
-} codec_options_t;
+#include "lzbench_plugin.h" // codec_options_t, LZBENCH_CAP_*
 
 
 
 int64_t lzbench_memcpy(char *inbuf, size_t insize, char *outbuf, size_t outsize, codec_options_t *codec_options);
 
+// fallback.cpp: incompressible chunk detection shared by --store-fallback and the auto codec
+#define STORE_MIN_ENTROPY   7.8    // bits per byte
+double lzbench_sample_entropy(const uint8_t* chunk, size_t size);
+bool lzbench_sample_lz4_incompressible(const uint8_t* chunk, size_t size);
+
+
+#if !defined(BENCH_REMOVE_LZ4) && !defined(BENCH_REMOVE_ZSTD)
+    char* lzbench_auto_init(size_t insize, size_t level, size_t);
+    void lzbench_auto_deinit(char* workmem);
+    int64_t lzbench_auto_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, codec_options_t *codec_options);
+    int64_t lzbench_auto_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, codec_options_t *codec_options);
+#else
+    #define lzbench_auto_init NULL
+    #define lzbench_auto_deinit NULL
+    #define lzbench_auto_compress NULL
+    #define lzbench_auto_decompress NULL
+#endif
+
 
 #ifndef BENCH_REMOVE_BRIEFLZ
     char* lzbench_brieflz_init(size_t insize, size_t level, size_t);
@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) Przemyslaw Skibinski <inikep@gmail.com>
+ * All rights reserved.
+ *
+ * This source code is dual-licensed under the GPLv2 and GPLv3 licenses.
+ * For additional details, refer to the LICENSE file located in the root
+ * directory of this source tree.
+ *
+ * corpus.cpp: aggregate rows over all input files (--corpus)
+ *
+ * Every file is benchmarked separately as without -j, then one row per codec/level/parameters
+ * (and chunk size with a -b list) sums the results: speeds are size-weighted (sum of bytes / sum of times) and the ratio is
+ * the total compressed size over the total size. The file with the worst ratio is shown as well.
+ */
+
+#include "lzbench.h"
+#include <algorithm> // find
+
+
+typedef struct
+{
+    const string_table_t* first;
+    uint64_t origsize, comprsize, ctime, dtime;
+    int files, errors;
+    const string_table_t* worst;  // the file with the largest compressed size relative to its size
+} corpus_row_t;
+
+
+static double row_ratio(const string_table_t& r)
+{
+    return r.col5_origsize ? r.col4_comprsize * 100.0 / r.col5_origsize : 0;
+}
+
+
+static void print_speed_cell(uint64_t origsize, uint64_t nanosec, bool error)
+{
+    double speed = nanosec ? origsize * 1000.0 / nanosec : 0;
+    if (error || speed == 0) printf("      ERROR");
+    else if (speed < 10) printf("%6.2f MB/s", speed);
+    else if (speed < 100) printf("%6.1f MB/s", speed);
+    else printf("%6d MB/s", (int)speed);
+}
+
+
+static void print_json_aggregate(const corpus_row_t& a)
+{
+    const string_table_t& r = *a.first;
+    printf("{\"type\":\"aggregate\",\"name\":%s,\"codec\":%s,\"level\":%d,\"params\":%s,\"chunk_size\":%llu,\"files\":%d,\"errors\":%d",
+           json_string(r.col1_algname).c_str(), json_string(r.codec).c_str(), r.level, json_string(r.codec_params).c_str(), (unsigned long long)r.chunk_size, a.files, a.errors);
+    printf(",\"orig_size\":%llu,\"compr_size\":%llu,\"ctime_ns\":%llu,\"dtime_ns\":%llu", (unsigned long long)a.origsize,
+           (unsigned long long)a.comprsize, (unsigned long long)a.ctime, (unsigned long long)a.dtime);
+    if (a.worst)
+        printf(",\"worst_file\":{\"file\":%s,\"ratio\":%.2f}", json_string(a.worst->col6_filename).c_str(), row_ratio(*a.worst));
+    printf("}\n");
+}
+
+
+void lzbench_corpus_report(lzbench_params_t *params)
+{
+    std::vector<corpus_row_t> rows;
+    std::vector<std::string> files;
+
+    for (size_t i=0; i<params->results.size(); i++)
+    {
+        const string_table_t& r = params->results[i];
+        size_t j;
+        for (j=0; j<rows.size(); j++)
+        {
+            const string_table_t& f = *rows[j].first;
+            if (f.codec == r.codec && f.level == r.level && f.codec_params == r.codec_params && (f.chunk_size == r.chunk_size || params->chunk_sweep.size() <= 1))
+                break;
+        }
+        if (j == rows.size())
+        {
+            corpus_row_t a = { &r, 0, 0, 0, 0, 0, 0, NULL };
+            rows.push_back(a);
+        }
+        if (std::find(files.begin(), files.end(), r.col6_filename) == files.end())
+            files.push_back(r.col6_filename);
+
+        corpus_row_t& a = rows[j];
+        a.files++;
+        if ((!r.col2_ctime && !params->decode_only) || (!r.col3_dtime && !params->compress_only)) { a.errors++; continue; }
+        a.origsize += r.col5_origsize;
+        a.comprsize += r.col4_comprsize;
+        a.ctime += r.col2_ctime;
+        a.dtime += r.col3_dtime;
+        if (!a.worst || row_ratio(r) > row_ratio(*a.worst))
+            a.worst = &r;
+    }
+
+    if (params->textformat == NDJSON)
+    {
+        for (size_t i=0; i<rows.size(); i++)
+            print_json_aggregate(rows[i]);
+        return;
+    }
+
+    printf("\nCorpus totals over %d files (speeds = sum of bytes / sum of times):\n", (int)files.size());
+    printf("Compressor name         Compress. Decompress.  Orig. size  Compr. size  Ratio Files Worst file\n");
+    for (size_t i=0; i<rows.size(); i++)
+    {
+        const corpus_row_t& a = rows[i];
+        printf("%-23s", a.first->col1_algname.c_str());
+        if (params->decode_only) printf("          -");
+        else print_speed_cell(a.origsize, a.ctime, a.errors > 0);
+        if (params->compress_only) printf("           ");
+        else print_speed_cell(a.origsize, a.dtime, a.errors > 0);
+        printf("%12llu %12llu %6.2f %5d", (unsigned long long)a.origsize, (unsigned long long)a.comprsize, a.origsize ? a.comprsize * 100.0 / a.origsize : 0, a.files);
+        if (a.worst) printf(" %6.2f %s", row_ratio(*a.worst), a.worst->col6_filename.c_str());
+        if (a.errors) printf(" (%d errors)", a.errors);
+        printf("\n");
+    }
+}
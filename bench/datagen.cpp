@@ -0,0 +1,234 @@
+/*
+ * Copyright (c) Przemyslaw Skibinski <inikep@gmail.com>
+ * All rights reserved.
+ *
+ * This source code is dual-licensed under the GPLv2 and GPLv3 licenses.
+ * For additional details, refer to the LICENSE file located in the root
+ * directory of this source tree.
+ *
+ * datagen.cpp: reproducible synthetic input (--gen=SPEC)
+ *
+ * Data is generated as an LZ77-like sequence of literal runs and matches:
+ *   size=N       output size, K/M/G suffixes are accepted {16M}
+ *   seed=N       random seed; the same spec always gives the same data {1}
+ *   entropy=H    entropy of literals in bits per byte, 0-8 {8}
+ *   match=F      fraction of the output produced by matches, 0-1 {0.5}
+ *   mlen=D       match length distribution: geo:MEAN or zipf:S (4-258) {geo:8}
+ *   moff=D       match offset distribution: geo:MEAN or zipf:S (1-window) {zipf:1.1}
+ *   window=N     the largest match offset {1M}
+ *   text=F       fraction of literal runs that are English words instead of random literals {0}
+ * e.g. --gen=size=64M,seed=7,entropy=6,match=0.7,mlen=zipf:1.5,text=0.3
+ */
+
+#include "lzbench.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define GEN_MIN_MATCH 4
+#define GEN_MAX_MATCH 258
+
+typedef struct
+{
+    bool zipf;
+    double param;     // mean for geometric, exponent for Zipf
+} gen_dist_t;
+
+typedef struct
+{
+    uint64_t size, seed, window;
+    double entropy, match, text;
+    gen_dist_t mlen, moff;
+} gen_spec_t;
+
+static const char* gen_words[] = {
+    "the", "of", "and", "to", "in", "is", "that", "for", "it", "as", "was", "with", "be", "by", "on", "not",
+    "he", "this", "are", "or", "his", "from", "at", "which", "but", "have", "an", "had", "they", "you", "were", "their",
+    "one", "all", "we", "can", "her", "has", "there", "been", "if", "more", "when", "will", "would", "who", "so", "no",
+    "data", "value", "system", "time", "number", "error", "request", "user", "server", "file", "result", "level", "block", "index", "table", "record"
+};
+
+
+// splitmix64: small, fast and identical on every platform
+static inline uint64_t gen_next(uint64_t& state)
+{
+    uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+static inline double gen_uniform(uint64_t& state)
+{
+    return ((gen_next(state) >> 11) + 0.5) * (1.0 / 9007199254740992.0); // (0,1)
+}
+
+
+// a value from [lo, hi] drawn from a geometric distribution with the given mean or a bounded Zipf (power law)
+static uint64_t gen_sample(uint64_t& state, const gen_dist_t& d, uint64_t lo, uint64_t hi)
+{
+    double u = gen_uniform(state), x;
+
+    if (hi <= lo) return lo;
+    if (d.zipf)
+    {
+        double n = (double)(hi - lo + 1), s = d.param;
+        if (fabs(s - 1.0) < 1e-9)
+            x = pow(n + 1, u);
+        else
+            x = pow((pow(n + 1, 1 - s) - 1) * u + 1, 1 / (1 - s));
+        x = lo + floor(x) - 1;
+    }
+    else
+    {
+        double mean = MAX(d.param - lo + 1, 1.000001);
+        x = lo + floor(log(u) / log(1 - 1 / mean));
+    }
+    return (x > hi) ? hi : (uint64_t)x;
+}
+
+
+static bool parse_size(const char* text, uint64_t& size)
+{
+    char* end;
+    double v = strtod(text, &end);
+    switch (*end)
+    {
+        case 'k': case 'K': v *= 1 << 10; end++; break;
+        case 'm': case 'M': v *= 1 << 20; end++; break;
+        case 'g': case 'G': v *= 1 << 30; end++; break;
+    }
+    if (end == text || *end != 0 || v < 1) return false;
+    size = (uint64_t)v;
+    return true;
+}
+
+
+static bool parse_dist(const char* text, gen_dist_t& d)
+{
+    char* end;
+    if (!strncmp(text, "geo:", 4)) d.zipf = false;
+    else if (!strncmp(text, "zipf:", 5)) d.zipf = true;
+    else return false;
+    d.param = strtod(strchr(text, ':') + 1, &end);
+    return *end == 0 && d.param > 0;
+}
+
+
+static std::string format_size(uint64_t size)
+{
+    std::string s;
+    if (size % (1 << 30) == 0) format(s, "%lluG", (unsigned long long)(size >> 30));
+    else if (size % (1 << 20) == 0) format(s, "%lluM", (unsigned long long)(size >> 20));
+    else if (size % (1 << 10) == 0) format(s, "%lluK", (unsigned long long)(size >> 10));
+    else format(s, "%llu", (unsigned long long)size);
+    return s;
+}
+
+
+static bool parse_spec(const char* text, gen_spec_t& spec)
+{
+    std::vector<std::string> items = split(text, ',');
+
+    spec.size = 16 << 20;
+    spec.seed = 1;
+    spec.window = 1 << 20;
+    spec.entropy = 8;
+    spec.match = 0.5;
+    spec.text = 0;
+    spec.mlen.zipf = false; spec.mlen.param = 8;
+    spec.moff.zipf = true;  spec.moff.param = 1.1;
+
+    for (size_t i=0; i<items.size(); i++)
+    {
+        size_t eq = items[i].find('=');
+        if (items[i].empty()) continue;
+        if (eq == std::string::npos) {
+            fprintf(stderr, "--gen: expected key=value instead of \"%s\"\n", items[i].c_str());
+            return false;
+        }
+        std::string key = items[i].substr(0, eq);
+        const char* value = items[i].c_str() + eq + 1;
+        char* end = NULL;
+        bool ok = true;
+
+        if (key == "size") ok = parse_size(value, spec.size);
+        else if (key == "window") ok = parse_size(value, spec.window);
+        else if (key == "seed") { spec.seed = strtoull(value, &end, 10); ok = (*value && *end == 0); }
+        else if (key == "entropy") { spec.entropy = strtod(value, &end); ok = (*end == 0 && spec.entropy >= 0 && spec.entropy <= 8); }
+        else if (key == "match") { spec.match = strtod(value, &end); ok = (*end == 0 && spec.match >= 0 && spec.match <= 1); }
+        else if (key == "text") { spec.text = strtod(value, &end); ok = (*end == 0 && spec.text >= 0 && spec.text <= 1); }
+        else if (key == "mlen") ok = parse_dist(value, spec.mlen);
+        else if (key == "moff") ok = parse_dist(value, spec.moff);
+        else {
+            fprintf(stderr, "--gen: unknown key \"%s\" (use size, seed, entropy, match, mlen, moff, window or text)\n", key.c_str());
+            return false;
+        }
+        if (!ok) {
+            fprintf(stderr, "--gen: invalid value in \"%s\"\n", items[i].c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
+
+/*
+ * Checks SPEC and returns its canonical form with all defaults filled in,
+ * which is used as the file name of results. Returns an empty string on error.
+ */
+std::string lzbench_gen_spec(const char* text, uint64_t* size)
+{
+    gen_spec_t spec;
+    std::string s;
+
+    if (!parse_spec(text, spec)) return s;
+    format(s, "gen:size=%s,seed=%llu,entropy=%g,match=%g,mlen=%s:%g,moff=%s:%g,window=%s,text=%g",
+           format_size(spec.size).c_str(), (unsigned long long)spec.seed, spec.entropy, spec.match,
+           spec.mlen.zipf ? "zipf" : "geo", spec.mlen.param, spec.moff.zipf ? "zipf" : "geo", spec.moff.param,
+           format_size(spec.window).c_str(), spec.text);
+    if (size) *size = spec.size;
+    return s;
+}
+
+
+// fills buf with the data described by a spec accepted by lzbench_gen_spec(), buf must have the size given in spec
+void lzbench_generate(const char* text, uint8_t* buf)
+{
+    gen_spec_t spec;
+    if (!parse_spec(text, spec)) return;
+
+    uint64_t state = spec.seed;
+    uint64_t pos = 0, matched = 0;
+    uint32_t alphabet = (uint32_t)floor(pow(2.0, spec.entropy) + 0.5); // uniform literals over 2^entropy symbols
+    const int nwords = sizeof(gen_words)/sizeof(gen_words[0]);
+    gen_dist_t literal_run = { false, 8 };
+    if (alphabet < 1) alphabet = 1;
+
+    while (pos < spec.size)
+    {
+        // keep the fraction of matched bytes close to spec.match
+        if (pos >= GEN_MIN_MATCH && matched < spec.match * pos)
+        {
+            uint64_t len = gen_sample(state, spec.mlen, GEN_MIN_MATCH, GEN_MAX_MATCH);
+            uint64_t off = gen_sample(state, spec.moff, 1, MIN(pos, spec.window));
+            len = MIN(len, spec.size - pos);
+            for (uint64_t i=0; i<len; i++, pos++)
+                buf[pos] = buf[pos - off]; // overlapping copies make runs, like in LZ77
+            matched += len;
+        }
+        else if (spec.text > 0 && gen_uniform(state) < spec.text)
+        {
+            const char* word = gen_words[gen_next(state) % nwords];
+            for (size_t i=0; word[i] && pos < spec.size; i++)
+                buf[pos++] = word[i];
+            if (pos < spec.size) buf[pos++] = ' ';
+        }
+        else
+        {
+            uint64_t len = gen_sample(state, literal_run, 1, 64);
+            for (uint64_t i=0; i<len && pos < spec.size; i++)
+                buf[pos++] = (uint8_t)(gen_next(state) % alphabet);
+        }
+    }
+}
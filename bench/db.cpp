@@ -0,0 +1,210 @@
+/*
+ * Copyright (c) Przemyslaw Skibinski <inikep@gmail.com>
+ * All rights reserved.
+ *
+ * This source code is dual-licensed under the GPLv2 and GPLv3 licenses.
+ * For additional details, refer to the LICENSE file located in the root
+ * directory of this source tree.
+ *
+ * db.cpp: persistent results database (--db=FILE)
+ *
+ * The database is an append-only text file. Every measurement appends one line:
+ *   input_hash cpu compiler name_version level params chunk_size origsize comprsize citers diters cloops dloops filename
+ * citers/diters are the times of every (de)compression iteration and cloops/dloops the mean
+ * iteration time of every timing loop, all in ns. Lines with the same key (all columns up to
+ * chunk_size) are merged when the file is loaded, so repeated runs with --db-merge accumulate
+ * samples. Without --db-merge a combination that is already in the database is not measured
+ * again and the stored samples are reported.
+ */
+
+#include "lzbench.h"
+#include <map>
+#include <stdlib.h>
+#include <string.h>
+
+#define XXH_INLINE_ALL
+#include "lz/zstd/lib/common/xxhash.h"
+
+#define DB_MAGIC "# lzbench db v2"
+#define DB_MAGIC_ANY "# lzbench db "
+
+typedef struct
+{
+    uint64_t comprsize;
+    std::vector<uint64_t> citers, diters, cloops, dloops;
+} db_entry_t;
+
+static std::map<std::string, db_entry_t> g_db;
+static std::string g_db_cpu, g_db_compiler;
+static bool g_db_loaded = false;
+
+
+// tabs and new lines would break the file format
+static std::string db_field(const char* text)
+{
+    std::string s = text ? text : "";
+    for (size_t i=0; i<s.size(); i++)
+        if (s[i] == '\t' || s[i] == '\n' || s[i] == '\r') s[i] = ' ';
+    return s;
+}
+
+
+static std::string db_compiler()
+{
+    std::string s = lzbench_compiler();
+    if (lzbench_build_flags()[0]) s += std::string(" ") + lzbench_build_flags();
+    return db_field(s.c_str());
+}
+
+
+static std::string db_key(const std::string& hash, const std::string& name_version, int level, const std::string& codec_params, uint64_t chunk_size)
+{
+    std::string key;
+    format(key, "%s\t%s\t%s\t%s\t%d\t%s\t%llu", hash.c_str(), g_db_cpu.c_str(), g_db_compiler.c_str(), name_version.c_str(), level, codec_params.c_str(), (unsigned long long)chunk_size);
+    return key;
+}
+
+
+static void db_samples(const std::string& text, std::vector<uint64_t>& samples)
+{
+    std::vector<std::string> nums = split(text, ',');
+    for (size_t i=0; i<nums.size(); i++)
+        if (!nums[i].empty())
+            samples.push_back(strtoull(nums[i].c_str(), NULL, 10));
+}
+
+
+static std::string db_join(const std::vector<uint64_t>& samples)
+{
+    std::string text, num;
+    for (size_t i=0; i<samples.size(); i++) { format(num, "%s%llu", i ? "," : "", (unsigned long long)samples[i]); text += num; }
+    return text;
+}
+
+
+// with --db-merge the stored samples are added to the new ones, otherwise only stored
+static void db_merge_samples(std::vector<uint64_t>& samples, std::vector<uint64_t>& stored, bool merge)
+{
+    if (merge)
+    {
+        samples.insert(samples.end(), stored.begin(), stored.end());
+        stored = samples;
+    }
+    else
+        stored.insert(stored.end(), samples.begin(), samples.end());
+}
+
+
+static void db_load(lzbench_params_t *params)
+{
+    char* cpu = cpu_brand_string();
+    g_db_cpu = db_field(cpu ? cpu : "unknown CPU");
+    free(cpu);
+    g_db_compiler = db_compiler();
+    g_db_loaded = true;
+
+    FILE* f = fopen(params->db_file, "r");
+    if (!f) return; // created with the first measurement
+
+    std::string text;
+    char line[1 << 16];
+    int count = 0;
+    bool header = true;
+    while (fgets(line, sizeof(line), f))
+    {
+        text += line;
+        if (text[text.size()-1] != '\n') continue;
+        text.erase(text.size()-1);
+        if (header && strncmp(text.c_str(), DB_MAGIC, strlen(DB_MAGIC)) != 0) {
+            if (strncmp(text.c_str(), DB_MAGIC_ANY, strlen(DB_MAGIC_ANY)) == 0)
+                fprintf(stderr, "warning: %s was written by another version of lzbench, it will not be used\n", params->db_file);
+            else
+                fprintf(stderr, "warning: %s is not a results database, it will not be used\n", params->db_file);
+            params->db_file = NULL;
+            break;
+        }
+        header = false;
+        if (text[0] == '#') { text.clear(); continue; }
+
+        std::vector<std::string> cols = split(text, '\t');
+        text.clear();
+        if (cols.size() != 14) continue;
+
+        std::string key = cols[0];
+        for (int i=1; i<7; i++) key += "\t" + cols[i];
+        db_entry_t& e = g_db[key];
+        e.comprsize = strtoull(cols[8].c_str(), NULL, 10);
+        db_samples(cols[9], e.citers);
+        db_samples(cols[10], e.diters);
+        db_samples(cols[11], e.cloops);
+        db_samples(cols[12], e.dloops);
+        count++;
+    }
+    fclose(f);
+    LZBENCH_PRINT(3, "db: %d measurements of %d combinations loaded from %s\n", count, (int)g_db.size(), params->db_file);
+}
+
+
+// hash of the input content and of the file layout (-j joins files that are compressed independently)
+uint64_t lzbench_db_hash(const uint8_t* inbuf, size_t insize, const std::vector<size_t>& file_sizes)
+{
+    uint64_t hash = XXH64(inbuf, insize, 0);
+    if (file_sizes.size() > 1)
+        hash = XXH64(&file_sizes[0], file_sizes.size() * sizeof(size_t), hash);
+    return hash;
+}
+
+
+bool lzbench_db_lookup(lzbench_params_t *params, const std::string& name_version, int level, const std::string& codec_params, uint64_t chunk_size, uint64_t& comprsize, std::vector<uint64_t>& citers, std::vector<uint64_t>& diters, std::vector<uint64_t>& cloops, std::vector<uint64_t>& dloops)
+{
+    if (!g_db_loaded) db_load(params);
+    if (!params->db_file) return false;
+
+    std::string hash;
+    format(hash, "%016llx", (unsigned long long)params->in_hash);
+    std::map<std::string, db_entry_t>::iterator it = g_db.find(db_key(hash, db_field(name_version.c_str()), level, codec_params, chunk_size));
+    if (it == g_db.end() || it->second.cloops.empty() || (it->second.dloops.empty() && !params->compress_only)) return false;
+
+    comprsize = it->second.comprsize;
+    citers = it->second.citers;
+    diters = it->second.diters;
+    cloops = it->second.cloops;
+    dloops = it->second.dloops;
+    return true;
+}
+
+
+/*
+ * Appends a new measurement. With --db-merge the stored samples are added to citers, diters,
+ * cloops and dloops, so the reported statistics are computed from all runs.
+ */
+void lzbench_db_record(lzbench_params_t *params, const std::string& name_version, int level, const std::string& codec_params, uint64_t chunk_size, uint64_t origsize, uint64_t comprsize, std::vector<uint64_t>& citers, std::vector<uint64_t>& diters, std::vector<uint64_t>& cloops, std::vector<uint64_t>& dloops)
+{
+    if (!g_db_loaded) db_load(params);
+    if (!params->db_file) return;
+
+    std::string hash;
+    format(hash, "%016llx", (unsigned long long)params->in_hash);
+
+    std::string key = db_key(hash, db_field(name_version.c_str()), level, codec_params, chunk_size);
+    FILE* f = fopen(params->db_file, "r");
+    bool create = (f == NULL || fgetc(f) == EOF);
+    if (f) fclose(f);
+    f = fopen(params->db_file, "a");
+    if (!f) {
+        perror(params->db_file);
+        params->db_file = NULL;
+        return;
+    }
+    if (create) fprintf(f, DB_MAGIC " (" PROGNAME " " PROGVERSION ")\n");
+    fprintf(f, "%s\t%llu\t%llu\t%s\t%s\t%s\t%s\t%s\n", key.c_str(), (unsigned long long)origsize, (unsigned long long)comprsize,
+            db_join(citers).c_str(), db_join(diters).c_str(), db_join(cloops).c_str(), db_join(dloops).c_str(), db_field(params->in_filename).c_str());
+    fclose(f);
+
+    db_entry_t& e = g_db[key];
+    e.comprsize = comprsize;
+    db_merge_samples(citers, e.citers, params->db_merge);
+    db_merge_samples(diters, e.diters, params->db_merge);
+    db_merge_samples(cloops, e.cloops, params->db_merge);
+    db_merge_samples(dloops, e.dloops, params->db_merge);
+}
@@ -0,0 +1,460 @@
+/*
+ * Copyright (c) Przemyslaw Skibinski <inikep@gmail.com>
+ * All rights reserved.
+ *
+ * This source code is dual-licensed under the GPLv2 and GPLv3 licenses.
+ * For additional details, refer to the LICENSE file located in the root
+ * directory of this source tree.
+ *
+ * decode.cpp: decode-only benchmark of already compressed files (--decode[=FORMAT])
+ *
+ * The format of every input file is detected from its magic bytes (.br files have none and
+ * are recognized by the extension). The file is decoded once with the reference decoder of
+ * the format and then with every decoder that supports it, e.g. gzip with zlib, zlib-ng and
+ * libdeflate. Each output is verified against the reference decode. Nothing is recompressed.
+ */
+
+#include "lzbench.h"
+#include "util.h"
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef BENCH_REMOVE_BROTLI
+#include "brotli/decode.h"
+#endif
+#ifndef BENCH_REMOVE_BZIP2
+#include "bwt/bzip2/bzlib.h"
+#endif
+#ifndef BENCH_REMOVE_LIBDEFLATE
+#include "lz/libdeflate/libdeflate.h"
+#endif
+#ifndef BENCH_REMOVE_LZ4
+#include "lz/lz4/lib/lz4frame.h"
+#endif
+#ifndef BENCH_REMOVE_XZ
+#include "lz/xz/src/liblzma/api/lzma.h"
+#endif
+#ifndef BENCH_REMOVE_ZLIB
+#include "zlib/zlib.h"
+#endif
+#ifndef BENCH_REMOVE_ZLIB_NG
+#undef z_const
+#undef Z_NULL
+#include "zlib-ng/zlib-ng.h"
+#endif
+#ifndef BENCH_REMOVE_ZSTD
+#include "zstd/lib/zstd.h"
+#endif
+
+#define DECODE_ERROR  -1      // corrupted or unsupported input
+#define DECODE_FULL   -2      // the output buffer is too small
+#define DECODE_STEP   (1U << 30)  // the largest buffer passed to APIs with 32-bit lengths
+
+typedef int64_t (*decode_func)(const uint8_t* in, size_t insize, uint8_t* out, size_t outsize);
+
+typedef struct
+{
+    const char* format;
+    const char* codec;    // name in comp_desc[], used for the name and version
+    decode_func decode;
+} decoder_desc_t;
+
+
+#if !defined(BENCH_REMOVE_ZLIB) || !defined(BENCH_REMOVE_ZLIB_NG)
+/*
+ * The same loop for zlib and zlib-ng: lengths are 32-bit, so buffers are passed in steps,
+ * and concatenated gzip members (pigz, bgzip) are decoded one after another.
+ */
+#define GZIP_INFLATE_LOOP(stream_t, inflateInit2_f, inflate_f, inflateReset_f, inflateEnd_f) \
+    stream_t strm; \
+    size_t inpos = 0, outpos = 0; \
+    int64_t result = DECODE_ERROR; \
+    memset(&strm, 0, sizeof(strm)); \
+    if (inflateInit2_f(&strm, 16 + MAX_WBITS) != Z_OK) return DECODE_ERROR; \
+    while (true) \
+    { \
+        if (strm.avail_in == 0) { \
+            strm.next_in = (uint8_t*)in + inpos; \
+            strm.avail_in = (uint32_t)MIN(insize - inpos, (size_t)DECODE_STEP); \
+            inpos += strm.avail_in; \
+        } \
+        strm.next_out = out + outpos; \
+        strm.avail_out = (uint32_t)MIN(outsize - outpos, (size_t)DECODE_STEP); \
+        size_t avail = strm.avail_out; \
+        int ret = inflate_f(&strm, Z_NO_FLUSH); \
+        outpos += avail - strm.avail_out; \
+        if (ret == Z_STREAM_END) { \
+            if (strm.avail_in == 0 && inpos == insize) { result = outpos; break; } \
+            inflateReset_f(&strm); \
+            continue; \
+        } \
+        if (ret == Z_BUF_ERROR && outpos == outsize) { result = DECODE_FULL; break; } \
+        if (ret != Z_OK || (strm.avail_in == 0 && inpos == insize && avail == strm.avail_out)) break; \
+    } \
+    inflateEnd_f(&strm); \
+    return result;
+#endif
+
+#ifndef BENCH_REMOVE_ZLIB
+static int64_t gzip_zlib(const uint8_t* in, size_t insize, uint8_t* out, size_t outsize)
+{
+    GZIP_INFLATE_LOOP(z_stream, inflateInit2, inflate, inflateReset, inflateEnd)
+}
+#endif
+
+#ifndef BENCH_REMOVE_ZLIB_NG
+static int64_t gzip_zlib_ng(const uint8_t* in, size_t insize, uint8_t* out, size_t outsize)
+{
+    GZIP_INFLATE_LOOP(zng_stream, zng_inflateInit2, zng_inflate, zng_inflateReset, zng_inflateEnd)
+}
+#endif
+
+#ifndef BENCH_REMOVE_LIBDEFLATE
+static int64_t gzip_libdeflate(const uint8_t* in, size_t insize, uint8_t* out, size_t outsize)
+{
+    static struct libdeflate_decompressor* d = libdeflate_alloc_decompressor();
+    size_t inpos = 0, outpos = 0;
+
+    while (inpos < insize)
+    {
+        size_t in_used, out_used;
+        enum libdeflate_result ret = libdeflate_gzip_decompress_ex(d, in + inpos, insize - inpos, out + outpos, outsize - outpos, &in_used, &out_used);
+        if (ret == LIBDEFLATE_INSUFFICIENT_SPACE) return DECODE_FULL;
+        if (ret != LIBDEFLATE_SUCCESS) return DECODE_ERROR;
+        inpos += in_used;
+        outpos += out_used;
+    }
+    return outpos;
+}
+#endif
+
+#ifndef BENCH_REMOVE_ZSTD
+static int64_t zstd_zstd(const uint8_t* in, size_t insize, uint8_t* out, size_t outsize)
+{
+    static ZSTD_DCtx* dctx = ZSTD_createDCtx();
+    size_t ret = ZSTD_decompressDCtx(dctx, out, outsize, in, insize);
+    if (ZSTD_isError(ret))
+        return (ZSTD_getErrorCode(ret) == ZSTD_error_dstSize_tooSmall) ? DECODE_FULL : DECODE_ERROR;
+    return ret;
+}
+#endif
+
+#ifndef BENCH_REMOVE_LZ4
+static int64_t lz4_lz4(const uint8_t* in, size_t insize, uint8_t* out, size_t outsize)
+{
+    static LZ4F_dctx* dctx = NULL;
+    size_t inpos = 0, outpos = 0, hint = 0;
+
+    if (!dctx && LZ4F_isError(LZ4F_createDecompressionContext(&dctx, LZ4F_VERSION))) return DECODE_ERROR;
+    LZ4F_resetDecompressionContext(dctx);
+    while (inpos < insize)
+    {
+        size_t src = insize - inpos, dst = outsize - outpos;
+        hint = LZ4F_decompress(dctx, out + outpos, &dst, in + inpos, &src, NULL);
+        if (LZ4F_isError(hint)) return DECODE_ERROR;
+        inpos += src;
+        outpos += dst;
+        if (src == 0 && dst == 0) return (outpos == outsize) ? DECODE_FULL : DECODE_ERROR;
+    }
+    // the last block may still be buffered when the output was filled exactly
+    while (hint != 0)
+    {
+        size_t src = 0, dst = outsize - outpos;
+        hint = LZ4F_decompress(dctx, out + outpos, &dst, NULL, &src, NULL);
+        if (LZ4F_isError(hint)) return DECODE_ERROR;
+        if (dst == 0) return (outpos == outsize) ? DECODE_FULL : DECODE_ERROR;
+        outpos += dst;
+    }
+    return outpos;
+}
+#endif
+
+#ifndef BENCH_REMOVE_XZ
+static int64_t xz_xz(const uint8_t* in, size_t insize, uint8_t* out, size_t outsize)
+{
+    lzma_stream strm = LZMA_STREAM_INIT;
+    int64_t result = DECODE_ERROR;
+
+    if (lzma_stream_decoder(&strm, UINT64_MAX, LZMA_CONCATENATED) != LZMA_OK) return DECODE_ERROR;
+    strm.next_in = in;
+    strm.avail_in = insize;
+    strm.next_out = out;
+    strm.avail_out = outsize;
+    lzma_ret ret = lzma_code(&strm, LZMA_FINISH);
+    if (ret == LZMA_STREAM_END) result = strm.total_out;
+    else if ((ret == LZMA_OK || ret == LZMA_BUF_ERROR) && strm.avail_out == 0) result = DECODE_FULL;
+    lzma_end(&strm);
+    return result;
+}
+#endif
+
+#ifndef BENCH_REMOVE_BZIP2
+static int64_t bzip2_bzip2(const uint8_t* in, size_t insize, uint8_t* out, size_t outsize)
+{
+    bz_stream strm;
+    size_t inpos = 0, outpos = 0;
+    int64_t result = DECODE_ERROR;
+
+    memset(&strm, 0, sizeof(strm));
+    if (BZ2_bzDecompressInit(&strm, 0, 0) != BZ_OK) return DECODE_ERROR;
+    while (true)
+    {
+        if (strm.avail_in == 0) {
+            strm.next_in = (char*)in + inpos;
+            strm.avail_in = (unsigned)MIN(insize - inpos, (size_t)DECODE_STEP);
+            inpos += strm.avail_in;
+        }
+        strm.next_out = (char*)out + outpos;
+        strm.avail_out = (unsigned)MIN(outsize - outpos, (size_t)DECODE_STEP);
+        size_t avail = strm.avail_out;
+        int ret = BZ2_bzDecompress(&strm);
+        outpos += avail - strm.avail_out;
+        if (ret == BZ_STREAM_END) {
+            if (strm.avail_in == 0 && inpos == insize) { result = outpos; break; }
+            // concatenated streams (pbzip2, lbzip2)
+            unsigned avail_in = strm.avail_in;
+            char* next_in = strm.next_in;
+            BZ2_bzDecompressEnd(&strm);
+            memset(&strm, 0, sizeof(strm));
+            if (BZ2_bzDecompressInit(&strm, 0, 0) != BZ_OK) return DECODE_ERROR;
+            strm.next_in = next_in;
+            strm.avail_in = avail_in;
+            continue;
+        }
+        if (ret != BZ_OK) break;
+        if (avail == strm.avail_out) {
+            if (outpos == outsize) result = DECODE_FULL;
+            if (outpos == outsize || (strm.avail_in == 0 && inpos == insize)) break;
+        }
+    }
+    BZ2_bzDecompressEnd(&strm);
+    return result;
+}
+#endif
+
+#ifndef BENCH_REMOVE_BROTLI
+static int64_t brotli_brotli(const uint8_t* in, size_t insize, uint8_t* out, size_t outsize)
+{
+    BrotliDecoderState* state = BrotliDecoderCreateInstance(NULL, NULL, NULL);
+    size_t avail_in = insize, avail_out = outsize;
+    const uint8_t* next_in = in;
+    uint8_t* next_out = out;
+
+    if (!state) return DECODE_ERROR;
+    BrotliDecoderResult ret = BrotliDecoderDecompressStream(state, &avail_in, &next_in, &avail_out, &next_out, NULL);
+    BrotliDecoderDestroyInstance(state);
+    if (ret == BROTLI_DECODER_RESULT_NEEDS_MORE_OUTPUT) return DECODE_FULL;
+    if (ret != BROTLI_DECODER_RESULT_SUCCESS || avail_in != 0) return DECODE_ERROR;
+    return outsize - avail_out;
+}
+#endif
+
+
+// the first decoder of each format is the reference decoder
+static const decoder_desc_t decoders[] =
+{
+#ifndef BENCH_REMOVE_ZLIB
+    { "gzip",   "zlib",       gzip_zlib },
+#endif
+#ifndef BENCH_REMOVE_ZLIB_NG
+    { "gzip",   "zlib-ng",    gzip_zlib_ng },
+#endif
+#ifndef BENCH_REMOVE_LIBDEFLATE
+    { "gzip",   "libdeflate", gzip_libdeflate },
+#endif
+#ifndef BENCH_REMOVE_ZSTD
+    { "zstd",   "zstd",       zstd_zstd },
+#endif
+#ifndef BENCH_REMOVE_LZ4
+    { "lz4",    "lz4",        lz4_lz4 },
+#endif
+#ifndef BENCH_REMOVE_XZ
+    { "xz",     "xz",         xz_xz },
+#endif
+#ifndef BENCH_REMOVE_BZIP2
+    { "bzip2",  "bzip2",      bzip2_bzip2 },
+#endif
+#ifndef BENCH_REMOVE_BROTLI
+    { "brotli", "brotli",     brotli_brotli },
+#endif
+    { NULL, NULL, NULL }
+};
+
+static const char* decode_formats[] = { "gzip", "zstd", "lz4", "xz", "bzip2", "brotli", NULL };
+
+
+bool lzbench_decode_format_valid(const char* format)
+{
+    for (int i=0; decode_formats[i]; i++)
+        if (!strcmp(format, decode_formats[i])) return true;
+    fprintf(stderr, "--decode: unknown format \"%s\" (use gzip, zstd, lz4, xz, bzip2 or brotli)\n", format);
+    return false;
+}
+
+
+static const char* detect_format(const uint8_t* buf, size_t size, const char* filename)
+{
+    size_t len = strlen(filename);
+
+    if (size >= 2 && buf[0] == 0x1F && buf[1] == 0x8B) return "gzip";
+    if (size >= 4 && buf[0] == 0x28 && buf[1] == 0xB5 && buf[2] == 0x2F && buf[3] == 0xFD) return "zstd";
+    if (size >= 4 && buf[0] == 0x04 && buf[1] == 0x22 && buf[2] == 0x4D && buf[3] == 0x18) return "lz4";
+    if (size >= 6 && !memcmp(buf, "\xFD" "7zXZ\0", 6)) return "xz";
+    if (size >= 4 && buf[0] == 'B' && buf[1] == 'Z' && buf[2] == 'h' && buf[3] >= '1' && buf[3] <= '9') return "bzip2";
+    if (len > 3 && !strcmp(filename + len - 3, ".br")) return "brotli"; // brotli has no magic bytes
+    return NULL;
+}
+
+
+// decodes with a growing output buffer, the result has lzbench_max_padding() spare bytes
+static uint8_t* reference_decode(const decoder_desc_t* dec, const uint8_t* in, size_t insize, size_t& outsize)
+{
+    size_t capacity = MAX(insize * 4, (size_t)1 << 20);
+
+    while (true)
+    {
+        uint8_t* out = (uint8_t*)alloc_and_touch(capacity + lzbench_max_padding(), false);
+        if (!out) return NULL;
+        int64_t len = dec->decode(in, insize, out, capacity);
+        if (len >= 0) { outsize = len; return out; }
+        free(out);
+        if (len != DECODE_FULL) return NULL;
+        capacity *= 2;
+    }
+}
+
+
+static bool decoder_selected(const decoder_desc_t* dec, const char* encoder_list)
+{
+    if (!encoder_list) return true;
+    std::vector<std::string> names = split(encoder_list, '/');
+    for (size_t i=0; i<names.size(); i++)
+        if (!istrcmp(names[i].substr(0, names[i].find(',')).c_str(), dec->codec) || !istrcmp(names[i].c_str(), "all"))
+            return true;
+    return false;
+}
+
+
+static void decode_benchmark(lzbench_params_t *params, const decoder_desc_t* dec, const uint8_t* in, size_t insize, const uint8_t* ref, size_t refsize, uint8_t* out, bench_rate_t rate)
+{
+    const compressor_desc_t* codec = lzbench_find_codec(dec->codec);
+    compressor_desc_t desc = *codec;
+    std::vector<uint64_t> citers, diters, cloops, dloops;
+    std::vector<size_t> chunk_sizes(1, refsize);
+    bench_timer_t loop_ticks, start_ticks, end_ticks, timer_ticks;
+    uint64_t nanosec, total_nanosec;
+    int64_t decomplen = 0;
+    uint32_t total_d_iters = 0;
+    bool decomp_error = false;
+    int i;
+
+    desc.first_level = desc.last_level = 0; // results are named by codec and version only
+
+    GetTime(timer_ticks);
+    do
+    {
+        i = 0;
+        uni_sleep(1); // give processor to other processes
+        GetTime(loop_ticks);
+        do
+        {
+            GetTime(start_ticks);
+            decomplen = dec->decode(in, insize, out, refsize);
+            GetTime(end_ticks);
+            nanosec = GetDiffTime(rate, start_ticks, end_ticks);
+            diters.push_back(nanosec);
+            i++;
+        }
+        while (GetDiffTime(rate, loop_ticks, end_ticks) < params->dloop_time);
+
+        nanosec = GetDiffTime(rate, loop_ticks, end_ticks);
+        dloops.push_back(nanosec/i);
+
+        if (decomplen != (int64_t)refsize || memcmp(ref, out, refsize) != 0)
+        {
+            decomp_error = true;
+            g_exit_result = 11; // lzbench will return 11 to shell
+            LZBENCH_PRINT(0, "ERROR in %s: the output differs from the reference decode (%lld of %llu bytes)\n", desc.name_version, (long long)decomplen, (unsigned long long)refsize);
+            break;
+        }
+        memset(out, 0, refsize); // clear output buffer
+
+        total_nanosec = GetDiffTime(rate, timer_ticks, end_ticks);
+        total_d_iters += i;
+        if ((total_d_iters >= params->d_iters) && (total_nanosec > ((uint64_t)params->dmintime*1000000))) break;
+        LZBENCH_STDERR(2, "%s decompr iter=%d time=%.2fs speed=%.2f MB/s     \r", desc.name, total_d_iters, total_nanosec/1000000000.0, (float)refsize*i*1000/nanosec);
+    }
+    while (true);
+
+    print_stats(params, &desc, 0, codec_kv_t(), refsize, chunk_sizes, citers, diters, cloops, dloops, refsize, insize, false, decomp_error, false);
+}
+
+
+int lzbench_decode(lzbench_params_t *params, const char** inFileNames, unsigned ifnIdx, char* encoder_list, const char* format)
+{
+    bench_rate_t rate;
+    bool header = false;
+
+    InitTimer(rate);
+
+    for (unsigned i=0; i<ifnIdx; i++)
+    {
+        FILE* in;
+        if (UTIL_isDirectory(inFileNames[i])) {
+            fprintf(stderr, "warning: use -r to process directories (%s)\n", inFileNames[i]);
+            continue;
+        }
+        if (!(in = fopen(inFileNames[i], "rb"))) {
+            perror(inFileNames[i]);
+            continue;
+        }
+
+        fseeko(in, 0L, SEEK_END);
+        size_t insize = ftello(in);
+        rewind(in);
+        uint8_t* inbuf = (uint8_t*)alloc_and_touch(insize + lzbench_max_padding(), false);
+        if (!inbuf)
+        {
+            printf("Not enough memory!");
+            fclose(in);
+            return 3;
+        }
+        insize = fread(inbuf, 1, insize, in);
+        fclose(in);
+
+        const char* fmt = format ? format : detect_format(inbuf, insize, inFileNames[i]);
+        const decoder_desc_t* ref = NULL;
+        for (int k=0; fmt && decoders[k].format && !ref; k++)
+            if (!strcmp(decoders[k].format, fmt)) ref = &decoders[k];
+        if (!ref) {
+            fprintf(stderr, "%s: %s, skipped\n", inFileNames[i], fmt ? "no decoder of this format is built in" : "unknown format (use --decode=FORMAT)");
+            free(inbuf);
+            continue;
+        }
+
+        size_t refsize;
+        uint8_t* refbuf = reference_decode(ref, inbuf, insize, refsize);
+        uint8_t* outbuf = refbuf ? (uint8_t*)alloc_and_touch(refsize + lzbench_max_padding(), false) : NULL;
+        if (!outbuf) {
+            fprintf(stderr, "%s: the reference decoder (%s) failed, skipped\n", inFileNames[i], ref->codec);
+            g_exit_result = 11;
+            free(refbuf);
+            free(inbuf);
+            continue;
+        }
+
+        const char* pch = strrchr(inFileNames[i], '\\');
+        params->in_filename = pch ? pch+1 : inFileNames[i];
+        if (!header) { print_header(params); header = true; }
+
+        for (int k=0; decoders[k].format; k++)
+            if (!strcmp(decoders[k].format, fmt) && decoder_selected(&decoders[k], encoder_list))
+                decode_benchmark(params, &decoders[k], inbuf, insize, refbuf, refsize, outbuf, rate);
+
+        free(outbuf);
+        free(refbuf);
+        free(inbuf);
+    }
+
+    return g_exit_result;
+}
@@ -0,0 +1,177 @@
+/*
+ * Copyright (c) Przemyslaw Skibinski <inikep@gmail.com>
+ * All rights reserved.
+ *
+ * This source code is dual-licensed under the GPLv2 and GPLv3 licenses.
+ * For additional details, refer to the LICENSE file located in the root
+ * directory of this source tree.
+ *
+ * dedup.cpp: content-defined chunking deduplication ahead of compression (--dedup)
+ *
+ * Every input is cut into chunks with FastCDC (a gear rolling hash with normalized chunking:
+ * a stricter mask before the average size and a looser one after it, chunks of AVG/4 to AVG*8
+ * bytes) and every chunk is fingerprinted with XXH64. Only the first copy of each chunk is kept
+ * and the codecs are benchmarked on the unique chunks, so the table shows the ratio after dedup.
+ * The report adds the dedup ratio, the combined ratio, the chunker speed (the best of DEDUP_RUNS)
+ * and the compression speed of the whole pipeline (dedup + compression of the unique chunks).
+ */
+
+#include "lzbench.h"
+#include <string.h>
+#include <unordered_set>
+
+#define XXH_INLINE_ALL
+#include "lz/zstd/lib/common/xxhash.h"
+
+#define DEDUP_RUNS 3
+
+static uint64_t gear[256];
+
+
+// a fixed table (splitmix64) keeps chunk boundaries the same between runs
+static void gear_init()
+{
+    uint64_t x = 0;
+    for (int i=0; i<256; i++)
+    {
+        uint64_t z = (x += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        gear[i] = z ^ (z >> 31);
+    }
+}
+
+
+// the mask tests the top bits of the gear hash, as they depend on the last 64 bytes
+static uint64_t top_mask(int bits)
+{
+    return ((1ULL << bits) - 1) << (64 - bits);
+}
+
+
+static size_t fastcdc_cut(const uint8_t* p, size_t size, size_t avg, uint64_t mask_s, uint64_t mask_l)
+{
+    size_t min_size = avg / 4, max_size = avg * 8;
+    uint64_t fp = 0;
+
+    if (size <= min_size) return size;
+    size_t end = MIN(size, max_size), normal = MIN(avg, end), i = min_size;
+    for (; i < normal; i++)
+    {
+        fp = (fp << 1) + gear[p[i]];
+        if (!(fp & mask_s)) return i + 1;
+    }
+    for (; i < end; i++)
+    {
+        fp = (fp << 1) + gear[p[i]];
+        if (!(fp & mask_l)) return i + 1;
+    }
+    return end;
+}
+
+
+/*
+ * Copies the unique chunks of inbuf to outbuf (of insize bytes) and returns their size;
+ * unique_sizes gets the unique bytes of every file (files with none are left out).
+ */
+static size_t dedup_input(lzbench_params_t *params, std::vector<size_t> &file_sizes, const uint8_t *inbuf, uint8_t *outbuf, std::vector<size_t> &unique_sizes, dedup_info_t& d)
+{
+    int bits = 0;
+    while (((size_t)2 << bits) <= params->dedup_avg) bits++;
+    uint64_t mask_s = top_mask(bits + 2), mask_l = top_mask(bits - 2);
+    std::unordered_set<uint64_t> seen;
+    size_t offset = 0, outsize = 0;
+
+    seen.reserve(d.size / (params->dedup_avg / 4) + 1);
+    unique_sizes.clear();
+    d.chunks = d.unique_chunks = 0;
+    for (size_t f=0; f<file_sizes.size(); f++)
+    {
+        size_t file_end = offset + file_sizes[f], unique = 0;
+        while (offset < file_end)
+        {
+            size_t len = fastcdc_cut(inbuf + offset, file_end - offset, params->dedup_avg, mask_s, mask_l);
+            d.chunks++;
+            if (seen.insert(XXH64(inbuf + offset, len, 0)).second) {
+                memcpy(outbuf + outsize, inbuf + offset, len);
+                outsize += len;
+                unique += len;
+                d.unique_chunks++;
+            }
+            offset += len;
+        }
+        if (unique) unique_sizes.push_back(unique);
+    }
+    return outsize;
+}
+
+
+/*
+ * Deduplicates the current input into a new buffer (to be freed by the caller) and records
+ * the dedup results for the report. Returns NULL if there is not enough memory.
+ */
+uint8_t* lzbench_dedup(lzbench_params_t *params, std::vector<size_t> &file_sizes, const uint8_t *inbuf, size_t insize, std::vector<size_t> &unique_sizes, size_t& unique_size, bench_rate_t rate)
+{
+    bench_timer_t start_ticks, end_ticks;
+    dedup_info_t d;
+    uint8_t* outbuf = (uint8_t*)alloc_and_touch(insize + lzbench_max_padding(), false);
+
+    if (!outbuf) return NULL;
+    if (!gear[0]) gear_init();
+
+    d.filename = params->in_filename;
+    d.size = insize;
+    d.nanosec = 0;
+    for (int r=0; r<DEDUP_RUNS; r++)
+    {
+        GetTime(start_ticks);
+        unique_size = dedup_input(params, file_sizes, inbuf, outbuf, unique_sizes, d);
+        GetTime(end_ticks);
+        uint64_t nanosec = GetDiffTime(rate, start_ticks, end_ticks);
+        if (r == 0 || nanosec < d.nanosec) d.nanosec = nanosec;
+    }
+    d.unique_size = unique_size;
+    params->dedup_info.push_back(d);
+
+    LZBENCH_PRINT(3, "%s: dedup %llu -> %llu bytes (%llu of %llu chunks unique)\n", params->in_filename, (unsigned long long)insize,
+                  (unsigned long long)unique_size, (unsigned long long)d.unique_chunks, (unsigned long long)d.chunks);
+    return outbuf;
+}
+
+
+void lzbench_dedup_report(lzbench_params_t *params)
+{
+    if (params->textformat != NDJSON)
+        printf("\nDedup with FastCDC chunks of %d KB average (%d-%d KB) and XXH64 fingerprints:\n", (int)(params->dedup_avg >> 10),
+               (int)(params->dedup_avg >> 12), (int)(params->dedup_avg >> 7));
+
+    for (size_t f=0; f<params->dedup_info.size(); f++)
+    {
+        const dedup_info_t& d = params->dedup_info[f];
+        double dedup_ratio = d.unique_size ? (double)d.size / d.unique_size : 0;
+
+        if (params->textformat == NDJSON)
+            printf("{\"type\":\"dedup\",\"file\":%s,\"size\":%llu,\"unique_size\":%llu,\"chunks\":%llu,\"unique_chunks\":%llu,\"dedup_ratio\":%.3f,\"chunker_mbps\":%.1f}\n",
+                   json_string(d.filename).c_str(), (unsigned long long)d.size, (unsigned long long)d.unique_size, (unsigned long long)d.chunks,
+                   (unsigned long long)d.unique_chunks, dedup_ratio, lzbench_speed(d.size, d.nanosec));
+        else
+            printf("%s: %llu of %llu chunks unique (%.1f%% of bytes), dedup ratio %.3f, chunker %.1f MB/s\n", d.filename.c_str(),
+                   (unsigned long long)d.unique_chunks, (unsigned long long)d.chunks, d.size ? d.unique_size * 100.0 / d.size : 0,
+                   dedup_ratio, lzbench_speed(d.size, d.nanosec));
+
+        // ratios are original/compressed sizes here, as usual for dedup
+        for (size_t i=0; i<params->results.size(); i++)
+        {
+            const string_table_t& r = params->results[i];
+            if (r.col6_filename != d.filename || !r.col2_ctime || !r.col4_comprsize) continue;
+
+            double ratio = (double)r.col5_origsize / r.col4_comprsize, combined = (double)d.size / r.col4_comprsize;
+            double pipeline = lzbench_speed(d.size, d.nanosec + r.col2_ctime);
+            if (params->textformat == NDJSON)
+                printf("{\"type\":\"dedup_codec\",\"name\":%s,\"file\":%s,\"ratio_after_dedup\":%.3f,\"combined_ratio\":%.3f,\"pipeline_mbps\":%.1f}\n",
+                       json_string(r.col1_algname).c_str(), json_string(d.filename).c_str(), ratio, combined, pipeline);
+            else
+                printf("%-23s ratio %.3f after dedup, %.3f combined, pipeline %.1f MB/s\n", r.col1_algname.c_str(), ratio, combined, pipeline);
+        }
+    }
+}
@@ -0,0 +1,1000 @@
+/*
+ * Copyright (c) Przemyslaw Skibinski <inikep@gmail.com>
+ * All rights reserved.
+ *
+ * This source code is dual-licensed under the GPLv2 and GPLv3 licenses.
+ * For additional details, refer to the LICENSE file located in the root
+ * directory of this source tree.
+ *
+ * dict.cpp: dictionary compression of small records (--dict, --dict-file, --dict-train)
+ *
+ * All input files are cut into records of -b bytes (DICT_DEFAULT_RECORD when -b is not given).
+ * --dict trains a dictionary with ZDICT_trainFromBuffer() on every DICT_TRAIN_EVERY-th record
+ * and the benchmark runs on the other records; --dict-file loads a dictionary and the benchmark
+ * runs on all records. Every -e codec/level compresses and decompresses each record on its own,
+ * once without and once with a dictionary loaded ahead into a prebuilt object:
+ *   zstd      ZSTD_CDict / ZSTD_DDict
+ *   lz4       LZ4_loadDict() once, LZ4_attach_dictionary() for every record
+ *   zlib      deflateSetDictionary() / inflateSetDictionary(), the same for zlib-ng (zlib has no
+ *             prebuilt dictionary, so it is set again for every record within the timed loops)
+ *   brotli    BrotliEncoderPrepareDictionary() / BrotliDecoderAttachDictionary()
+ * The report gives the ratio and speeds without and with the dictionary and the time to load
+ * or digest the dictionary, which is not included in the speeds. Other codecs are skipped.
+ *
+ * --dict-train sweeps the parameters of the COVER and fastCover trainers and the dictionary
+ * size on the same training records. Every configuration is trained in a child process (fork)
+ * to measure the wall time and the peak memory of training alone, and zstd compresses the
+ * held-out records with the dictionary to give the gain over no dictionary.
+ */
+
+#include "lzbench.h"
+#include "state_codecs.h"
+#include "util.h"
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef BENCH_REMOVE_ZSTD
+#define ZDICT_STATIC_LINKING_ONLY
+#include "zstd/lib/zdict.h"
+#endif
+#ifndef WINDOWS
+#include <sys/wait.h>
+#endif
+
+#define DICT_DEFAULT_CODECS "zstd,1,3,9/lz4/zlib,6/zlib-ng,6/brotli,5"
+#define DICT_DEFAULT_RECORD (4 << 10)
+#define DICT_MAX_SIZE_KB    (16 << 10)  // --dict and the sizes of --dict-train
+#define DICT_TRAIN_EVERY    4      // every 4th record is a training sample, the others are benchmarked
+#define DICT_SAMPLE_RATIO   100    // samples of ~100x the dictionary size are enough for ZDICT
+#define DICT_RUNS           3
+#define DICT_TRAIN_DEFAULT  "size=32:112,algo=fastcover:cover,k=0,d=8,steps=8,split=0.75,accel=1,level=3"
+
+typedef void* (*dict_create_func)(int level);
+typedef bool (*dict_load_func)(void* state, const uint8_t* dict, size_t dict_size);
+typedef int64_t (*dict_func)(void* state, const uint8_t* in, size_t insize, uint8_t* out, size_t outsize);
+typedef void (*dict_free_func)(void* state);
+
+typedef struct
+{
+    const char* codec;    // name in comp_desc[]
+    dict_create_func create;
+    dict_load_func load;  // not called for the results without a dictionary
+    dict_func compress;
+    dict_func decompress;
+    dict_free_func release;
+} dict_desc_t;
+
+typedef struct
+{
+    uint64_t size, comprsize, ctime, dtime, load_time;
+} dict_result_t;
+
+
+#ifndef BENCH_REMOVE_ZSTD
+typedef struct
+{
+    ZSTD_CCtx* cctx;
+    ZSTD_DCtx* dctx;
+    ZSTD_CDict* cdict;
+    ZSTD_DDict* ddict;
+    int level;
+} zstd_dict_t;
+
+static void* zstd_create(int level)
+{
+    zstd_dict_t* s = (zstd_dict_t*)calloc(1, sizeof(zstd_dict_t));
+    if (!s) return NULL;
+    s->cctx = zstd_create_cctx(level);
+    s->dctx = ZSTD_createDCtx();
+    s->level = level;
+    return s;
+}
+
+static bool zstd_load(void* state, const uint8_t* dict, size_t dict_size)
+{
+    zstd_dict_t* s = (zstd_dict_t*)state;
+    s->cdict = ZSTD_createCDict(dict, dict_size, s->level);
+    s->ddict = ZSTD_createDDict(dict, dict_size);
+    return s->cdict && s->ddict;
+}
+
+static int64_t zstd_compress(void* state, const uint8_t* in, size_t insize, uint8_t* out, size_t outsize)
+{
+    zstd_dict_t* s = (zstd_dict_t*)state;
+    size_t res = s->cdict ? ZSTD_compress_usingCDict(s->cctx, out, outsize, in, insize, s->cdict)
+                          : ZSTD_compress2(s->cctx, out, outsize, in, insize);
+    return ZSTD_isError(res) ? -1 : (int64_t)res;
+}
+
+static int64_t zstd_decompress(void* state, const uint8_t* in, size_t insize, uint8_t* out, size_t outsize)
+{
+    zstd_dict_t* s = (zstd_dict_t*)state;
+    size_t res = s->ddict ? ZSTD_decompress_usingDDict(s->dctx, out, outsize, in, insize, s->ddict)
+                          : ZSTD_decompressDCtx(s->dctx, out, outsize, in, insize);
+    return ZSTD_isError(res) ? -1 : (int64_t)res;
+}
+
+static void zstd_release(void* state)
+{
+    zstd_dict_t* s = (zstd_dict_t*)state;
+    ZSTD_freeCCtx(s->cctx);
+    ZSTD_freeDCtx(s->dctx);
+    ZSTD_freeCDict(s->cdict);
+    ZSTD_freeDDict(s->ddict);
+    free(s);
+}
+#endif
+
+
+#ifndef BENCH_REMOVE_LZ4
+typedef struct
+{
+    LZ4_stream_t stream;
+    LZ4_stream_t dict_stream;
+    const char* dict;
+    int dict_size, acceleration;
+} lz4_dict_t;
+
+static void* lz4_create(int level)
+{
+    lz4_dict_t* s = (lz4_dict_t*)malloc(sizeof(lz4_dict_t));
+    if (!s) return NULL;
+    LZ4_initStream(&s->stream, sizeof(s->stream));
+    LZ4_initStream(&s->dict_stream, sizeof(s->dict_stream));
+    s->dict = NULL;
+    s->dict_size = 0;
+    s->acceleration = MAX(level, 1);
+    return s;
+}
+
+// only the last 64 KB of the dictionary can be referenced
+static bool lz4_load(void* state, const uint8_t* dict, size_t dict_size)
+{
+    lz4_dict_t* s = (lz4_dict_t*)state;
+    s->dict_size = LZ4_loadDict(&s->dict_stream, (const char*)dict, (int)MIN(dict_size, (size_t)LZ4_MAX_INPUT_SIZE));
+    s->dict = (const char*)dict + dict_size - s->dict_size;
+    return true;
+}
+
+static int64_t lz4_compress(void* state, const uint8_t* in, size_t insize, uint8_t* out, size_t outsize)
+{
+    lz4_dict_t* s = (lz4_dict_t*)state;
+    LZ4_resetStream_fast(&s->stream);
+    if (s->dict) LZ4_attach_dictionary(&s->stream, &s->dict_stream);
+    return lz4_compress_continue(&s->stream, in, insize, out, outsize, s->acceleration);
+}
+
+static int64_t lz4_decompress(void* state, const uint8_t* in, size_t insize, uint8_t* out, size_t outsize)
+{
+    lz4_dict_t* s = (lz4_dict_t*)state;
+    return LZ4_decompress_safe_usingDict((const char*)in, (char*)out, (int)insize, LZ4_OUT_SIZE(outsize), s->dict, s->dict_size);
+}
+#endif
+
+
+#if !defined(BENCH_REMOVE_ZLIB) || !defined(BENCH_REMOVE_ZLIB_NG)
+/*
+ * The same functions for zlib and zlib-ng (zlib format, so the decoder asks for the dictionary
+ * with Z_NEED_DICT). Records are at most -b bytes and lengths are 32-bit, as in --stream.
+ */
+#define ZLIB_DICT_FUNCS(prefix, stream_t, deflateInit_f, deflateReset_f, deflateSetDictionary_f, deflate_f, deflateEnd_f, \
+                        inflateInit_f, inflateReset_f, inflateSetDictionary_f, inflate_f, inflateEnd_f) \
+typedef struct \
+{ \
+    stream_t c, d; \
+    const uint8_t* dict; \
+    uint32_t dict_size; \
+} prefix##_dict_t; \
+static void* prefix##_create(int level) \
+{ \
+    prefix##_dict_t* s = (prefix##_dict_t*)calloc(1, sizeof(prefix##_dict_t)); \
+    if (!s) return NULL; \
+    if (deflateInit_f(&s->c, level) != Z_OK) { free(s); return NULL; } \
+    if (inflateInit_f(&s->d) != Z_OK) { deflateEnd_f(&s->c); free(s); return NULL; } \
+    return s; \
+} \
+static bool prefix##_load(void* state, const uint8_t* dict, size_t dict_size) \
+{ \
+    prefix##_dict_t* s = (prefix##_dict_t*)state; \
+    s->dict = dict; \
+    s->dict_size = (uint32_t)MIN(dict_size, (size_t)UINT32_MAX); \
+    return deflateSetDictionary_f(&s->c, s->dict, s->dict_size) == Z_OK; \
+} \
+static int64_t prefix##_compress(void* state, const uint8_t* in, size_t insize, uint8_t* out, size_t outsize) \
+{ \
+    prefix##_dict_t* s = (prefix##_dict_t*)state; \
+    if (deflateReset_f(&s->c) != Z_OK) return -1; \
+    if (s->dict && deflateSetDictionary_f(&s->c, s->dict, s->dict_size) != Z_OK) return -1; \
+    zlib_set_buffers(&s->c, in, insize, out, outsize); \
+    if (deflate_f(&s->c, Z_FINISH) != Z_STREAM_END) return -1; \
+    return s->c.next_out - out; \
+} \
+static int64_t prefix##_decompress(void* state, const uint8_t* in, size_t insize, uint8_t* out, size_t outsize) \
+{ \
+    prefix##_dict_t* s = (prefix##_dict_t*)state; \
+    if (inflateReset_f(&s->d) != Z_OK) return -1; \
+    zlib_set_buffers(&s->d, in, insize, out, outsize); \
+    int ret = inflate_f(&s->d, Z_FINISH); \
+    if (ret == Z_NEED_DICT && s->dict) { \
+        if (inflateSetDictionary_f(&s->d, s->dict, s->dict_size) != Z_OK) return -1; \
+        ret = inflate_f(&s->d, Z_FINISH); \
+    } \
+    if (ret != Z_STREAM_END) return -1; \
+    return s->d.next_out - out; \
+} \
+static void prefix##_release(void* state) \
+{ \
+    prefix##_dict_t* s = (prefix##_dict_t*)state; \
+    deflateEnd_f(&s->c); \
+    inflateEnd_f(&s->d); \
+    free(s); \
+}
+#endif
+
+#ifndef BENCH_REMOVE_ZLIB
+ZLIB_DICT_FUNCS(zlib, z_stream, deflateInit, deflateReset, deflateSetDictionary, deflate, deflateEnd,
+                inflateInit, inflateReset, inflateSetDictionary, inflate, inflateEnd)
+#endif
+#ifndef BENCH_REMOVE_ZLIB_NG
+ZLIB_DICT_FUNCS(zlib_ng, zng_stream, zng_deflateInit, zng_deflateReset, zng_deflateSetDictionary, zng_deflate, zng_deflateEnd,
+                zng_inflateInit, zng_inflateReset, zng_inflateSetDictionary, zng_inflate, zng_inflateEnd)
+#endif
+
+
+#ifndef BENCH_REMOVE_BROTLI
+typedef struct
+{
+    BrotliEncoderPreparedDictionary* prepared;
+    const uint8_t* dict;
+    size_t dict_size;
+    int quality;
+} brotli_dict_t;
+
+static void* brotli_create(int level)
+{
+    brotli_dict_t* s = (brotli_dict_t*)calloc(1, sizeof(brotli_dict_t));
+    if (s) s->quality = level;
+    return s;
+}
+
+static bool brotli_load(void* state, const uint8_t* dict, size_t dict_size)
+{
+    brotli_dict_t* s = (brotli_dict_t*)state;
+    s->prepared = BrotliEncoderPrepareDictionary(BROTLI_SHARED_DICTIONARY_RAW, dict_size, dict, s->quality, NULL, NULL, NULL);
+    s->dict = dict;
+    s->dict_size = dict_size;
+    return s->prepared != NULL;
+}
+
+// brotli instances cannot be reset, so a new one is created for every record (with or without a dictionary)
+static int64_t brotli_compress(void* state, const uint8_t* in, size_t insize, uint8_t* out, size_t outsize)
+{
+    brotli_dict_t* s = (brotli_dict_t*)state;
+    BrotliEncoderState* enc = BrotliEncoderCreateInstance(NULL, NULL, NULL);
+    int64_t clen = -1;
+
+    if (enc) {
+        BrotliEncoderSetParameter(enc, BROTLI_PARAM_QUALITY, s->quality);
+        BrotliEncoderSetParameter(enc, BROTLI_PARAM_SIZE_HINT, (uint32_t)MIN(insize, (size_t)UINT32_MAX));
+        if (!s->prepared || BrotliEncoderAttachPreparedDictionary(enc, s->prepared))
+            clen = brotli_encode(enc, BROTLI_OPERATION_FINISH, in, insize, out, outsize);
+        BrotliEncoderDestroyInstance(enc);
+    }
+    return clen;
+}
+
+static int64_t brotli_decompress(void* state, const uint8_t* in, size_t insize, uint8_t* out, size_t outsize)
+{
+    brotli_dict_t* s = (brotli_dict_t*)state;
+    BrotliDecoderState* dec = BrotliDecoderCreateInstance(NULL, NULL, NULL);
+    int64_t dlen = -1;
+
+    if (dec) {
+        if (!s->dict || BrotliDecoderAttachDictionary(dec, BROTLI_SHARED_DICTIONARY_RAW, s->dict_size, s->dict))
+            dlen = brotli_decode(dec, in, insize, out, outsize, true);
+        BrotliDecoderDestroyInstance(dec);
+    }
+    return dlen;
+}
+
+static void brotli_release(void* state)
+{
+    brotli_dict_t* s = (brotli_dict_t*)state;
+    if (s->prepared) BrotliEncoderDestroyPreparedDictionary(s->prepared);
+    free(s);
+}
+#endif
+
+
+static const dict_desc_t dict_codecs[] =
+{
+#ifndef BENCH_REMOVE_ZSTD
+    { "zstd",     zstd_create,    zstd_load,    zstd_compress,    zstd_decompress,    zstd_release },
+#endif
+#ifndef BENCH_REMOVE_LZ4
+    { "lz4",      lz4_create,     lz4_load,     lz4_compress,     lz4_decompress,     free },
+    { "lz4fast",  lz4_create,     lz4_load,     lz4_compress,     lz4_decompress,     free },
+#endif
+#ifndef BENCH_REMOVE_ZLIB
+    { "zlib",     zlib_create,    zlib_load,    zlib_compress,    zlib_decompress,    zlib_release },
+#endif
+#ifndef BENCH_REMOVE_ZLIB_NG
+    { "zlib-ng",  zlib_ng_create, zlib_ng_load, zlib_ng_compress, zlib_ng_decompress, zlib_ng_release },
+#endif
+#ifndef BENCH_REMOVE_BROTLI
+    { "brotli",   brotli_create,  brotli_load,  brotli_compress,  brotli_decompress,  brotli_release },
+#endif
+    { NULL, NULL, NULL, NULL, NULL, NULL }
+};
+
+
+static bool read_file(const char* filename, std::vector<uint8_t>& data)
+{
+    FILE* in = fopen(filename, "rb");
+    if (!in) {
+        perror(filename);
+        return false;
+    }
+    fseeko(in, 0L, SEEK_END);
+    size_t size = ftello(in), pos = data.size();
+    rewind(in);
+    data.resize(pos + size);
+    size = size ? fread(&data[pos], 1, size, in) : 0;
+    data.resize(pos + size);
+    fclose(in);
+    return true;
+}
+
+
+// all files are read into one buffer and cut into records of at most record_size bytes, dataset names them
+static bool load_records(const char** inFileNames, unsigned ifnIdx, size_t record_size, std::vector<uint8_t>& data, std::vector<size_t>& records, std::string& dataset)
+{
+    int files = 0;
+
+    for (unsigned i=0; i<ifnIdx; i++)
+    {
+        if (UTIL_isDirectory(inFileNames[i])) {
+            fprintf(stderr, "warning: use -r to process directories (%s)\n", inFileNames[i]);
+            continue;
+        }
+        size_t start = data.size();
+        if (!read_file(inFileNames[i], data)) continue;
+        for (size_t pos = start; pos < data.size(); pos += record_size)
+            records.push_back(MIN(record_size, data.size() - pos));
+        if (files++ == 0) {
+            const char* pch = strrchr(inFileNames[i], '\\');
+            dataset = pch ? pch+1 : inFileNames[i];
+        }
+    }
+    if (files > 1) format(dataset, "%d files", files);
+    return !records.empty();
+}
+
+
+static size_t dict_record_size(lzbench_params_t *params)
+{
+    return params->chunk_size == LZBENCH_DEFAULT_CHUNK_SIZE ? DICT_DEFAULT_RECORD : params->chunk_size;
+}
+
+
+/*
+ * Splits the records into training samples (every DICT_TRAIN_EVERY-th record, fewer when they
+ * would be more than DICT_SAMPLE_RATIO times the dictionary size) and the held-out records.
+ */
+static void split_training(const uint8_t* data, const std::vector<size_t>& records, size_t dict_size,
+                           std::vector<uint8_t>& samples, std::vector<size_t>& sample_sizes, std::vector<uint8_t>& rest, std::vector<size_t>& rest_sizes)
+{
+    uint64_t total = 0;
+    for (size_t i=0; i<records.size(); i++) total += records[i];
+    size_t every = MAX((size_t)DICT_TRAIN_EVERY, (size_t)(total / ((uint64_t)DICT_SAMPLE_RATIO * dict_size) + 1));
+
+    for (size_t i=0; i<records.size(); data += records[i++])
+    {
+        if (i % every == 0) {
+            samples.insert(samples.end(), data, data + records[i]);
+            sample_sizes.push_back(records[i]);
+        } else {
+            rest.insert(rest.end(), data, data + records[i]);
+            rest_sizes.push_back(records[i]);
+        }
+    }
+}
+
+
+static void keep_best(uint64_t& best, int run, uint64_t nanosec)
+{
+    if (run == 0 || nanosec < best) best = nanosec;
+}
+
+
+/*
+ * Compresses and decompresses every record on its own, the best of DICT_RUNS passes over all
+ * records. With a dictionary the load is timed separately (the best of the runs as well).
+ */
+static bool run_records(lzbench_params_t *params, const dict_desc_t* dd, int level, const char* name, const uint8_t* dict, size_t dict_size,
+                        const uint8_t* data, const std::vector<size_t>& records, uint8_t* compbuf, size_t compsize, uint8_t* decomp, dict_result_t& res, bench_rate_t rate)
+{
+    bench_timer_t start_ticks, end_ticks;
+    std::vector<size_t> csizes(records.size());
+
+    res.size = res.comprsize = res.ctime = res.dtime = res.load_time = 0;
+    for (int r=0; r<DICT_RUNS; r++)
+    {
+        void* state = dd->create(level);
+        if (!state) { fprintf(stderr, "%s: --dict init error\n", name); return false; }
+        if (dict) {
+            GetTime(start_ticks);
+            bool loaded = dd->load(state, dict, dict_size);
+            GetTime(end_ticks);
+            if (!loaded) { fprintf(stderr, "%s: cannot load the dictionary\n", name); dd->release(state); return false; }
+            keep_best(res.load_time, r, GetDiffTime(rate, start_ticks, end_ticks));
+        }
+
+        size_t inpos = 0, outpos = 0;
+        GetTime(start_ticks);
+        for (size_t i=0; i<records.size(); i++)
+        {
+            int64_t clen = dd->compress(state, data + inpos, records[i], compbuf + outpos, compsize - outpos);
+            if (clen <= 0) {
+                fprintf(stderr, "%s: compression error in record %llu\n", name, (unsigned long long)i);
+                dd->release(state);
+                return false;
+            }
+            csizes[i] = clen;
+            inpos += records[i];
+            outpos += clen;
+        }
+        GetTime(end_ticks);
+        keep_best(res.ctime, r, GetDiffTime(rate, start_ticks, end_ticks));
+        res.size = inpos;
+        res.comprsize = outpos;
+
+        if (!params->compress_only) {
+            inpos = outpos = 0;
+            GetTime(start_ticks);
+            for (size_t i=0; i<records.size(); i++)
+            {
+                if (dd->decompress(state, compbuf + inpos, csizes[i], decomp + outpos, records[i]) != (int64_t)records[i]) break;
+                inpos += csizes[i];
+                outpos += records[i];
+            }
+            GetTime(end_ticks);
+            if (outpos != res.size || memcmp(data, decomp, res.size) != 0) {
+                fprintf(stderr, "%s: decompression error\n", name);
+                dd->release(state);
+                return false;
+            }
+            keep_best(res.dtime, r, GetDiffTime(rate, start_ticks, end_ticks));
+        }
+        dd->release(state);
+    }
+    return true;
+}
+
+
+static void print_dict_row(lzbench_params_t *params, const std::string& name, const char* dataset, size_t dict_size, const dict_result_t& plain, const dict_result_t& with_dict)
+{
+    if (params->textformat == NDJSON) {
+        printf("{\"type\":\"dict\",\"name\":%s,\"file\":%s,\"dict_size\":%llu,\"orig_size\":%llu,\"compr_size\":%llu,\"dict_compr_size\":%llu",
+               json_string(name).c_str(), json_string(dataset).c_str(), (unsigned long long)dict_size, (unsigned long long)plain.size,
+               (unsigned long long)plain.comprsize, (unsigned long long)with_dict.comprsize);
+        printf(",\"cspeed\":%.2f,\"dict_cspeed\":%.2f,\"dspeed\":%.2f,\"dict_dspeed\":%.2f,\"dict_load_us\":%.3f}\n", lzbench_speed(plain.size, plain.ctime),
+               lzbench_speed(with_dict.size, with_dict.ctime), lzbench_speed(plain.size, plain.dtime), lzbench_speed(with_dict.size, with_dict.dtime), with_dict.load_time / 1000.0);
+        return;
+    }
+
+    printf("%-23s size %.2f%% -> %.2f%% (%.1f%% smaller), compression %.1f -> %.1f MB/s", name.c_str(), plain.comprsize * 100.0 / plain.size,
+           with_dict.comprsize * 100.0 / with_dict.size, (1 - (double)with_dict.comprsize / plain.comprsize) * 100,
+           lzbench_speed(plain.size, plain.ctime), lzbench_speed(with_dict.size, with_dict.ctime));
+    if (!params->compress_only)
+        printf(", decompression %.1f -> %.1f MB/s", lzbench_speed(plain.size, plain.dtime), lzbench_speed(with_dict.size, with_dict.dtime));
+    printf(", dictionary load %.3f ms\n", with_dict.load_time / 1000000.0);
+}
+
+
+int lzbench_dict(lzbench_params_t *params, const char** inFileNames, unsigned ifnIdx, char* encoder_list, size_t dict_size, const char* dict_file)
+{
+    std::vector<codec_candidate_t> all, candidates;
+    std::vector<const dict_desc_t*> dict_descs;
+    std::vector<uint8_t> data, dict, samples, bench;
+    std::vector<size_t> records, sample_sizes, bench_sizes;
+    bench_timer_t start_ticks, end_ticks;
+    bench_rate_t rate;
+    std::string dataset;
+
+    InitTimer(rate);
+    lzbench_expand_codec_list(params, encoder_list ? encoder_list : DICT_DEFAULT_CODECS, all);
+    for (size_t k=0; k<all.size(); k++)
+    {
+        const dict_desc_t* dd = find_state_codec(dict_codecs, all[k].desc->name);
+        if (!dd) {
+            fprintf(stderr, "--dict: %s is not supported (use zstd, lz4, lz4fast, zlib, zlib-ng or brotli), skipped\n", all[k].desc->name);
+            continue;
+        }
+        if (!all[k].kv.empty())
+            fprintf(stderr, "warning: --dict ignores parameters of %s\n", all[k].desc->name);
+        candidates.push_back(all[k]);
+        dict_descs.push_back(dd);
+    }
+    if (candidates.empty()) return 1;
+
+    if (dict_file && (!read_file(dict_file, dict) || dict.empty())) {
+        fprintf(stderr, "--dict-file: cannot read the dictionary %s\n", dict_file);
+        return 1;
+    }
+    if (!load_records(inFileNames, ifnIdx, dict_record_size(params), data, records, dataset)) return 1;
+
+    uint64_t train_time = 0;
+    if (dict_file) {
+        bench.swap(data);
+        bench_sizes.swap(records);
+    } else {
+#ifndef BENCH_REMOVE_ZSTD
+        split_training(&data[0], records, dict_size, samples, sample_sizes, bench, bench_sizes);
+        dict.resize(dict_size);
+        GetTime(start_ticks);
+        size_t res = samples.empty() ? 0 : ZDICT_trainFromBuffer(&dict[0], dict.size(), &samples[0], &sample_sizes[0], (unsigned)sample_sizes.size());
+        GetTime(end_ticks);
+        if (samples.empty() || ZDICT_isError(res)) {
+            fprintf(stderr, "--dict: training failed on %d samples (%s), use more or larger records\n", (int)sample_sizes.size(),
+                    samples.empty() ? "no data" : ZDICT_getErrorName(res));
+            return 1;
+        }
+        dict.resize(res);
+        train_time = GetDiffTime(rate, start_ticks, end_ticks);
+#else
+        fprintf(stderr, "--dict: training requires zstd, use --dict-file\n");
+        return 1;
+#endif
+    }
+    if (bench_sizes.empty()) {
+        fprintf(stderr, "--dict: no records left to benchmark\n");
+        return 1;
+    }
+
+    size_t compsize = GET_COMPRESS_BOUND(bench.size()) + bench_sizes.size() * PAD_SIZE;
+    uint8_t* compbuf = (uint8_t*)alloc_and_touch(compsize, false);
+    uint8_t* decomp = (uint8_t*)alloc_and_touch(bench.size() + lzbench_max_padding(), false);
+    if (!compbuf || !decomp) {
+        printf("Not enough memory!");
+        free(compbuf);
+        free(decomp);
+        return 3;
+    }
+
+    if (params->textformat == NDJSON)
+        printf("{\"type\":\"dict_info\",\"file\":%s,\"dict_size\":%llu,\"records\":%llu,\"train_records\":%llu,\"train_ms\":%.3f}\n", json_string(dataset).c_str(),
+               (unsigned long long)dict.size(), (unsigned long long)bench_sizes.size(), (unsigned long long)sample_sizes.size(), train_time / 1000000.0);
+    else if (dict_file)
+        printf("\nDictionary %s of %llu bytes on %llu records of up to %llu bytes of %s:\n", dict_file, (unsigned long long)dict.size(),
+               (unsigned long long)bench_sizes.size(), (unsigned long long)dict_record_size(params), dataset.c_str());
+    else
+        printf("\nDictionary of %llu bytes trained on %llu records in %.1f ms, benchmarked on the other %llu records of up to %llu bytes of %s:\n",
+               (unsigned long long)dict.size(), (unsigned long long)sample_sizes.size(), train_time / 1000000.0, (unsigned long long)bench_sizes.size(),
+               (unsigned long long)dict_record_size(params), dataset.c_str());
+
+    for (size_t k=0; k<candidates.size(); k++)
+    {
+        const codec_candidate_t& c = candidates[k];
+        dict_result_t plain, with_dict;
+        std::string name;
+
+        if (c.desc->first_level == 0 && c.desc->last_level == 0)
+            format(name, "%s", c.desc->name_version);
+        else
+            format(name, "%s -%d", c.desc->name_version, c.level);
+
+        LZBENCH_STDERR(2, "%s with a dictionary     \r", name.c_str());
+        if (!run_records(params, dict_descs[k], c.level, name.c_str(), NULL, 0, &bench[0], bench_sizes, compbuf, compsize, decomp, plain, rate)
+            || !run_records(params, dict_descs[k], c.level, name.c_str(), &dict[0], dict.size(), &bench[0], bench_sizes, compbuf, compsize, decomp, with_dict, rate)) {
+            g_exit_result = 10;
+            continue;
+        }
+        print_dict_row(params, name, dataset.c_str(), dict.size(), plain, with_dict);
+    }
+
+    free(compbuf);
+    free(decomp);
+    return g_exit_result;
+}
+
+
+typedef struct
+{
+    std::vector<unsigned> size, algo, k, d, steps, accel;  // algo: 1 for fastCover, 0 for COVER
+    std::vector<double> split;
+    int level;
+} dict_train_spec_t;
+
+typedef struct
+{
+    bool fast, optimize;
+    unsigned size, k, d, steps, accel;
+    double split;
+} dict_train_cfg_t;
+
+typedef struct
+{
+    size_t dict_size;     // or a ZDICT error code
+    uint64_t nanosec, peak_kb;
+    unsigned k, d;        // the values chosen by the optimizer
+} dict_train_result_t;
+
+
+// SPEC is a comma-separated list of KEY=V1:V2:...; all combinations of the values are trained
+static bool parse_train_spec(const char* text, dict_train_spec_t& spec)
+{
+    std::string items = text;
+    size_t start = 0;
+
+    spec = dict_train_spec_t();
+    spec.level = 3;
+    while (start < items.size())
+    {
+        size_t end = items.find(',', start);
+        if (end == std::string::npos) end = items.size();
+        std::string item = items.substr(start, end - start);
+        size_t eq = item.find('=');
+        std::string key = item.substr(0, eq);
+        if (eq == std::string::npos || eq + 1 == item.size()) return false;
+
+        std::vector<unsigned>* list = NULL;
+        if (key == "size") list = &spec.size;
+        else if (key == "k") list = &spec.k;
+        else if (key == "d") list = &spec.d;
+        else if (key == "steps") list = &spec.steps;
+        else if (key == "accel") list = &spec.accel;
+        else if (key != "algo" && key != "split" && key != "level") return false;
+
+        const char* p = item.c_str() + eq + 1;
+        while (true)
+        {
+            const char* colon = strchr(p, ':');
+            std::string value = colon ? std::string(p, colon - p) : std::string(p);
+            char* rest;
+            if (key == "algo") {
+                if (value == "cover") spec.algo.push_back(0);
+                else if (value == "fastcover") spec.algo.push_back(1);
+                else return false;
+            } else if (key == "split") {
+                double split = strtod(value.c_str(), &rest);
+                if (value.empty() || *rest || split <= 0 || split > 1) return false;
+                spec.split.push_back(split);
+            } else if (key == "level") {
+                spec.level = (int)strtol(value.c_str(), &rest, 10);
+                if (value.empty() || *rest || colon) return false;
+            } else {
+                unsigned long v = strtoul(value.c_str(), &rest, 10);
+                if (value.empty() || *rest || (key == "size" && (v < 1 || v > DICT_MAX_SIZE_KB)) || (key == "accel" && v > 10)) return false;
+                list->push_back((unsigned)v);
+            }
+            if (!colon) break;
+            p = colon + 1;
+        }
+        start = end + 1;
+    }
+    return true;
+}
+
+
+bool lzbench_dict_train_spec_valid(const char* text)
+{
+    dict_train_spec_t spec;
+    if (parse_train_spec(text, spec)) return true;
+    fprintf(stderr, "--dict-train: expected KEY=V1:V2:... separated with commas, keys: size (1-%d KB), algo (cover, fastcover), k, d, steps, split (0-1], accel (0-10), level\n", DICT_MAX_SIZE_KB);
+    return false;
+}
+
+
+// --dict=KB: the size of the trained dictionary
+bool lzbench_dict_size_parse(const char* text, size_t* dict_size)
+{
+    char* end;
+    unsigned long kb = strtoul(text, &end, 10);
+
+    if (end == text || *end != 0 || kb < 1 || kb > DICT_MAX_SIZE_KB) {
+        fprintf(stderr, "--dict: expected the dictionary size of 1 to %d KB\n", DICT_MAX_SIZE_KB);
+        return false;
+    }
+    *dict_size = (size_t)kb << 10;
+    return true;
+}
+
+
+#ifndef BENCH_REMOVE_ZSTD
+// k or d of 0 asks ZDICT_optimizeTrainFromBuffer_*() to search for it, steps and split only apply then
+static void expand_train_spec(const dict_train_spec_t& spec, std::vector<dict_train_cfg_t>& configs)
+{
+    for (size_t a=0; a<spec.algo.size(); a++)
+    for (size_t s=0; s<spec.size.size(); s++)
+    for (size_t k=0; k<spec.k.size(); k++)
+    for (size_t d=0; d<spec.d.size(); d++)
+    for (size_t st=0; st<spec.steps.size(); st++)
+    for (size_t sp=0; sp<spec.split.size(); sp++)
+    for (size_t ac=0; ac<spec.accel.size(); ac++)
+    {
+        dict_train_cfg_t c;
+        c.fast = spec.algo[a] != 0;
+        c.size = spec.size[s] << 10;
+        c.k = spec.k[k];
+        c.d = spec.d[d];
+        c.optimize = !c.k || !c.d;
+        c.steps = c.optimize ? spec.steps[st] : 0;
+        c.split = c.optimize ? spec.split[sp] : 1.0;
+        c.accel = c.fast ? spec.accel[ac] : 0;
+
+        bool found = false;
+        for (size_t i=0; i<configs.size() && !found; i++)
+            found = configs[i].fast == c.fast && configs[i].size == c.size && configs[i].k == c.k && configs[i].d == c.d
+                    && configs[i].steps == c.steps && configs[i].split == c.split && configs[i].accel == c.accel;
+        if (!found) configs.push_back(c);
+    }
+}
+
+
+static size_t train_dict(const dict_train_cfg_t& c, int level, const std::vector<uint8_t>& samples, const std::vector<size_t>& sample_sizes, uint8_t* dict, unsigned& k, unsigned& d)
+{
+    size_t res;
+
+    if (c.fast) {
+        ZDICT_fastCover_params_t p;
+        memset(&p, 0, sizeof(p));
+        p.k = c.k;
+        p.d = c.d;
+        p.steps = c.steps;
+        p.splitPoint = c.split;
+        p.accel = c.accel;
+        p.nbThreads = 1;
+        p.zParams.compressionLevel = level;
+        if (c.optimize)
+            res = ZDICT_optimizeTrainFromBuffer_fastCover(dict, c.size, &samples[0], &sample_sizes[0], (unsigned)sample_sizes.size(), &p);
+        else
+            res = ZDICT_trainFromBuffer_fastCover(dict, c.size, &samples[0], &sample_sizes[0], (unsigned)sample_sizes.size(), p);
+        k = p.k;
+        d = p.d;
+    } else {
+        ZDICT_cover_params_t p;
+        memset(&p, 0, sizeof(p));
+        p.k = c.k;
+        p.d = c.d;
+        p.steps = c.steps;
+        p.splitPoint = c.split;
+        p.nbThreads = 1;
+        p.zParams.compressionLevel = level;
+        if (c.optimize)
+            res = ZDICT_optimizeTrainFromBuffer_cover(dict, c.size, &samples[0], &sample_sizes[0], (unsigned)sample_sizes.size(), &p);
+        else
+            res = ZDICT_trainFromBuffer_cover(dict, c.size, &samples[0], &sample_sizes[0], (unsigned)sample_sizes.size(), p);
+        k = p.k;
+        d = p.d;
+    }
+    return res;
+}
+
+
+static uint64_t peak_rss_kb()
+{
+#ifdef WINDOWS
+    return 0;
+#else
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#if defined(__APPLE__) || defined(__MACH__)
+    return usage.ru_maxrss >> 10;  // bytes on macOS
+#else
+    return usage.ru_maxrss;
+#endif
+#endif
+}
+
+
+static void train_timed(const dict_train_cfg_t& c, int level, const std::vector<uint8_t>& samples, const std::vector<size_t>& sample_sizes, uint8_t* dict, dict_train_result_t& res, bench_rate_t rate)
+{
+    bench_timer_t start_ticks, end_ticks;
+    uint64_t rss = peak_rss_kb();
+
+    GetTime(start_ticks);
+    res.dict_size = train_dict(c, level, samples, sample_sizes, dict, res.k, res.d);
+    GetTime(end_ticks);
+    res.nanosec = GetDiffTime(rate, start_ticks, end_ticks);
+    res.peak_kb = peak_rss_kb() - rss;
+}
+
+
+#ifndef WINDOWS
+static bool write_all(int fd, const void* buf, size_t size)
+{
+    for (size_t done = 0; done < size; )
+    {
+        ssize_t n = write(fd, (const char*)buf + done, size - done);
+        if (n <= 0) return false;
+        done += n;
+    }
+    return true;
+}
+
+
+static bool read_all(int fd, void* buf, size_t size)
+{
+    for (size_t done = 0; done < size; )
+    {
+        ssize_t n = read(fd, (char*)buf + done, size - done);
+        if (n <= 0) return false;
+        done += n;
+    }
+    return true;
+}
+#endif
+
+
+/*
+ * Trains in a child process, so that its peak RSS above the RSS at the start is the memory
+ * used by the trainer alone. The result and the dictionary come back through a pipe. Without
+ * fork (Windows) the training runs in this process and the peak memory is not known.
+ */
+static bool train_config(const dict_train_cfg_t& c, int level, const std::vector<uint8_t>& samples, const std::vector<size_t>& sample_sizes, std::vector<uint8_t>& dict, dict_train_result_t& res, bench_rate_t rate)
+{
+    dict.resize(c.size);
+#ifdef WINDOWS
+    train_timed(c, level, samples, sample_sizes, &dict[0], res, rate);
+    res.peak_kb = 0;
+#else
+    int fds[2], status;
+    if (pipe(fds) != 0) return false;
+    fflush(stdout);
+    fflush(stderr);
+    pid_t pid = fork();
+    if (pid < 0) {
+        close(fds[0]);
+        close(fds[1]);
+        return false;
+    }
+    if (pid == 0) {
+        close(fds[0]);
+        train_timed(c, level, samples, sample_sizes, &dict[0], res, rate);
+        bool ok = write_all(fds[1], &res, sizeof(res)) && (ZDICT_isError(res.dict_size) || write_all(fds[1], &dict[0], res.dict_size));
+        _exit(ok ? 0 : 1);
+    }
+    close(fds[1]);
+    bool ok = read_all(fds[0], &res, sizeof(res)) && (ZDICT_isError(res.dict_size) || (res.dict_size <= dict.size() && read_all(fds[0], &dict[0], res.dict_size)));
+    close(fds[0]);
+    ok = waitpid(pid, &status, 0) == pid && WIFEXITED(status) && WEXITSTATUS(status) == 0 && ok;
+    if (!ok) return false;
+#endif
+    if (!ZDICT_isError(res.dict_size)) dict.resize(res.dict_size);
+    return true;
+}
+
+
+static std::string config_name(const dict_train_cfg_t& c, const dict_train_result_t& res)
+{
+    std::string name, part;
+
+    format(name, "%s k=%u%s d=%u%s", c.fast ? "fastcover" : "cover", res.k, c.k ? "" : "*", res.d, c.d ? "" : "*");
+    if (c.optimize) {
+        format(part, " steps=%u split=%.2f", c.steps, c.split);
+        name += part;
+    }
+    if (c.fast) {
+        format(part, " accel=%u", c.accel);
+        name += part;
+    }
+    return name;
+}
+
+
+int lzbench_dict_train(lzbench_params_t *params, const char** inFileNames, unsigned ifnIdx, const char* spec_text)
+{
+    std::vector<uint8_t> data, dict, samples, bench;
+    std::vector<size_t> records, sample_sizes, bench_sizes;
+    std::vector<dict_train_cfg_t> configs;
+    dict_train_spec_t spec, defaults;
+    dict_result_t plain;
+    bench_rate_t rate;
+    std::string dataset;
+
+    InitTimer(rate);
+    parse_train_spec(DICT_TRAIN_DEFAULT, defaults);
+    if (!parse_train_spec(spec_text ? spec_text : "", spec)) return 1;
+    if (spec.size.empty()) spec.size = defaults.size;
+    if (spec.algo.empty()) spec.algo = defaults.algo;
+    if (spec.k.empty()) spec.k = defaults.k;
+    if (spec.d.empty()) spec.d = defaults.d;
+    if (spec.steps.empty()) spec.steps = defaults.steps;
+    if (spec.split.empty()) spec.split = defaults.split;
+    if (spec.accel.empty()) spec.accel = defaults.accel;
+    expand_train_spec(spec, configs);
+
+    if (!load_records(inFileNames, ifnIdx, dict_record_size(params), data, records, dataset)) return 1;
+    size_t max_size = 0;
+    for (size_t i=0; i<configs.size(); i++) max_size = MAX(max_size, (size_t)configs[i].size);
+    split_training(&data[0], records, max_size, samples, sample_sizes, bench, bench_sizes);
+    if (samples.empty() || bench_sizes.empty()) {
+        fprintf(stderr, "--dict-train: %d records are not enough for training and a held-out set\n", (int)records.size());
+        return 1;
+    }
+
+    size_t compsize = GET_COMPRESS_BOUND(bench.size()) + bench_sizes.size() * PAD_SIZE;
+    uint8_t* compbuf = (uint8_t*)alloc_and_touch(compsize, false);
+    uint8_t* decomp = (uint8_t*)alloc_and_touch(bench.size() + lzbench_max_padding(), false);
+    if (!compbuf || !decomp) {
+        printf("Not enough memory!");
+        free(compbuf);
+        free(decomp);
+        return 3;
+    }
+
+    const dict_desc_t* zstd = find_state_codec(dict_codecs, "zstd");
+    std::string level_name;
+    format(level_name, "zstd -%d", spec.level);
+    if (!run_records(params, zstd, spec.level, level_name.c_str(), NULL, 0, &bench[0], bench_sizes, compbuf, compsize, decomp, plain, rate)) {
+        free(compbuf);
+        free(decomp);
+        return 10;
+    }
+
+    uint64_t sample_total = samples.size();
+    if (params->textformat == NDJSON)
+        printf("{\"type\":\"dict_train_info\",\"file\":%s,\"train_records\":%llu,\"train_size\":%llu,\"records\":%llu,\"level\":%d,\"compr_size\":%llu}\n",
+               json_string(dataset).c_str(), (unsigned long long)sample_sizes.size(), (unsigned long long)sample_total,
+               (unsigned long long)bench_sizes.size(), spec.level, (unsigned long long)plain.comprsize);
+    else {
+        printf("\nDictionary training on %llu records (%llu bytes) of %s, gain with zstd -%d on the other %llu records (size %.2f%% without a dictionary):\n",
+               (unsigned long long)sample_sizes.size(), (unsigned long long)sample_total, dataset.c_str(), spec.level,
+               (unsigned long long)bench_sizes.size(), plain.comprsize * 100.0 / plain.size);
+        printf("%-52s %10s %10s %9s %7s %7s %10s %10s\n", "Trainer (* chosen by the optimizer)", "Dict", "Train ms", "Peak MB", "Size %", "Gain", "Comp MB/s", "Dec MB/s");
+    }
+
+    for (size_t i=0; i<configs.size(); i++)
+    {
+        const dict_train_cfg_t& c = configs[i];
+        dict_train_result_t res;
+        dict_result_t with_dict;
+
+        LZBENCH_STDERR(2, "training %d of %d     \r", (int)i + 1, (int)configs.size());
+        if (!train_config(c, spec.level, samples, sample_sizes, dict, res, rate)) {
+            fprintf(stderr, "--dict-train: the training process failed\n");
+            g_exit_result = 10;
+            continue;
+        }
+        std::string name = config_name(c, res);
+        if (ZDICT_isError(res.dict_size)) {
+            fprintf(stderr, "%s: training failed (%s)\n", name.c_str(), ZDICT_getErrorName(res.dict_size));
+            g_exit_result = 10;
+            continue;
+        }
+        if (!run_records(params, zstd, spec.level, name.c_str(), &dict[0], dict.size(), &bench[0], bench_sizes, compbuf, compsize, decomp, with_dict, rate)) {
+            g_exit_result = 10;
+            continue;
+        }
+
+        double gain = (1 - (double)with_dict.comprsize / plain.comprsize) * 100;
+        if (params->textformat == NDJSON) {
+            printf("{\"type\":\"dict_train\",\"file\":%s,\"trainer\":%s,\"k\":%u,\"d\":%u,\"steps\":%u,\"split\":%.3f,\"accel\":%u,\"optimize\":%s",
+                   json_string(dataset).c_str(), c.fast ? "\"fastcover\"" : "\"cover\"", res.k, res.d, c.steps, c.split, c.accel, c.optimize ? "true" : "false");
+            printf(",\"max_dict_size\":%u,\"dict_size\":%llu,\"train_ms\":%.3f,\"peak_kb\":%llu,\"dict_compr_size\":%llu,\"gain_pct\":%.2f,\"dict_cspeed\":%.2f,\"dict_dspeed\":%.2f}\n",
+                   c.size, (unsigned long long)res.dict_size, res.nanosec / 1000000.0, (unsigned long long)res.peak_kb, (unsigned long long)with_dict.comprsize,
+                   gain, lzbench_speed(with_dict.size, with_dict.ctime), lzbench_speed(with_dict.size, with_dict.dtime));
+            continue;
+        }
+        printf("%-52s %10llu %10.1f ", name.c_str(), (unsigned long long)res.dict_size, res.nanosec / 1000000.0);
+#ifdef WINDOWS
+        printf("%9s", "-");
+#else
+        printf("%9.1f", res.peak_kb / 1024.0);
+#endif
+        printf(" %7.2f %6.1f%% %10.1f %10.1f\n", with_dict.comprsize * 100.0 / with_dict.size, gain,
+               lzbench_speed(with_dict.size, with_dict.ctime), lzbench_speed(with_dict.size, with_dict.dtime));
+    }
+
+    free(compbuf);
+    free(decomp);
+    return g_exit_result;
+}
+#else
+int lzbench_dict_train(lzbench_params_t *params, const char** inFileNames, unsigned ifnIdx, const char* spec_text)
+{
+    fprintf(stderr, "--dict-train requires zstd\n");
+    return 1;
+}
+#endif
@@ -0,0 +1,214 @@
+/*
+ * Copyright (c) Przemyslaw Skibinski <inikep@gmail.com>
+ * All rights reserved.
+ *
+ * This source code is dual-licensed under the GPLv2 and GPLv3 licenses.
+ * For additional details, refer to the LICENSE file located in the root
+ * directory of this source tree.
+ *
+ * fallback.cpp: incompressible chunk detection with a "store raw" fallback (--store-fallback)
+ *
+ * Every codec is measured twice: as usual and as "+store", where a detector runs on each chunk
+ * inside the timed loops and chunks it finds incompressible are copied instead of compressed
+ * (and copied back instead of decompressed). The detector looks at about a quarter of the chunk,
+ * at most STORE_BLOCKS blocks of STORE_BLOCK_SIZE bytes spread over it:
+ *   entropy   order-0 entropy of a byte histogram (four interleaved tables) >= STORE_MIN_ENTROPY
+ *   lz4       lz4 saves less than STORE_MIN_SAVING on the sampled blocks
+ * The report compares both runs and the cost of the detector alone.
+ */
+
+#include "lzbench.h"
+#include <math.h>    // log2
+#include <string.h>
+
+#define STORE_BLOCKS        16
+#define STORE_BLOCK_SIZE    4096
+#define STORE_MIN_SAVING    0.03   // of the sampled size
+#define STORE_RUNS          3
+
+
+bool lzbench_store_parse(const char* method, lzbench_params_t *params)
+{
+    if (!method || !strcmp(method, "entropy"))
+        params->store_fallback = STORE_ENTROPY;
+    else if (!strcmp(method, "lz4"))
+    {
+        const compressor_desc_t* lz4 = lzbench_find_codec("lz4");
+        if (!lz4 || !lz4->compress) {
+            fprintf(stderr, "--store-fallback=lz4: lz4 is not built in\n");
+            return false;
+        }
+        params->store_fallback = STORE_LZ4;
+    }
+    else {
+        fprintf(stderr, "--store-fallback: unknown detector \"%s\" (use entropy or lz4)\n", method);
+        return false;
+    }
+    return true;
+}
+
+
+// sampled blocks: the first one at the start of the chunk, the last one at its end
+static void sample_plan(size_t size, size_t& blocks, size_t& block_size, size_t& stride)
+{
+    blocks = MIN(MAX(size / (4 * STORE_BLOCK_SIZE), (size_t)1), (size_t)STORE_BLOCKS);
+    block_size = MIN(size, (size_t)STORE_BLOCK_SIZE);
+    stride = (blocks > 1) ? (size - block_size) / (blocks - 1) : 0;
+}
+
+
+// order-0 entropy of the sampled blocks in bits per byte
+double lzbench_sample_entropy(const uint8_t* chunk, size_t size)
+{
+    uint32_t hist[4][256];
+    size_t blocks, block_size, stride;
+    sample_plan(size, blocks, block_size, stride);
+    size_t n = blocks * block_size;
+
+    memset(hist, 0, sizeof(hist));
+    for (size_t b=0; b<blocks; b++)
+    {
+        const uint8_t* p = chunk + b * stride;
+        size_t i = 0;
+        // four tables avoid stalls on repeated bytes, as in histogram loops of entropy coders
+        for (; i + 4 <= block_size; i += 4)
+        {
+            hist[0][p[i]]++;
+            hist[1][p[i+1]]++;
+            hist[2][p[i+2]]++;
+            hist[3][p[i+3]]++;
+        }
+        for (; i < block_size; i++)
+            hist[0][p[i]]++;
+    }
+
+    double entropy = 0;
+    for (int c=0; c<256; c++)
+    {
+        uint32_t count = hist[0][c] + hist[1][c] + hist[2][c] + hist[3][c];
+        if (count) entropy -= count * log2((double)count / n);
+    }
+    return n ? entropy / n : 0;
+}
+
+
+// true when lz4 saves less than STORE_MIN_SAVING on the sampled blocks
+bool lzbench_sample_lz4_incompressible(const uint8_t* chunk, size_t size)
+{
+    static const compressor_desc_t* lz4 = lzbench_find_codec("lz4");
+    static char out[GET_COMPRESS_BOUND(STORE_BLOCK_SIZE)];
+    codec_options_t codec_options = { 0, 0, NULL, 0, NULL };
+    size_t blocks, block_size, stride;
+    uint64_t compressed = 0;
+
+    sample_plan(size, blocks, block_size, stride);
+    for (size_t b=0; b<blocks; b++)
+    {
+        int64_t clen = lz4->compress((char*)chunk + b * stride, block_size, out, sizeof(out), &codec_options);
+        compressed += (clen > 0) ? clen : block_size;
+    }
+    return compressed >= blocks * block_size * (1 - STORE_MIN_SAVING);
+}
+
+
+bool lzbench_store_detect(lzbench_params_t *params, const uint8_t* chunk, size_t size)
+{
+    if (params->store_fallback == STORE_LZ4)
+        return lzbench_sample_lz4_incompressible(chunk, size);
+    return lzbench_sample_entropy(chunk, size) >= STORE_MIN_ENTROPY;
+}
+
+
+// runs the detector alone over all chunks of the current input (the best of STORE_RUNS)
+void lzbench_store_measure(lzbench_params_t *params, size_t chunk_size, std::vector<size_t> &chunk_sizes, uint8_t *inbuf, bench_rate_t rate)
+{
+    bench_timer_t start_ticks, end_ticks;
+    store_detect_t d;
+
+    // -b sizes larger than the input give the same chunks again
+    for (size_t i=0; i<params->store_detect.size(); i++)
+        if (params->store_detect[i].filename == params->in_filename && params->store_detect[i].chunk_size == chunk_size) return;
+
+    d.filename = params->in_filename;
+    d.chunk_size = chunk_size;
+    d.chunks = chunk_sizes.size();
+    d.nanosec = 0;
+    for (int r=0; r<STORE_RUNS; r++)
+    {
+        uint8_t* chunk = inbuf;
+        d.stored = d.size = d.stored_size = 0;
+        GetTime(start_ticks);
+        for (size_t i=0; i<chunk_sizes.size(); i++)
+        {
+            if (lzbench_store_detect(params, chunk, chunk_sizes[i])) {
+                d.stored++;
+                d.stored_size += chunk_sizes[i];
+            }
+            d.size += chunk_sizes[i];
+            chunk += chunk_sizes[i];
+        }
+        GetTime(end_ticks);
+        uint64_t nanosec = GetDiffTime(rate, start_ticks, end_ticks);
+        if (r == 0 || nanosec < d.nanosec) d.nanosec = nanosec;
+    }
+    params->store_detect.push_back(d);
+}
+
+
+static void print_speed_change(const char* name, uint64_t size, uint64_t before, uint64_t after)
+{
+    double s0 = lzbench_speed(size, before), s1 = lzbench_speed(size, after);
+    printf("  %s %.1f -> %.1f MB/s", name, s0, s1);
+    if (s0 > 0 && s1 > 0) printf(" (%+.1f%%)", (s1 - s0) * 100 / s0);
+}
+
+
+void lzbench_store_report(lzbench_params_t *params)
+{
+    const char* detector = params->store_fallback == STORE_LZ4 ? "lz4" : "entropy";
+
+    if (params->textformat != NDJSON)
+        printf("\nStore fallback with the %s detector (%s):\n", detector,
+               params->store_fallback == STORE_LZ4 ? "lz4 saves < 3% of sampled blocks" : "order-0 entropy >= 7.8 bits/byte");
+
+    for (size_t f=0; f<params->store_detect.size(); f++)
+    {
+        const store_detect_t& d = params->store_detect[f];
+        std::string name = d.filename;
+        if (params->chunk_sweep.size() > 1) name += format_chunk_size(d.chunk_size);
+        if (params->textformat == NDJSON)
+            printf("{\"type\":\"store_detect\",\"file\":%s,\"chunk_size\":%llu,\"detector\":\"%s\",\"chunks\":%llu,\"stored_chunks\":%llu,\"stored_pct\":%.2f,\"detector_mbps\":%.1f}\n",
+                   json_string(d.filename).c_str(), (unsigned long long)d.chunk_size, detector, (unsigned long long)d.chunks, (unsigned long long)d.stored,
+                   d.size ? d.stored_size * 100.0 / d.size : 0, lzbench_speed(d.size, d.nanosec));
+        else
+            printf("%s: %llu of %llu chunks incompressible (%.1f%% of bytes), detector %.1f MB/s (%.3f ms)\n", name.c_str(),
+                   (unsigned long long)d.stored, (unsigned long long)d.chunks, d.size ? d.stored_size * 100.0 / d.size : 0,
+                   lzbench_speed(d.size, d.nanosec), d.nanosec / 1000000.0);
+
+        // every "+store" row directly follows the row of the same codec without the fallback
+        for (size_t i=0; i+1<params->results.size(); i++)
+        {
+            const string_table_t& r = params->results[i];
+            const string_table_t& s = params->results[i+1];
+            if (r.col6_filename != d.filename || s.col6_filename != d.filename || r.chunk_size != d.chunk_size || s.chunk_size != d.chunk_size) continue;
+            if (s.codec != r.codec || s.level != r.level) continue;
+            if (s.codec_params.find("store=") == std::string::npos || r.codec_params.find("store=") != std::string::npos) continue;
+
+            if (params->textformat == NDJSON) {
+                printf("{\"type\":\"store\",\"name\":%s,\"file\":%s,\"chunk_size\":%llu,\"size_pct\":%.2f,\"store_size_pct\":%.2f,\"cspeed\":%.2f,\"store_cspeed\":%.2f",
+                       json_string(r.col1_algname).c_str(), json_string(d.filename).c_str(), (unsigned long long)d.chunk_size,
+                       r.col4_comprsize * 100.0 / r.col5_origsize, s.col4_comprsize * 100.0 / s.col5_origsize,
+                       lzbench_speed(r.col5_origsize, r.col2_ctime), lzbench_speed(s.col5_origsize, s.col2_ctime));
+                if (!params->compress_only)
+                    printf(",\"dspeed\":%.2f,\"store_dspeed\":%.2f", lzbench_speed(r.col5_origsize, r.col3_dtime), lzbench_speed(s.col5_origsize, s.col3_dtime));
+                printf("}\n");
+                continue;
+            }
+            printf("%-23s size %.2f%% -> %.2f%%", r.col1_algname.c_str(), r.col4_comprsize * 100.0 / r.col5_origsize, s.col4_comprsize * 100.0 / s.col5_origsize);
+            print_speed_change("compression", r.col5_origsize, r.col2_ctime, s.col2_ctime);
+            if (!params->compress_only)
+                print_speed_change("decompression", r.col5_origsize, r.col3_dtime, s.col3_dtime);
+            printf("\n");
+        }
+    }
+}
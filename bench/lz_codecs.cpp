@@ -68,11 +68,51 @@ int64_t lzbench_brotli_compress(char *inbuf, size_t insize, char *outbuf, size_t
     if (!windowLog) windowLog = BROTLI_DEFAULT_WINDOW; // sliding window size. Range is 10 to 24.
 
     size_t actual_osize = outsize;
-    return BrotliEncoderCompress(codec_options->level, windowLog, BROTLI_DEFAULT_MODE, insize, (const uint8_t*)inbuf, &actual_osize, (uint8_t*)outbuf) == 0 ? 0 : actual_osize;
+    if (!codec_options->param_count)
+        return BrotliEncoderCompress(codec_options->level, windowLog, BROTLI_DEFAULT_MODE, insize, (const uint8_t*)inbuf, &actual_osize, (uint8_t*)outbuf) == 0 ? 0 : actual_osize;
+
+    // -ebrotli,level:key=value parameters require an encoder instance
+    static const char* const modes[] = { "generic", "text", "font", NULL };
+    static const struct { const char* key; BrotliEncoderParameter param; } keys[] = {
+        { "wlog", BROTLI_PARAM_LGWIN }, { "lgblock", BROTLI_PARAM_LGBLOCK }, { "large", BROTLI_PARAM_LARGE_WINDOW },
+        { "npostfix", BROTLI_PARAM_NPOSTFIX }, { "ndirect", BROTLI_PARAM_NDIRECT }, { "no_literal_ctx", BROTLI_PARAM_DISABLE_LITERAL_CONTEXT_MODELING },
+    };
+    int64_t mode = lzbench_param_enum(codec_options, "mode", modes, BROTLI_DEFAULT_MODE);
+    if (mode < 0) return 0;
+
+    BrotliEncoderState* state = BrotliEncoderCreateInstance(NULL, NULL, NULL);
+    if (!state) return 0;
+    bool ok = BrotliEncoderSetParameter(state, BROTLI_PARAM_QUALITY, codec_options->level) &&
+              BrotliEncoderSetParameter(state, BROTLI_PARAM_LGWIN, windowLog) &&
+              BrotliEncoderSetParameter(state, BROTLI_PARAM_MODE, (uint32_t)mode) &&
+              BrotliEncoderSetParameter(state, BROTLI_PARAM_SIZE_HINT, (uint32_t)std::min(insize, (size_t)1 << 30));
+    for (size_t i=0; ok && i<sizeof(keys)/sizeof(keys[0]); i++) {
+        codec_param_t* p = lzbench_param_find(codec_options, keys[i].key);
+        if (p) ok = p->is_int && BrotliEncoderSetParameter(state, keys[i].param, (uint32_t)p->ivalue);
+    }
+
+    size_t available_in = insize, available_out = outsize;
+    const uint8_t* next_in = (const uint8_t*)inbuf;
+    uint8_t* next_out = (uint8_t*)outbuf;
+    if (ok)
+        ok = BrotliEncoderCompressStream(state, BROTLI_OPERATION_FINISH, &available_in, &next_in, &available_out, &next_out, NULL) && BrotliEncoderIsFinished(state);
+    BrotliEncoderDestroyInstance(state);
+    return ok ? (int64_t)(outsize - available_out) : 0;
 }
 int64_t lzbench_brotli_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, codec_options_t *codec_options)
 {
     size_t actual_osize = outsize;
+    if (lzbench_param_int(codec_options, "large", 0)) {
+        BrotliDecoderState* state = BrotliDecoderCreateInstance(NULL, NULL, NULL);
+        if (!state) return 0;
+        BrotliDecoderSetParameter(state, BROTLI_DECODER_PARAM_LARGE_WINDOW, 1);
+        size_t available_in = insize, available_out = outsize;
+        const uint8_t* next_in = (const uint8_t*)inbuf;
+        uint8_t* next_out = (uint8_t*)outbuf;
+        BrotliDecoderResult res = BrotliDecoderDecompressStream(state, &available_in, &next_in, &available_out, &next_out, NULL);
+        BrotliDecoderDestroyInstance(state);
+        return res == BROTLI_DECODER_RESULT_SUCCESS ? (int64_t)(outsize - available_out) : 0;
+    }
     return BrotliDecoderDecompress(insize, (const uint8_t*)inbuf, &actual_osize, (uint8_t*)outbuf) == BROTLI_DECODER_RESULT_ERROR ? 0 : actual_osize;
 }
 
@@ -603,6 +643,18 @@ int64_t lzbench_lzma_compress(char *inbuf, size_t insize, char *outbuf, size_t o
     LzmaEncProps_Init(&props);
     props.level = codec_options->level;
     props.numThreads = 1;
+    if (codec_options->param_count) {
+        int64_t dict = lzbench_param_int(codec_options, "dict", 0); // log2 of the size or the size in bytes
+        if (dict) props.dictSize = (dict <= 31) ? (1U << dict) : (UInt32)dict;
+        props.lc = (int)lzbench_param_int(codec_options, "lc", props.lc);
+        props.lp = (int)lzbench_param_int(codec_options, "lp", props.lp);
+        props.pb = (int)lzbench_param_int(codec_options, "pb", props.pb);
+        props.fb = (int)lzbench_param_int(codec_options, "fb", props.fb);
+        props.mc = (UInt32)lzbench_param_int(codec_options, "mc", props.mc);
+        props.algo = (int)lzbench_param_int(codec_options, "algo", props.algo);
+        props.btMode = (int)lzbench_param_int(codec_options, "bt", props.btMode);
+        props.numHashBytes = (int)lzbench_param_int(codec_options, "hb", props.numHashBytes);
+    }
     LzmaEncProps_Normalize(&props);
   /*
   p->level = 5;
@@ -1193,11 +1245,64 @@ int64_t lzbench_ucl_nrv2e_decompress(char *inbuf, size_t insize, char *outbuf, s
 
 
 
+#if !defined(BENCH_REMOVE_ZLIB) || !defined(BENCH_REMOVE_ZLIB_NG)
+/*
+ * The same loop for zlib and zlib-ng: runs deflate or inflate (step) to the end of the stream.
+ * avail_in and avail_out are 32-bit, larger buffers are passed in pieces as compress2() does.
+ * Returns the output size or 0 on errors; the caller ends the stream.
+ */
+#define ZLIB_RUN_FUNC(name, stream_t, step_t) \
+static int64_t name(stream_t& strm, step_t step, int last_flush, char *inbuf, size_t insize, char *outbuf, size_t outsize) \
+{ \
+    const uint32_t max = (uint32_t)-1; \
+    size_t left_in = insize, left_out = outsize; \
+    int err; \
+    strm.next_in = (uint8_t*)inbuf; \
+    strm.next_out = (uint8_t*)outbuf; \
+    do { \
+        if (strm.avail_in == 0) { \
+            strm.avail_in = left_in > max ? max : (uint32_t)left_in; \
+            left_in -= strm.avail_in; \
+        } \
+        if (strm.avail_out == 0) { \
+            strm.avail_out = left_out > max ? max : (uint32_t)left_out; \
+            left_out -= strm.avail_out; \
+        } \
+        err = step(&strm, left_in ? Z_NO_FLUSH : last_flush); \
+    } while (err == Z_OK); \
+    return err == Z_STREAM_END ? (int64_t)(outsize - left_out - strm.avail_out) : 0; \
+}
+#endif
+
+
+
 #ifndef BENCH_REMOVE_ZLIB
 #include "zlib/zlib.h"
 
+typedef int (*zlib_step_func)(z_streamp strm, int flush);
+ZLIB_RUN_FUNC(zlib_run, z_stream, zlib_step_func)
+
+static const char* const zlib_strategies[] = { "default", "filtered", "huffman", "rle", "fixed", NULL };
+
+// deflateInit2() path used when -ezlib,level:memlevel=#:wbits=#:strategy=# parameters are given
+static int64_t lzbench_zlib_compress2(char *inbuf, size_t insize, char *outbuf, size_t outsize, codec_options_t *codec_options)
+{
+    z_stream strm = {};
+    int64_t strategy = lzbench_param_enum(codec_options, "strategy", zlib_strategies, Z_DEFAULT_STRATEGY);
+    if (strategy < 0) return 0;
+    if (deflateInit2(&strm, codec_options->level, Z_DEFLATED, (int)lzbench_param_int(codec_options, "wbits", MAX_WBITS),
+                     (int)lzbench_param_int(codec_options, "memlevel", 8), (int)strategy) != Z_OK)
+        return 0;
+    int64_t complen = zlib_run(strm, deflate, Z_FINISH, inbuf, insize, outbuf, outsize);
+    deflateEnd(&strm);
+    return complen;
+}
+
 int64_t lzbench_zlib_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, codec_options_t *codec_options)
 {
+    if (codec_options->param_count)
+        return lzbench_zlib_compress2(inbuf, insize, outbuf, outsize, codec_options);
+
     uLongf zcomplen = insize;
     int err = compress2((uint8_t*)outbuf, &zcomplen, (uint8_t*)inbuf, insize, codec_options->level);
     if (err != Z_OK)
@@ -1207,6 +1312,15 @@ int64_t lzbench_zlib_compress(char *inbuf, size_t insize, char *outbuf, size_t o
 
 int64_t lzbench_zlib_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, codec_options_t *codec_options)
 {
+    if (lzbench_param_find(codec_options, "wbits")) {
+        z_stream strm = {};
+        if (inflateInit2(&strm, (int)lzbench_param_int(codec_options, "wbits", MAX_WBITS)) != Z_OK)
+            return 0;
+        int64_t decomplen = zlib_run(strm, inflate, Z_NO_FLUSH, inbuf, insize, outbuf, outsize);
+        inflateEnd(&strm);
+        return decomplen;
+    }
+
     uLongf zdecomplen = outsize;
     int err = uncompress((uint8_t*)outbuf, &zdecomplen, (uint8_t*)inbuf, insize);
     if (err != Z_OK)
@@ -1225,8 +1339,30 @@ int64_t lzbench_zlib_decompress(char *inbuf, size_t insize, char *outbuf, size_t
 
 #include "zlib-ng/zlib-ng.h"
 
+typedef int32_t (*zlib_ng_step_func)(zng_stream *strm, int32_t flush);
+ZLIB_RUN_FUNC(zlib_ng_run, zng_stream, zlib_ng_step_func)
+
+static const char* const zlib_ng_strategies[] = { "default", "filtered", "huffman", "rle", "fixed", NULL };
+
+// zng_deflateInit2() path used when -ezlib-ng,level:memlevel=#:wbits=#:strategy=# parameters are given
+static int64_t lzbench_zlib_ng_compress2(char *inbuf, size_t insize, char *outbuf, size_t outsize, codec_options_t *codec_options)
+{
+    zng_stream strm = {};
+    int64_t strategy = lzbench_param_enum(codec_options, "strategy", zlib_ng_strategies, Z_DEFAULT_STRATEGY);
+    if (strategy < 0) return 0;
+    if (zng_deflateInit2(&strm, codec_options->level, Z_DEFLATED, (int)lzbench_param_int(codec_options, "wbits", MAX_WBITS),
+                         (int)lzbench_param_int(codec_options, "memlevel", 8), (int)strategy) != Z_OK)
+        return 0;
+    int64_t complen = zlib_ng_run(strm, zng_deflate, Z_FINISH, inbuf, insize, outbuf, outsize);
+    zng_deflateEnd(&strm);
+    return complen;
+}
+
 int64_t lzbench_zlib_ng_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, codec_options_t *codec_options)
 {
+    if (codec_options->param_count)
+        return lzbench_zlib_ng_compress2(inbuf, insize, outbuf, outsize, codec_options);
+
     size_t zcomplen = insize;
     int err = zng_compress2((uint8_t*)outbuf, &zcomplen, (uint8_t*)inbuf, insize, codec_options->level);
     if (err != Z_OK)
@@ -1236,6 +1372,15 @@ int64_t lzbench_zlib_ng_compress(char *inbuf, size_t insize, char *outbuf, size_
 
 int64_t lzbench_zlib_ng_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, codec_options_t *codec_options)
 {
+    if (lzbench_param_find(codec_options, "wbits")) {
+        zng_stream strm = {};
+        if (zng_inflateInit2(&strm, (int)lzbench_param_int(codec_options, "wbits", MAX_WBITS)) != Z_OK)
+            return 0;
+        int64_t decomplen = zlib_ng_run(strm, zng_inflate, Z_NO_FLUSH, inbuf, insize, outbuf, outsize);
+        zng_inflateEnd(&strm);
+        return decomplen;
+    }
+
     size_t zdecomplen = outsize;
     int err = zng_uncompress((uint8_t*)outbuf, &zdecomplen, (uint8_t*)inbuf, insize);
     if (err != Z_OK)
@@ -1492,6 +1637,30 @@ void lzbench_zstd_deinit(char* workmem)
     free(workmem);
 }
 
+static const char* const zstd_strategies[] = { "", "fast", "dfast", "greedy", "lazy", "lazy2", "btlazy2", "btopt", "btultra", "btultra2", NULL };
+
+// applies -ezstd,level:key=value parameters, returns != 0 for an invalid value
+static int lzbench_zstd_set_params(ZSTD_CCtx* cctx, codec_options_t *codec_options)
+{
+    static const struct { const char* key; ZSTD_cParameter param; } keys[] = {
+        { "wlog", ZSTD_c_windowLog }, { "clog", ZSTD_c_chainLog }, { "hlog", ZSTD_c_hashLog }, { "slog", ZSTD_c_searchLog },
+        { "mml", ZSTD_c_minMatch }, { "tlen", ZSTD_c_targetLength }, { "ldm", ZSTD_c_enableLongDistanceMatching },
+        { "ldmhlog", ZSTD_c_ldmHashLog }, { "ldmmml", ZSTD_c_ldmMinMatch }, { "ldmblog", ZSTD_c_ldmBucketSizeLog },
+        { "ldmhrlog", ZSTD_c_ldmHashRateLog }, { "checksum", ZSTD_c_checksumFlag }, { "lit", ZSTD_c_literalCompressionMode },
+    };
+
+    for (size_t i=0; i<sizeof(keys)/sizeof(keys[0]); i++) {
+        codec_param_t* p = lzbench_param_find(codec_options, keys[i].key);
+        if (p && (!p->is_int || ZSTD_isError(ZSTD_CCtx_setParameter(cctx, keys[i].param, (int)p->ivalue))))
+            return -1;
+    }
+
+    int64_t strategy = lzbench_param_enum(codec_options, "strategy", zstd_strategies, 0);
+    if (strategy < 0 || (strategy && ZSTD_isError(ZSTD_CCtx_setParameter(cctx, ZSTD_c_strategy, (int)strategy))))
+        return -1;
+    return 0;
+}
+
 int64_t lzbench_zstd_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, codec_options_t *codec_options)
 {
     size_t res;
@@ -1514,6 +1683,9 @@ int64_t lzbench_zstd_compress(char *inbuf, size_t insize, char *outbuf, size_t o
         }
     }
 
+    if (codec_options->param_count && lzbench_zstd_set_params(zstd_params->cctx, codec_options) != 0)
+        return 0;
+
     res = ZSTD_compress2(zstd_params->cctx, outbuf, outsize, inbuf, insize);
 #else
     if (!zstd_params->cdict) return 0;
@@ -1529,6 +1701,10 @@ int64_t lzbench_zstd_decompress(char *inbuf, size_t insize, char *outbuf, size_t
     zstd_params_s* zstd_params = (zstd_params_s*) codec_options->work_mem;
     if (!zstd_params || !zstd_params->dctx) return 0;
 
+    int64_t windowLog = lzbench_param_int(codec_options, "wlog", 0);
+    if (windowLog > ZSTD_WINDOWLOG_LIMIT_DEFAULT)
+        ZSTD_DCtx_setParameter(zstd_params->dctx, ZSTD_d_windowLogMax, (int)windowLog);
+
     return ZSTD_decompressDCtx(zstd_params->dctx, outbuf, outsize, inbuf, insize);
 }
 
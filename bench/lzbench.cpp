@@ -18,6 +18,9 @@
 #include <string.h>
 
 
+int g_exit_result = 0;
+
+
 int istrcmp(const char *str1, const char *str2)
 {
     int c1, c2;
@@ -61,15 +64,106 @@ std::vector<std::string> split(const std::string &text, char sep)
 }
 
 
+#ifndef LZBENCH_BUILD_FLAGS
+    #define LZBENCH_BUILD_FLAGS ""
+#endif
+
+const char* lzbench_compiler()
+{
+#if defined(_MSC_VER)
+    static char name[32];
+    snprintf(name, sizeof(name), "MSVC %d", _MSC_VER);
+    return name;
+#elif defined(__GNUC__) && !defined(__clang__)
+    return "gcc " __VERSION__;
+#elif defined(__VERSION__)
+    return __VERSION__;
+#else
+    return "unknown compiler";
+#endif
+}
+
+
+const char* lzbench_build_flags()
+{
+    return LZBENCH_BUILD_FLAGS;
+}
+
+
+std::string json_string(const std::string& text)
+{
+    std::string out = "\"";
+    char buf[8];
+    for (size_t i=0; i<text.size(); i++)
+    {
+        unsigned char c = text[i];
+        if (c == '"' || c == '\\') { out += '\\'; out += c; }
+        else if (c < 0x20) { snprintf(buf, sizeof(buf), "\\u%04x", c); out += buf; }
+        else out += c;
+    }
+    return out + "\"";
+}
+
+
+static void print_json_samples(const char* name, const std::vector<uint64_t>& samples)
+{
+    printf(",\"%s\":[", name);
+    for (size_t i=0; i<samples.size(); i++)
+        printf("%s%llu", i ? "," : "", (unsigned long long)samples[i]);
+    printf("]");
+}
+
+
+// -o7: the first line describes the run, then every result is a JSON object in a single line
+static void print_json_meta(lzbench_params_t *params)
+{
+    static const char* timetypes[] = { "", "fastest", "average", "median" };
+    printf("{\"type\":\"meta\",\"version\":%s,\"os\":%s,\"bits\":%d,\"cpu\":%s,\"compiler\":%s,\"flags\":%s",
+           json_string(PROGVERSION).c_str(), json_string(PROGOS).c_str(), (int)(8 * sizeof(uint8_t*)),
+           json_string(params->cpu_brand ? params->cpu_brand : "").c_str(), json_string(lzbench_compiler()).c_str(), json_string(lzbench_build_flags()).c_str());
+    printf(",\"priority\":\"%s\",\"timetype\":\"%s\",\"chunk_size\":%llu,\"c_iters\":%u,\"d_iters\":%u,\"cmintime_ms\":%u,\"dmintime_ms\":%u,\"compress_only\":%s}\n",
+           params->real_time ? "realtime" : "normal", timetypes[params->timetype >= FASTEST && params->timetype <= MEDIAN ? params->timetype : 0],
+           (unsigned long long)params->chunk_size, params->c_iters, params->d_iters, params->cmintime, params->dmintime, params->compress_only ? "true" : "false");
+}
+
+
+static void print_json_row(string_table_t& row)
+{
+    printf("{\"type\":\"result\",\"name\":%s,\"codec\":%s,\"name_version\":%s,\"level\":%d,\"params\":{",
+           json_string(row.col1_algname).c_str(), json_string(row.codec).c_str(), json_string(row.name_version).c_str(), row.level);
+    std::vector<std::string> kv = split(row.codec_params, ':');
+    for (size_t i=0, n=0; i<kv.size(); i++)
+    {
+        size_t eq = kv[i].find('=');
+        if (eq == std::string::npos) continue;
+        printf("%s%s:%s", n++ ? "," : "", json_string(kv[i].substr(0, eq)).c_str(), json_string(kv[i].substr(eq+1)).c_str());
+    }
+    printf("},\"file\":%s,\"orig_size\":%llu,\"compr_size\":%llu,\"ctime_ns\":%llu,\"dtime_ns\":%llu",
+           json_string(row.col6_filename).c_str(), (unsigned long long)row.col5_origsize, (unsigned long long)row.col4_comprsize,
+           (unsigned long long)row.col2_ctime, (unsigned long long)row.col3_dtime);
+    printf(",\"error\":%s,\"chunk_size\":%llu,\"chunks\":[", row.error ? "true" : "false", (unsigned long long)row.chunk_size);
+    for (size_t i=0; i<row.chunks.size(); i++)
+        printf("%s[%llu,%llu]", i ? "," : "", (unsigned long long)row.chunks[i].first, (unsigned long long)row.chunks[i].second);
+    printf("]");
+    if (row.sub_block) printf(",\"sub_block\":%llu", (unsigned long long)row.sub_block);
+    if (!row.data_class.empty()) printf(",\"class\":%s", json_string(row.data_class).c_str());
+    print_json_samples("csamples_ns", row.csamples);
+    print_json_samples("dsamples_ns", row.dsamples);
+    print_json_samples("cloops_ns", row.cloops);
+    print_json_samples("dloops_ns", row.dloops);
+    printf("}\n");
+}
+
+
 void print_header(lzbench_params_t *params)
 {
     switch (params->textformat)
     {
         case CSV:
             if (params->show_speed)
-                printf("Compressor name,Compression speed,Decompression speed,Original size,Compressed size,Ratio,Filename\n");
+                printf("Compressor name,Compression speed,Decompression speed,Original size,Compressed size,Ratio,Filename,Sub-block size\n");
             else
-                printf("Compressor name,Compression time in us,Decompression time in us,Original size,Compressed size,Ratio,Filename\n"); break;
+                printf("Compressor name,Compression time in us,Decompression time in us,Original size,Compressed size,Ratio,Filename,Sub-block size\n"); break;
             break;
         case TURBOBENCH:
             printf("  Compressed  Ratio   Cspeed   Dspeed         Compressor name Filename\n"); break;
@@ -85,6 +179,10 @@ void print_header(lzbench_params_t *params)
             printf("| Compressor name         | Ratio | Compression| Decompress.|\n");
             printf("| ---------------         | ------| -----------| ---------- |\n");
             break;
+        case NDJSON:
+            print_json_meta(params); break;
+        case HTML:
+            break; // the whole report is written by lzbench_html_report() at the end
     }
 }
 
@@ -98,8 +196,14 @@ void print_speed(lzbench_params_t *params, string_table_t& row)
 
     switch (params->textformat)
     {
+        case NDJSON:
+            print_json_row(row); break;
+        case HTML:
+            break;
         case CSV:
-            printf("%s,%.2f,%.2f,%llu,%llu,%.2f,%s\n", row.col1_algname.c_str(), cspeed, dspeed, (unsigned long long)row.col5_origsize, (unsigned long long)row.col4_comprsize, ratio, row.col6_filename.c_str()); break;
+            printf("%s,%.2f,%.2f,%llu,%llu,%.2f,%s,", row.col1_algname.c_str(), cspeed, dspeed, (unsigned long long)row.col5_origsize, (unsigned long long)row.col4_comprsize, ratio, row.col6_filename.c_str());
+            if (row.sub_block) printf("%llu", (unsigned long long)row.sub_block);
+            printf("\n"); break;
         case TURBOBENCH:
             printf("%12llu %6.1f%9.2f%9.2f  %22s %s\n", (unsigned long long)row.col4_comprsize, ratio, cspeed, dspeed, row.col1_algname.c_str(), row.col6_filename.c_str()); break;
         case TEXT:
@@ -109,6 +213,8 @@ void print_speed(lzbench_params_t *params, string_table_t& row)
                 if (cspeed < 10) printf("%6.2f MB/s", cspeed);
                 else if (cspeed < 100) printf("%6.1f MB/s", cspeed);
                 else printf("%6d MB/s", (int)cspeed);
+            } else if (params->decode_only) {
+                printf("          -");
             } else {
                 printf("      ERROR");
             }
@@ -130,6 +236,8 @@ void print_speed(lzbench_params_t *params, string_table_t& row)
                 if (cspeed < 10) printf("|%6.2f MB/s ", cspeed);
                 else if (cspeed < 100) printf("|%6.1f MB/s ", cspeed);
                 else printf("|%6d MB/s ", (int)cspeed);
+            } else if (params->decode_only) {
+                printf("|          - ");
             } else {
                 printf("|      ERROR ");
             }
@@ -149,6 +257,8 @@ void print_speed(lzbench_params_t *params, string_table_t& row)
                 if (cspeed < 10) printf("|%6.2f MB/s ", cspeed);
                 else if (cspeed < 100) printf("|%6.1f MB/s ", cspeed);
                 else printf("|%6d MB/s ", (int)cspeed);
+            } else if (params->decode_only) {
+                printf("|          - ");
             } else {
                 printf("|      ERROR ");
             }
@@ -173,8 +283,14 @@ void print_time(lzbench_params_t *params, string_table_t& row)
 
     switch (params->textformat)
     {
+        case NDJSON:
+            print_json_row(row); break;
+        case HTML:
+            break;
         case CSV:
-            printf("%s,%llu,%llu,%llu,%llu,%.2f,%s\n", row.col1_algname.c_str(), (unsigned long long)ctime, (unsigned long long)dtime,  (unsigned long long) row.col5_origsize, (unsigned long long)row.col4_comprsize, ratio, row.col6_filename.c_str()); break;
+            printf("%s,%llu,%llu,%llu,%llu,%.2f,%s,", row.col1_algname.c_str(), (unsigned long long)ctime, (unsigned long long)dtime,  (unsigned long long) row.col5_origsize, (unsigned long long)row.col4_comprsize, ratio, row.col6_filename.c_str());
+            if (row.sub_block) printf("%llu", (unsigned long long)row.sub_block);
+            printf("\n"); break;
         case TURBOBENCH:
             printf("%12llu %6.1f%9llu%9llu  %22s %s\n", (unsigned long long)row.col4_comprsize, ratio, (unsigned long long)ctime, (unsigned long long)dtime, row.col1_algname.c_str(), row.col6_filename.c_str()); break;
         case TEXT:
@@ -204,9 +320,49 @@ void print_time(lzbench_params_t *params, string_table_t& row)
 }
 
 
-void print_stats(lzbench_params_t *params, const compressor_desc_t* desc, int level, std::vector<uint64_t> &ctime, std::vector<uint64_t> &dtime, size_t insize, size_t outsize, bool comp_error, bool decomp_error)
+// suffix of result names when -b is given a list of chunk sizes
+std::string format_chunk_size(uint64_t chunk_size)
+{
+    std::string s;
+    if (chunk_size % (1 << 20) == 0)
+        format(s, " b=%lluMB", (unsigned long long)(chunk_size >> 20));
+    else if (chunk_size % (1 << 10) == 0)
+        format(s, " b=%lluKB", (unsigned long long)(chunk_size >> 10));
+    else
+        format(s, " b=%llu", (unsigned long long)chunk_size);
+    return s;
+}
+
+
+// MB/s (10^6 bytes per second), 0 when nothing was measured
+double lzbench_speed(uint64_t size, uint64_t nanosec)
 {
-    std::string col1_algname;
+    return nanosec ? size * 1000.0 / nanosec : 0;
+}
+
+
+// the times -p statistics are computed from: every iteration of at least 10 us and the mean of every loop
+static void timing_samples(const std::vector<uint64_t> &iters, const std::vector<uint64_t> &loops, std::vector<uint64_t> &samples)
+{
+    for (size_t i=0; i<iters.size(); i++)
+        if (iters[i] >= 10000) samples.push_back(iters[i]);
+    samples.insert(samples.end(), loops.begin(), loops.end());
+}
+
+
+void print_stats(lzbench_params_t *params, const compressor_desc_t* desc, int level, const codec_kv_t& kv, size_t chunk_size, std::vector<size_t> &chunk_sizes, std::vector<uint64_t> &citers, std::vector<uint64_t> &diters, std::vector<uint64_t> &cloops, std::vector<uint64_t> &dloops, size_t insize, size_t outsize, bool comp_error, bool decomp_error, bool cached)
+{
+    std::string col1_algname, codec_params;
+    std::vector<uint64_t> ctime, dtime;
+    for (size_t i=0; i<kv.size(); i++)
+        codec_params += (i ? ":" : "") + kv[i].first + "=" + kv[i].second;
+    if (params->store_active)
+        codec_params += std::string(codec_params.empty() ? "" : ":") + "store=" + (params->store_fallback == STORE_LZ4 ? "lz4" : "entropy");
+    if (params->db_file && !cached && !params->silent && !params->decode_only && !params->store_active && !comp_error && !decomp_error)
+        lzbench_db_record(params, desc->name_version, level, codec_params, chunk_size, insize, outsize, citers, diters, cloops, dloops);
+    timing_samples(citers, cloops, ctime);
+    timing_samples(diters, dloops, dtime);
+
     std::sort(ctime.begin(), ctime.end());
     std::sort(dtime.begin(), dtime.end());
     uint64_t best_ctime, best_dtime;
@@ -232,17 +388,43 @@ void print_stats(lzbench_params_t *params, const compressor_desc_t* desc, int le
         format(col1_algname, "%s", desc->name_version);
     else
         format(col1_algname, "%s -%d", desc->name_version, level);
+    for (size_t i=0; i<kv.size(); i++)
+        col1_algname += " " + kv[i].first + "=" + kv[i].second;
+    if (params->chunk_sweep.size() > 1)
+        col1_algname += format_chunk_size(chunk_size);
+    if (params->sub_block)
+        col1_algname += " split" + format_chunk_size(params->sub_block).substr(2);
+    if (params->store_active)
+        col1_algname += " +store";
 
     LZBENCH_PRINT(9, "ALL best_ctime=%lu best_dtime=%lu\n", (comp_error)?0:best_ctime, (decomp_error)?0:best_dtime);
     params->results.push_back(string_table_t(col1_algname, (comp_error)?0:best_ctime, (decomp_error)?0:best_dtime, outsize, insize, params->in_filename));
-    if (params->show_speed)
-        print_speed(params, params->results[params->results.size()-1]);
-    else
-        print_time(params, params->results[params->results.size()-1]);
+    string_table_t& row = params->results.back();
+    row.codec = desc->name;
+    row.level = level;
+    row.codec_params = codec_params;
+    row.name_version = desc->name_version;
+    row.chunk_size = chunk_size;
+    row.sub_block = params->sub_block;
+    if (params->in_class) row.data_class = params->in_class;
+    for (size_t i=0; i<chunk_sizes.size(); i++)
+    {
+        if (row.chunks.empty() || row.chunks.back().first != chunk_sizes[i])
+            row.chunks.push_back(std::make_pair((uint64_t)chunk_sizes[i], (uint64_t)0));
+        row.chunks.back().second++;
+    }
+    row.error = comp_error || decomp_error;
+    if (!comp_error) { row.csamples = citers; row.cloops = cloops; }
+    if (!decomp_error) { row.dsamples = diters; row.dloops = dloops; }
+    if (!params->silent)
+    {
+        if (params->show_speed)
+            print_speed(params, params->results[params->results.size()-1]);
+        else
+            print_time(params, params->results[params->results.size()-1]);
+    }
 
     fflush(stdout);
-    ctime.clear();
-    dtime.clear();
 }
 
 
@@ -276,17 +458,24 @@ inline int64_t lzbench_compress(lzbench_params_t *params, std::vector<size_t>& c
     int64_t clen;
     size_t outpart, part, sum = 0;
     uint8_t *start = inbuf;
-    int cscount = chunk_sizes.size();
+    size_t cscount = chunk_sizes.size();
 
     compr_sizes.resize(cscount);
+    if (params->store_active) params->stored_chunks.resize(cscount);
 
-    for (int i=0; i<cscount; i++)
+    for (size_t i=0; i<cscount; i++)
     {
         part = chunk_sizes[i];
         outpart = GET_COMPRESS_BOUND(part);
         if (outpart > outsize) outpart = outsize;
 
-        clen = compress((char*)inbuf, part, (char*)outbuf, outpart, codec_options);
+        if (params->store_active && (params->stored_chunks[i] = lzbench_store_detect(params, inbuf, part)))
+        {
+            memcpy(outbuf, inbuf, part);
+            clen = part;
+        }
+        else
+            clen = compress((char*)inbuf, part, (char*)outbuf, outpart, codec_options);
 
         if (clen <= 0)
         {
@@ -311,9 +500,9 @@ inline int64_t lzbench_decompress(lzbench_params_t *params, std::vector<size_t>&
     int64_t dlen;
     size_t part, sum = 0;
     uint8_t *outstart = outbuf;
-    int cscount = compr_sizes.size();
+    size_t cscount = compr_sizes.size();
 
-    for (int i=0; i<cscount; i++)
+    for (size_t i=0; i<cscount; i++)
     {
         part = compr_sizes[i];
 
@@ -324,7 +513,13 @@ inline int64_t lzbench_decompress(lzbench_params_t *params, std::vector<size_t>&
         }
 #endif
 
-        dlen = decompress((char*)inbuf, part, (char*)outbuf, chunk_sizes[i], codec_options);
+        if (params->store_active && params->stored_chunks[i])
+        {
+            memcpy(outbuf, inbuf, part);
+            dlen = part;
+        }
+        else
+            dlen = decompress((char*)inbuf, part, (char*)outbuf, chunk_sizes[i], codec_options);
 
         if (dlen <= 0) {
             LZBENCH_PRINT(9, "DEC part=%lu dlen=%ld out=%lu\n", (uint64_t)part, dlen, (uint64_t)(outbuf - outstart));
@@ -341,14 +536,31 @@ inline int64_t lzbench_decompress(lzbench_params_t *params, std::vector<size_t>&
 }
 
 
-void lzbench_process_single_codec(lzbench_params_t *params, size_t max_chunk_size, std::vector<size_t> &chunk_sizes, const compressor_desc_t* desc, int level, uint8_t *inbuf, size_t insize, uint8_t *compbuf, size_t comprsize, uint8_t *decomp, bench_rate_t rate, int param1)
+/*
+ * Splits "key=value:key=value" into kv. A key without a value is stored as key=1.
+ */
+void parse_codec_params(const std::vector<std::string>& parts, size_t first, codec_kv_t& kv)
+{
+    for (size_t i=first; i<parts.size(); i++)
+    {
+        if (parts[i].empty()) continue;
+        size_t eq = parts[i].find('=');
+        if (eq == std::string::npos)
+            kv.push_back(std::make_pair(parts[i], std::string("1")));
+        else
+            kv.push_back(std::make_pair(parts[i].substr(0, eq), parts[i].substr(eq + 1)));
+    }
+}
+
+
+void lzbench_process_single_codec(lzbench_params_t *params, size_t max_chunk_size, std::vector<size_t> &chunk_sizes, const compressor_desc_t* desc, int level, const codec_kv_t& kv, uint8_t *inbuf, size_t insize, uint8_t *compbuf, size_t comprsize, uint8_t *decomp, bench_rate_t rate, int param1)
 {
     float speed;
     int i, total_c_iters, total_d_iters;
     bench_timer_t loop_ticks, start_ticks, end_ticks, timer_ticks;
     int64_t complen=0, decomplen;
     uint64_t nanosec, total_nanosec;
-    std::vector<uint64_t> ctime, dtime;
+    std::vector<uint64_t> citers, diters, cloops, dloops;
     std::vector<size_t> compr_sizes;
     bool comp_error = false, decomp_error = false;
     char* workmem = NULL;
@@ -357,9 +569,64 @@ void lzbench_process_single_codec(lzbench_params_t *params, size_t max_chunk_siz
     LZBENCH_PRINT(5, "*** trying %s insize=%lu comprsize=%lu chunk_size=%lu\n", desc->name, (uint64_t)insize, (uint64_t)comprsize, (uint64_t)max_chunk_size);
 
     if (!desc->compress || !desc->decompress) return;
-    if (desc->init) workmem = desc->init(max_chunk_size, param1, param2);
+    if (desc->max_insize && max_chunk_size > desc->max_insize && !params->sub_block)
+    {
+        // codecs with 32-bit lengths compress every chunk as sub-blocks of at most max_insize bytes
+        std::vector<size_t> sub_sizes;
+        size_t sub_bound = 0, limit = (size_t)desc->max_insize;
+        for (size_t k=0; k<chunk_sizes.size(); k++)
+            for (size_t left = chunk_sizes[k]; left > 0; left -= MIN(left, limit))
+            {
+                sub_sizes.push_back(MIN(left, limit));
+                sub_bound += GET_COMPRESS_BOUND(sub_sizes.back());
+            }
+
+        uint8_t* sub_compbuf = compbuf;
+        if (sub_bound > comprsize)
+        {
+            sub_compbuf = (uint8_t*)alloc_and_touch(sub_bound + lzbench_max_padding(), false);
+            if (!sub_compbuf)
+            {
+                printf("Not enough memory, please use -m option!\n");
+                g_exit_result=3;
+                return;
+            }
+        }
+        // the row keeps the requested chunk size and is marked with the sub-block size
+        params->sub_block = limit;
+        lzbench_process_single_codec(params, max_chunk_size, sub_sizes, desc, level, kv, inbuf, insize, sub_compbuf, MAX(sub_bound, comprsize), decomp, rate, param1);
+        params->sub_block = 0;
+        if (sub_compbuf != compbuf) free(sub_compbuf);
+        return;
+    }
+    if (params->db_file && !params->db_merge && !params->silent && !params->profile && !params->page_size && !params->store_active)
+    {
+        std::string codec_params;
+        uint64_t cached_size;
+        for (size_t k=0; k<kv.size(); k++)
+            codec_params += (k ? ":" : "") + kv[k].first + "=" + kv[k].second;
+        if (lzbench_db_lookup(params, desc->name_version, level, codec_params, max_chunk_size, cached_size, citers, diters, cloops, dloops))
+        {
+            LZBENCH_PRINT(4, "%s: using results from %s\n", desc->name_version, params->db_file);
+            print_stats(params, desc, level, kv, max_chunk_size, chunk_sizes, citers, diters, cloops, dloops, insize, cached_size, false, false, true);
+            return;
+        }
+    }
+
+    if (desc->init) workmem = desc->init(params->sub_block ? params->sub_block : max_chunk_size, param1, param2);
+
+    std::vector<codec_param_t> cparams(kv.size());
+    for (size_t k=0; k<kv.size(); k++)
+    {
+        char* end;
+        cparams[k].key = kv[k].first.c_str();
+        cparams[k].value = kv[k].second.c_str();
+        cparams[k].ivalue = strtoll(cparams[k].value, &end, 10);
+        cparams[k].is_int = (*cparams[k].value != 0 && *end == 0);
+        cparams[k].used = 0;
+    }
 
-    codec_options_t codec_options { param1, param2, workmem };
+    codec_options_t codec_options { param1, param2, workmem, (int)cparams.size(), cparams.empty() ? NULL : &cparams[0] };
 
     if (params->cspeed > 0)
     {
@@ -397,13 +664,13 @@ void lzbench_process_single_codec(lzbench_params_t *params, size_t max_chunk_siz
 
             GetTime(end_ticks);
             nanosec = GetDiffTime(rate, start_ticks, end_ticks);
-            if (nanosec >= 10000) ctime.push_back(nanosec);
+            citers.push_back(nanosec);
             i++;
         }
         while (GetDiffTime(rate, loop_ticks, end_ticks) < params->cloop_time);
 
         nanosec = GetDiffTime(rate, loop_ticks, end_ticks);
-        ctime.push_back(nanosec/i);
+        cloops.push_back(nanosec/i);
         speed = (float)insize*i*1000/nanosec;
 
         if ((uint32_t)speed < params->cspeed) { LZBENCH_PRINT(7, "%s slower than %lu MB/s\n", desc->name, (uint64_t)speed); return; }
@@ -431,13 +698,13 @@ void lzbench_process_single_codec(lzbench_params_t *params, size_t max_chunk_siz
             decomplen = lzbench_decompress(params, chunk_sizes, desc->decompress, compr_sizes, compbuf, decomp, &codec_options);
             GetTime(end_ticks);
             nanosec = GetDiffTime(rate, start_ticks, end_ticks);
-            if (nanosec >= 10000) dtime.push_back(nanosec);
+            diters.push_back(nanosec);
             i++;
         }
         while (GetDiffTime(rate, loop_ticks, end_ticks) < params->dloop_time);
 
         nanosec = GetDiffTime(rate, loop_ticks, end_ticks);
-        dtime.push_back(nanosec/i);
+        dloops.push_back(nanosec/i);
 
         if (insize != decomplen)
         {
@@ -482,21 +749,31 @@ void lzbench_process_single_codec(lzbench_params_t *params, size_t max_chunk_siz
     while (true);
 
 stats:
-    print_stats(params, desc, level, ctime, dtime, insize, complen, comp_error, decomp_error);
+    for (size_t k=0; k<cparams.size(); k++)
+        if (!cparams[k].used)
+            fprintf(stderr, "warning: %s ignores parameter %s=%s\n", desc->name, cparams[k].key, cparams[k].value);
+    print_stats(params, desc, level, kv, max_chunk_size, chunk_sizes, citers, diters, cloops, dloops, insize, complen, comp_error, decomp_error, false);
+    if (params->profile && !params->silent && !params->store_active && !comp_error && !decomp_error)
+        lzbench_profile_chunks(params, params->results.back(), desc, &codec_options, chunk_sizes, inbuf, compbuf, decomp, rate);
+    if (params->page_size && !params->silent && !params->store_active && !comp_error && !decomp_error)
+        lzbench_page_measure(params, params->results.back(), desc, &codec_options, chunk_sizes, inbuf, compbuf, decomp, rate);
+    if (!params->solid_files.empty() && !params->silent && !params->store_active && !comp_error && !decomp_error)
+        lzbench_solid_buckets(params, params->results.back(), desc, &codec_options, inbuf);
 
 done:
     if (desc->deinit) desc->deinit(workmem);
 }
 
 
-void lzbench_process_codec_list(lzbench_params_t *params, size_t max_chunk_size, std::vector<size_t> &chunk_sizes, const char *namesWithParams, uint8_t *inbuf, size_t insize, uint8_t *compbuf, size_t comprsize, uint8_t *decomp, bench_rate_t rate)
+/*
+ * Expands a -e list (aliases, levels and key=value parameters) into single codec runs.
+ */
+void lzbench_expand_codec_list(lzbench_params_t *params, const char *namesWithParams, std::vector<codec_candidate_t>& out)
 {
     std::vector<std::string> cnames, cparams;
 
     if (!namesWithParams) return;
 
-    LZBENCH_PRINT(5, "*** lzbench_process_codec_list insize=%lu comprsize=%lu\n", (uint64_t)insize, (uint64_t)comprsize);
-
     cnames = split(namesWithParams, '/');
 
     for (int k=0; k<cnames.size(); k++)
@@ -508,7 +785,7 @@ void lzbench_process_codec_list(lzbench_params_t *params, size_t max_chunk_size,
         {
             if (istrcmp(cnames[k].c_str(), alias_desc[i].name)==0)
             {
-                lzbench_process_codec_list(params, max_chunk_size, chunk_sizes, alias_desc[i].params, inbuf, insize, compbuf, comprsize, decomp, rate);
+                lzbench_expand_codec_list(params, alias_desc[i].params, out);
                 goto next_k;
             }
         }
@@ -517,23 +794,28 @@ void lzbench_process_codec_list(lzbench_params_t *params, size_t max_chunk_size,
         cparams = split(cnames[k].c_str(), ',');
         if (cparams.size() >= 1)
         {
+            // parameters after the name apply to all levels: -ezstd:wlog=24,1,3 or -ezstd,1:wlog=24,3:wlog=27
+            std::vector<std::string> name_parts = split(cparams[0], ':');
+            codec_kv_t name_kv;
+            parse_codec_params(name_parts, 1, name_kv);
+
             int j=1;
             do {
-                bool found = false;
-                for (int i=0; i<LZBENCH_COMPRESSOR_COUNT; i++)
+                const compressor_desc_t* desc = lzbench_find_codec(name_parts[0].c_str());
+                bool found = (desc != NULL);
+                if (found)
                 {
-                    if (istrcmp(comp_desc[i].name, cparams[0].c_str()) == 0)
+                    if (j >= cparams.size())
                     {
-                        found = true;
-                       // printf("%s %s %s\n", cparams[0].c_str(), comp_desc[i].version, cparams[j].c_str());
-                        if (j >= cparams.size())
-                        {
-                            for (int level=comp_desc[i].first_level; level<=comp_desc[i].last_level; level++)
-                                lzbench_process_single_codec(params, max_chunk_size, chunk_sizes, &comp_desc[i], level, inbuf, insize, compbuf, comprsize, decomp, rate, level);
-                        }
-                        else
-                            lzbench_process_single_codec(params, max_chunk_size, chunk_sizes, &comp_desc[i], atoi(cparams[j].c_str()), inbuf, insize, compbuf, comprsize, decomp, rate, atoi(cparams[j].c_str()));
-                        break;
+                        for (int level=desc->first_level; level<=desc->last_level; level++)
+                            out.push_back(codec_candidate_t(desc, level, name_kv));
+                    }
+                    else
+                    {
+                        std::vector<std::string> level_parts = split(cparams[j], ':');
+                        codec_kv_t kv = name_kv;
+                        parse_codec_params(level_parts, 1, kv);
+                        out.push_back(codec_candidate_t(desc, atoi(level_parts[0].c_str()), kv));
                     }
                 }
                 if (!found) printf("NOT FOUND: %s %s\n", cparams[0].c_str(), (j<cparams.size()) ? cparams[j].c_str() : NULL);
@@ -544,18 +826,38 @@ void lzbench_process_codec_list(lzbench_params_t *params, size_t max_chunk_size,
 next_k:
         continue;
     }
+}
 
+
+void lzbench_process_codec_list(lzbench_params_t *params, size_t max_chunk_size, std::vector<size_t> &chunk_sizes, const char *namesWithParams, uint8_t *inbuf, size_t insize, uint8_t *compbuf, size_t comprsize, uint8_t *decomp, bench_rate_t rate)
+{
+    std::vector<codec_candidate_t> candidates;
+
+    LZBENCH_PRINT(5, "*** lzbench_process_codec_list insize=%lu comprsize=%lu\n", (uint64_t)insize, (uint64_t)comprsize);
+
+    lzbench_expand_codec_list(params, namesWithParams, candidates);
+
+    for (size_t i=0; i<candidates.size(); i++)
+    {
+        lzbench_process_single_codec(params, max_chunk_size, chunk_sizes, candidates[i].desc, candidates[i].level, candidates[i].kv, inbuf, insize, compbuf, comprsize, decomp, rate, candidates[i].level);
+        if (params->store_fallback && !params->silent)
+        {
+            params->store_active = 1;
+            lzbench_process_single_codec(params, max_chunk_size, chunk_sizes, candidates[i].desc, candidates[i].level, candidates[i].kv, inbuf, insize, compbuf, comprsize, decomp, rate, candidates[i].level);
+            params->store_active = 0;
+        }
+    }
 }
 
 
-void lzbench_process_mem_blocks(lzbench_params_t *params, std::vector<size_t> &file_sizes, const char *namesWithParams, uint8_t *inbuf, size_t insize, bench_rate_t rate)
+static void process_mem_chunks(lzbench_params_t *params, std::vector<size_t> &file_sizes, const char *namesWithParams, uint8_t *inbuf, size_t insize, bench_rate_t rate)
 {
     uint8_t *compbuf, *decomp;
     size_t comprsize;
     std::vector<size_t> chunk_sizes;
     size_t chunk_size = (params->chunk_size > insize) ? insize : params->chunk_size;
 
-    for (int i=0; i<file_sizes.size(); i++) {
+    for (size_t i=0; i<file_sizes.size(); i++) {
         size_t tmpsize = file_sizes[i];
         while (tmpsize > 0)
         {
@@ -565,8 +867,8 @@ void lzbench_process_mem_blocks(lzbench_params_t *params, std::vector<size_t> &f
     }
 
     comprsize = GET_COMPRESS_BOUND(insize) + chunk_sizes.size() * PAD_SIZE;
-    compbuf = (uint8_t*)alloc_and_touch(comprsize, false);
-    decomp = (uint8_t*)alloc_and_touch(insize + PAD_SIZE, true);
+    compbuf = (uint8_t*)alloc_and_touch(comprsize + lzbench_max_padding(), false);
+    decomp = (uint8_t*)alloc_and_touch(insize + lzbench_max_padding(), true);
 
     if (!compbuf || !decomp)
     {
@@ -577,13 +879,73 @@ void lzbench_process_mem_blocks(lzbench_params_t *params, std::vector<size_t> &f
 
     LZBENCH_PRINT(5, "file_sizes=%d chunk_sizes=%d\n", (int)file_sizes.size(), (int)chunk_sizes.size());
 
-    lzbench_process_codec_list(params, chunk_size, chunk_sizes, namesWithParams, inbuf, insize, compbuf, comprsize, decomp, rate);
+    if (params->db_file)
+        params->in_hash = lzbench_db_hash(inbuf, insize, file_sizes);
+
+    if (params->store_fallback && !params->silent)
+        lzbench_store_measure(params, chunk_size, chunk_sizes, inbuf, rate);
+
+    if (params->search_time)
+        lzbench_search(params, chunk_sizes, namesWithParams, inbuf, insize, compbuf, comprsize, decomp, rate);
+    else
+        lzbench_process_codec_list(params, chunk_size, chunk_sizes, namesWithParams, inbuf, insize, compbuf, comprsize, decomp, rate);
 
     free(compbuf);
     free(decomp);
 }
 
 
+// -b with a list: the same input is benchmarked with every chunk size
+static void process_chunk_sweep(lzbench_params_t *params, std::vector<size_t> &file_sizes, const char *namesWithParams, uint8_t *inbuf, size_t insize, bench_rate_t rate)
+{
+    if (params->chunk_sweep.size() <= 1)
+    {
+        process_mem_chunks(params, file_sizes, namesWithParams, inbuf, insize, rate);
+        return;
+    }
+
+    size_t saved_chunk_size = params->chunk_size, last = 0;
+    for (size_t i=0; i<params->chunk_sweep.size(); i++)
+    {
+        size_t size = MIN(params->chunk_sweep[i], insize);
+        if (size == last) continue; // chunks larger than the input give the same result
+        last = size;
+        params->chunk_size = params->chunk_sweep[i];
+        process_mem_chunks(params, file_sizes, namesWithParams, inbuf, insize, rate);
+    }
+    params->chunk_size = saved_chunk_size;
+}
+
+
+void lzbench_process_mem_blocks(lzbench_params_t *params, std::vector<size_t> &file_sizes, const char *namesWithParams, uint8_t *inbuf, size_t insize, bench_rate_t rate)
+{
+    if (params->classify)
+    {
+        params->in_class = lzbench_classify(inbuf, insize);
+        LZBENCH_PRINT(3, "%s: class %s\n", params->in_filename, params->in_class);
+    }
+
+    if (params->dedup_avg && insize > 0)
+    {
+        // codecs get only the unique chunks
+        std::vector<size_t> unique_sizes;
+        size_t unique_size;
+        uint8_t* unique = lzbench_dedup(params, file_sizes, inbuf, insize, unique_sizes, unique_size, rate);
+        if (!unique)
+        {
+            printf("Not enough memory, please use -m option!\n");
+            g_exit_result=3;
+            return;
+        }
+        process_chunk_sweep(params, unique_sizes, namesWithParams, unique, unique_size, rate);
+        free(unique);
+        return;
+    }
+
+    process_chunk_sweep(params, file_sizes, namesWithParams, inbuf, insize, rate);
+}
+
+
 int lzbench_join(lzbench_params_t* params, const char** inFileNames, unsigned ifnIdx, char* encoder_list)
 {
     bench_rate_t rate;
@@ -600,7 +962,7 @@ int lzbench_join(lzbench_params_t* params, const char** inFileNames, unsigned if
         return 1;
     }
 
-    inbuf = (uint8_t*)alloc_and_touch(totalsize + PAD_SIZE, false);
+    inbuf = (uint8_t*)alloc_and_touch(totalsize + lzbench_max_padding(), false);
 
     if (!inbuf)
     {
@@ -644,8 +1006,27 @@ int lzbench_join(lzbench_params_t* params, const char** inFileNames, unsigned if
     totalsize = inpos;
 
     print_header(params);
+    if (params->solid) params->solid_files = file_sizes;
     lzbench_process_mem_blocks(params, file_sizes, encoder_list?encoder_list:alias_desc[0].params, inbuf, totalsize, rate);
 
+    if (params->solid)
+    {
+        // the same files again as solid blocks of solid_group files (or all of them)
+        std::vector<size_t> blocks;
+        std::string solid_text;
+        for (size_t i=0; i<file_sizes.size(); i++)
+        {
+            if (params->solid_group ? i % params->solid_group == 0 : i == 0) blocks.push_back(0);
+            blocks.back() += file_sizes[i];
+        }
+        params->solid_files.clear();
+        format(solid_text, "%s solid", text.c_str());
+        params->in_filename = solid_text.c_str();
+        lzbench_process_mem_blocks(params, blocks, encoder_list?encoder_list:alias_desc[0].params, inbuf, totalsize, rate);
+        if (params->textformat != CSV && params->textformat != HTML)
+            lzbench_solid_report(params, text, solid_text);
+    }
+
 _clean:
     free(inbuf);
 
@@ -653,6 +1034,40 @@ _clean:
 }
 
 
+int lzbench_gen(lzbench_params_t* params, std::vector<std::string>& specs, char* encoder_list)
+{
+    bench_rate_t rate;
+    std::vector<size_t> file_sizes;
+    std::string name;
+    uint64_t size;
+    uint8_t *inbuf;
+
+    InitTimer(rate);
+
+    for (size_t i=0; i<specs.size(); i++)
+    {
+        name = lzbench_gen_spec(specs[i].c_str(), &size);
+        inbuf = (uint8_t*)alloc_and_touch(size + lzbench_max_padding(), false);
+        if (!inbuf)
+        {
+            printf("Not enough memory, please use -m option!");
+            return 3;
+        }
+
+        lzbench_generate(specs[i].c_str(), inbuf);
+        params->in_filename = name.c_str();
+        if (i == 0) print_header(params);
+
+        file_sizes.push_back(size);
+        lzbench_process_mem_blocks(params, file_sizes, encoder_list?encoder_list:alias_desc[0].params, inbuf, size, rate);
+        file_sizes.clear();
+        free(inbuf);
+    }
+
+    return g_exit_result;
+}
+
+
 int lzbench_main(lzbench_params_t* params, const char** inFileNames, unsigned ifnIdx, char* encoder_list)
 {
     bench_rate_t rate;
@@ -688,7 +1103,7 @@ int lzbench_main(lzbench_params_t* params, const char** inFileNames, unsigned if
         else
             insize = real_insize;
 
-        inbuf = (uint8_t*)alloc_and_touch(insize + PAD_SIZE, false);
+        inbuf = (uint8_t*)alloc_and_touch(insize + lzbench_max_padding(), false);
 
         if (!inbuf)
         {
@@ -742,21 +1157,76 @@ int lzbench_main(lzbench_params_t* params, const char** inFileNames, unsigned if
 }
 
 
+/*
+ * Parses the rest of -b4,8,16..4096 after the first number: sizes in KB separated by ','
+ * and geometric ranges A..B that double A until B. Returns the first unparsed character
+ * or NULL on error; sizes are returned in bytes, sorted and unique.
+ */
+static char* parse_chunk_sweep(char* ptr, unsigned first, std::vector<size_t>& sizes)
+{
+    size_t last = first;
+    if (first == 0) return NULL;
+    sizes.push_back(last << 10);
+
+    while (*ptr == ',' || (ptr[0] == '.' && ptr[1] == '.'))
+    {
+        bool range = (*ptr == '.');
+        ptr += range ? 2 : 1;
+        if (*ptr < '0' || *ptr > '9') return NULL;
+        size_t number = strtoul(ptr, &ptr, 10);
+        if (number == 0 || (range && number < last)) return NULL;
+        if (range)
+            while ((last *= 2) < number) sizes.push_back(last << 10);
+        sizes.push_back(number << 10);
+        last = number;
+    }
+
+    std::sort(sizes.begin(), sizes.end());
+    sizes.erase(std::unique(sizes.begin(), sizes.end()), sizes.end());
+    return ptr;
+}
+
+
 void usage(lzbench_params_t* params)
 {
     fprintf(stdout, "lzbench - in-memory benchmark of open-source compressors\n\n");
     fprintf(stdout, "usage: " PROGNAME " [options] [input]\n\nwhere [input] is a file/s or a directory and [options] are:\n");
-    fprintf(stdout, "  -b#   set block/chunk size to # KB {default: filesize} (max %ld KB)\n", (uint64_t)(params->chunk_size>>10));
+    fprintf(stdout, "  -b#   set block/chunk size to # KB {default: filesize}, codecs with a lower limit (-l) split chunks into sub-blocks\n");
+    fprintf(stdout, "  -b#,#..# benchmark every block/chunk size from a list, A..B doubles A up to B (e.g. -b4,8,16..4096)\n");
     fprintf(stdout, "  -c#   sort results by column # (1=algname, 2=ctime, 3=dtime, 4=comprsize)\n");
-    fprintf(stdout, "  -e#   #=compressors separated by '/' with parameters specified after ',' {fast}\n");
+    fprintf(stdout, "  -e#   #=compressors separated by '/' with levels specified after ',' and key=value parameters after ':' {fast}\n");
     fprintf(stdout, "  -h    display this help and exit\n");
     fprintf(stdout, "  -iX,Y set min. number of compression and decompression iterations {%d, %d}\n", params->c_iters, params->d_iters);
     fprintf(stdout, "  -j    join files in memory but compress them independently (for many small files)\n");
     fprintf(stdout, "  -l    list of available compressors and aliases\n");
     fprintf(stdout, "  -R    read block/chunk size from random blocks (to estimate for large files)\n");
     fprintf(stdout, "  -m#   set memory limit to # MB {no limit}\n");
-    fprintf(stdout, "  -o#   output text format 1=Markdown, 2=text, 3=text+origSize, 4=CSV {%d}\n", params->textformat);
+    fprintf(stdout, "  -o#   output text format 1=Markdown, 2=text, 3=text+origSize, 4=CSV, 7=NDJSON with all samples, 8=HTML with charts {%d}\n", params->textformat);
     fprintf(stdout, "  -p#   print time for all iterations: 1=fastest 2=average 3=median {%d}\n", params->timetype);
+    fprintf(stdout, "  --decode[=FMT] decode-only benchmark of compressed files (gzip, zstd, lz4, xz, bzip2, brotli) with every decoder\n");
+    fprintf(stdout, "  --sample=K[,entropy] estimate ratio and speeds of huge files from K stratified chunks (-b, 1 MB) with 95%% CIs\n");
+    fprintf(stdout, "  --dict-train[=SPEC] sweep zstd dictionary trainers (size, algo, k, d, steps, split, accel), show time, memory and gain\n");
+    fprintf(stdout, "  --dict[=KB] train a dictionary (112 KB) on every 4th -b record (4 KB), compare records with and without it\n");
+    fprintf(stdout, "  --dict-file=FILE compress all -b records with the given dictionary, compare with no dictionary\n");
+    fprintf(stdout, "  --stream[=MIN-MAX|delim=C] compress messages in order with history and flushes, compare with independent messages\n");
+    fprintf(stdout, "  --solid[=N]    with -j also compress the joined files as one solid block (or groups of N files) and compare\n");
+    fprintf(stdout, "  --pages[=KB[,N]] zram-like page mode (-b KB {4}): same-filled pages, latency percentiles, pages fitting in half or N sectors\n");
+    fprintf(stdout, "  --dedup[=AVG]  compress only unique content-defined chunks (FastCDC, AVG KB average {8}), report dedup and pipeline speed\n");
+    fprintf(stdout, "  --store-fallback[=entropy|lz4] also measure every codec with incompressible chunks stored raw, with the detector cost\n");
+    fprintf(stdout, "  --classify     tag inputs (text, utf8, numeric, executable, structured, binary, compressed) and print the best codec per class\n");
+    fprintf(stdout, "  --parse        print LZ77 parse statistics (match lengths, offsets, literal runs) of zstd and lz4 levels {zstd,1,3,9,19/lz4/lz4hc,4,9,12}\n");
+    fprintf(stdout, "  --profile[=FILE] measure every -b chunk: share of chunks with ratio < 1.05, slowest 1%% regions, CSV to FILE\n");
+    fprintf(stdout, "  --corpus       after per-file results print totals per codec over all files with the worst file\n");
+    fprintf(stdout, "  --gen=SPEC     benchmark synthetic data instead of files, e.g. size=64M,seed=1,entropy=6,match=0.6,mlen=geo:8,moff=zipf:1.1,text=0.2\n");
+    fprintf(stdout, "  --search=SEC   find the Pareto set of -e codecs within SEC seconds using successive halving\n");
+    fprintf(stdout, "  --pareto       print the Pareto frontier (compression speed, decompression speed, ratio) of results\n");
+    fprintf(stdout, "  --recommend=Q  print the best result for query Q=GOAL[,COND]..., e.g. ratio,dspeed>=2000,cspeed>=200\n");
+    fprintf(stdout, "  --save=FILE    write results with all time samples to FILE for --baseline\n");
+    fprintf(stdout, "  --baseline=FILE compare results with FILE written by --save and flag significant regressions\n");
+    fprintf(stdout, "  --db=FILE      reuse results stored in FILE and append new ones (key: input hash, CPU, compiler, codec, level, chunk)\n");
+    fprintf(stdout, "  --db-merge     measure again and merge new samples with samples stored in --db\n");
+    fprintf(stdout, "  --sweep-floor=C[,D] with a -b list mark the best chunk size with compression >= C and decompression >= D MB/s\n");
+    fprintf(stdout, "  --plugins=DIR  load codec plugins (*.so, *.dll, *.dylib) from DIR, see bench/lzbench_plugin.h\n");
 #ifdef UTIL_HAS_CREATEFILELIST
     fprintf(stdout, "  -r    operate recursively on directories\n");
 #endif
@@ -769,10 +1239,12 @@ void usage(lzbench_params_t* params)
     fprintf(stdout, "\nExample usage:\n");
     fprintf(stdout, "  " PROGNAME " -ezstd filename = selects all levels of zstd\n");
     fprintf(stdout, "  " PROGNAME " -ebrotli,2,5/zstd filename = selects levels 2 & 5 of brotli and zstd\n");
+    fprintf(stdout, "  " PROGNAME " -ezstd,19:wlog=27:strategy=btultra/zlib,6:memlevel=9 fname = codec parameters after ':'\n");
     fprintf(stdout, "  " PROGNAME " -t3,5 fname = 3 sec compression and 5 sec decompression loops\n");
     fprintf(stdout, "  " PROGNAME " -t0,0 -i3,5 fname = 3 compression and 5 decompression iterations\n");
     fprintf(stdout, "  " PROGNAME " -o1c4 fname = output markdown format and sort by 4th column\n");
     fprintf(stdout, "  " PROGNAME " -j -r dirname/ = recursively select and join files in given directory\n");
+    fprintf(stdout, "  " PROGNAME " --gen=size=16M,match=0.7,text=0.5 -ezstd = synthetic input described by a spec\n");
 }
 
 void show_version()
@@ -823,7 +1295,14 @@ int main( int argc, char** argv)
     lzbench_params_t* params = &lzparams;
     const char** inFileNames = (const char**) calloc(argc, sizeof(char*));
     unsigned ifnIdx = 0;
-    bool join = false;
+    bool join = false, parse = false, stream = false;
+    std::vector<std::string> gen_specs;
+    const char* decode_format = NULL;
+    const char* stream_spec = NULL;
+    const char* dict_file = NULL;
+    const char* dict_train_spec = NULL;
+    bool dict_train = false;
+    size_t dict_size = 0;
     char* cpu_brand = NULL;
 #ifdef UTIL_HAS_CREATEFILELIST
     const char** extendedFileList = NULL;
@@ -841,7 +1320,7 @@ int main( int argc, char** argv)
     params->textformat = TEXT;
     params->show_speed = 1;
     params->verbose = 2;
-    params->chunk_size = (1ULL << 31) - (1ULL << 31)/6;
+    params->chunk_size = LZBENCH_DEFAULT_CHUNK_SIZE;
     params->cspeed = 0;
     params->c_iters = params->d_iters = 1;
     params->cmintime = 10*DEFAULT_LOOP_TIME/1000000; // 1 sec
@@ -852,6 +1331,96 @@ int main( int argc, char** argv)
     while ((argc>1) && (argv[1][0]=='-')) {
     char* argument = argv[1]+1;
     if (!strcmp(argument, "-compress-only")) params->compress_only = 1;
+    else if (!strncmp(argument, "-search=", 8)) {
+        char* end;
+        unsigned long sec = strtoul(argument + 8, &end, 10);
+        if (end == argument + 8 || *end != 0 || sec < 1 || sec > 86400) { fprintf(stderr, "--search: expected a time budget of 1 to 86400 seconds\n"); result = 1; goto _clean; }
+        params->search_time = (uint32_t)sec;
+    }
+    else if (!strcmp(argument, "-pareto")) params->pareto = 1;
+    else if (!strcmp(argument, "-corpus")) params->corpus = 1;
+    else if (!strcmp(argument, "-decode")) params->decode_only = 1;
+    else if (!strcmp(argument, "-parse")) parse = true;
+    else if (!strcmp(argument, "-classify")) params->classify = 1;
+    else if (!strcmp(argument, "-dict")) dict_size = 112 << 10;
+    else if (!strncmp(argument, "-dict=", 6)) {
+        if (!lzbench_dict_size_parse(argument + 6, &dict_size)) { result = 1; goto _clean; }
+    }
+    else if (!strncmp(argument, "-dict-file=", 11)) dict_file = argument + 11;
+    else if (!strcmp(argument, "-dict-train")) dict_train = true;
+    else if (!strncmp(argument, "-dict-train=", 12)) {
+        if (!lzbench_dict_train_spec_valid(argument + 12)) { result = 1; goto _clean; }
+        dict_train = true;
+        dict_train_spec = argument + 12;
+    }
+    else if (!strcmp(argument, "-stream")) stream = true;
+    else if (!strncmp(argument, "-stream=", 8)) {
+        if (!lzbench_stream_spec_valid(argument + 8)) { result = 1; goto _clean; }
+        stream = true;
+        stream_spec = argument + 8;
+    }
+    else if (!strcmp(argument, "-solid")) {
+        params->solid = 1;
+        join = true;
+    }
+    else if (!strncmp(argument, "-solid=", 7)) {
+        char* end;
+        params->solid = 1;
+        join = true;
+        params->solid_group = strtoul(argument + 7, &end, 10);
+        if (*end != 0 || params->solid_group < 1) { fprintf(stderr, "--solid: expected the number of files per solid block\n"); result = 1; goto _clean; }
+    }
+    else if (!strcmp(argument, "-pages") || !strncmp(argument, "-pages=", 7)) {
+        if (!lzbench_page_parse(argument[6] ? argument + 7 : NULL, params)) { result = 1; goto _clean; }
+    }
+    else if (!strcmp(argument, "-dedup")) params->dedup_avg = 8 << 10;
+    else if (!strncmp(argument, "-dedup=", 7)) {
+        char* end;
+        params->dedup_avg = strtoul(argument + 7, &end, 10) << 10;
+        if (*end != 0 || params->dedup_avg < (1 << 10) || params->dedup_avg > (1 << 20)) { fprintf(stderr, "--dedup: expected the average chunk size of 1 to 1024 KB\n"); result = 1; goto _clean; }
+    }
+    else if (!strcmp(argument, "-store-fallback") || !strncmp(argument, "-store-fallback=", 16)) {
+        if (!lzbench_store_parse(argument[15] ? argument + 16 : NULL, params)) { result = 1; goto _clean; }
+    }
+    else if (!strcmp(argument, "-profile")) params->profile = 1;
+    else if (!strncmp(argument, "-profile=", 9)) {
+        params->profile = 1;
+        params->profile_file = argument + 9;
+    }
+    else if (!strncmp(argument, "-sample=", 8)) {
+        char* end;
+        unsigned long count = strtoul(argument + 8, &end, 10);
+        if (!strcmp(end, ",entropy")) params->sample_entropy = 1;
+        else if (*end != 0) end = NULL;
+        if (!end || count < 2 || count > 1000000) { fprintf(stderr, "--sample: expected K[,entropy] with K from 2 to 1000000\n"); result = 1; goto _clean; }
+        params->sample_count = (unsigned)count;
+    }
+    else if (!strncmp(argument, "-decode=", 8)) {
+        if (!lzbench_decode_format_valid(argument + 8)) { result = 1; goto _clean; }
+        params->decode_only = 1;
+        decode_format = argument + 8;
+    }
+    else if (!strncmp(argument, "-gen=", 5)) {
+        if (lzbench_gen_spec(argument + 5, NULL).empty()) { result = 1; goto _clean; }
+        gen_specs.push_back(argument + 5);
+    }
+    else if (!strncmp(argument, "-sweep-floor=", 13)) {
+        if (!lzbench_sweep_floor_parse(argument + 13, params)) { result = 1; goto _clean; }
+    }
+    else if (!strncmp(argument, "-save=", 6)) params->save_file = argument + 6;
+    else if (!strncmp(argument, "-db=", 4)) params->db_file = argument + 4;
+    else if (!strcmp(argument, "-db-merge")) params->db_merge = 1;
+    else if (!strncmp(argument, "-baseline=", 10)) {
+        if (lzbench_load_results(argument + 10, params->baseline) != 0) { result = 1; goto _clean; }
+    }
+    else if (!strncmp(argument, "-recommend=", 11)) {
+        pareto_query_t query;
+        if (!pareto_parse_query(argument + 11, query)) { result = 1; goto _clean; }
+        params->recommend.push_back(query);
+    }
+    else if (!strncmp(argument, "-plugins=", 9)) {
+        if (lzbench_load_plugins(params, argument + 9) < 0) { result = 1; goto _clean; }
+    }
     else while (argument[0] != 0) {
         char* numPtr = argument + 1;
         unsigned number = 0;
@@ -859,7 +1428,14 @@ int main( int argc, char** argv)
         switch (argument[0])
         {
         case 'b':
-            params->chunk_size = number << 10;
+            params->chunk_size = (size_t)number << 10;
+            params->chunk_sweep.clear();
+            if (*numPtr == ',' || *numPtr == '.')
+            {
+                numPtr = parse_chunk_sweep(numPtr, number, params->chunk_sweep);
+                if (!numPtr) { fprintf(stderr, "invalid -b list: %s\n", argv[1]); result = 1; goto _clean; }
+                params->chunk_size = params->chunk_sweep.back();
+            }
             break;
         case 'c':
             sort_col = number;
@@ -882,12 +1458,12 @@ int main( int argc, char** argv)
             join = true;
             break;
         case 'm':
-            params->mem_limit = number << 18; /*  total memory usage = mem_limit * 4  */
+            params->mem_limit = (size_t)number << 18; /*  total memory usage = mem_limit * 4  */
             if (params->textformat == TEXT) params->textformat = TEXT_FULL;
             break;
         case 'o':
             params->textformat = (textformat_e)number;
-            if (params->textformat == CSV) params->verbose = 0;
+            if (params->textformat == CSV || params->textformat == NDJSON || params->textformat == HTML) params->verbose = 0;
             break;
         case 'p':
             params->timetype = (timetype_e)number;
@@ -938,14 +1514,16 @@ int main( int argc, char** argv)
             goto _clean;
         case 'l':
             printf("Available compressors for -e option:\n");
-            for (int i=0; i<LZBENCH_COMPRESSOR_COUNT; i++)
+            for (size_t i=0; i<lzbench_codecs().size(); i++)
             {
-                if (comp_desc[i].compress)
+                const compressor_desc_t* desc = &lzbench_codecs()[i];
+                if (desc->compress)
                 {
-                    if (comp_desc[i].first_level < comp_desc[i].last_level)
-                        printf("%s = %s [%d-%d]\n", comp_desc[i].name, comp_desc[i].name_version, comp_desc[i].first_level, comp_desc[i].last_level);
+                    std::string caps = lzbench_caps_string(desc);
+                    if (desc->first_level < desc->last_level)
+                        printf("%s = %s [%d-%d] {%s}\n", desc->name, desc->name_version, desc->first_level, desc->last_level, caps.c_str());
                     else
-                        printf("%s = %s\n", comp_desc[i].name, comp_desc[i].name_version);
+                        printf("%s = %s {%s}\n", desc->name, desc->name_version, caps.c_str());
                 }
             }
 
@@ -974,10 +1552,23 @@ int main( int argc, char** argv)
     }
 
     cpu_brand = cpu_brand_string();
+    params->cpu_brand = cpu_brand;
+    params->real_time = real_time;
     LZBENCH_PRINT(2, PROGNAME " " PROGVERSION " (%d-bit " PROGOS ")  %s\n\n", (uint32_t)(8 * sizeof(uint8_t*)), cpu_brand ? cpu_brand : "");
     LZBENCH_PRINT(5, "params: chunk_size=%lu c_iters=%d d_iters=%d cspeed=%d cmintime=%d dmintime=%d encoder_list=%s\n", (uint64_t)params->chunk_size, params->c_iters, params->d_iters, params->cspeed, params->cmintime, params->dmintime, encoder_list);
 
-    if (ifnIdx < 1)  { usage(params); goto _clean; }
+    if (ifnIdx < 1 && gen_specs.empty())  { usage(params); goto _clean; }
+    if (params->sample_count && params->chunk_sweep.size() > 1) { fprintf(stderr, "--sample accepts a single chunk size (-b)\n"); result = 1; goto _clean; }
+    if (params->page_size && (params->chunk_sweep.size() > 1 || params->sample_count || params->decode_only || parse)) { fprintf(stderr, "--pages cannot be used with a -b list, --sample, --decode or --parse\n"); result = 1; goto _clean; }
+    if (params->page_size) params->chunk_size = params->page_size;
+    if (params->solid && (params->dedup_avg || params->sample_count || params->decode_only || parse || !gen_specs.empty())) { fprintf(stderr, "--solid cannot be used with --dedup, --sample, --decode, --parse or --gen\n"); result = 1; goto _clean; }
+    if (params->store_fallback && params->search_time) { fprintf(stderr, "--store-fallback cannot be used with --search\n"); result = 1; goto _clean; }
+    if (params->dedup_avg && (params->sample_count || params->decode_only || parse)) { fprintf(stderr, "--dedup cannot be used with --sample, --decode or --parse\n"); result = 1; goto _clean; }
+    if (stream && (join || params->dedup_avg || params->page_size || params->sample_count || params->decode_only || parse || !gen_specs.empty())) { fprintf(stderr, "--stream cannot be used with -j, --solid, --dedup, --pages, --sample, --decode, --parse or --gen\n"); result = 1; goto _clean; }
+    if (dict_train && (dict_size || dict_file)) { fprintf(stderr, "use either --dict-train or --dict\n"); result = 1; goto _clean; }
+    if (dict_size && dict_file) { fprintf(stderr, "use either --dict or --dict-file\n"); result = 1; goto _clean; }
+    if ((dict_size || dict_file || dict_train) && (stream || join || params->dedup_avg || params->page_size || params->sample_count || params->decode_only || parse || !gen_specs.empty())) { fprintf(stderr, "--dict cannot be used with --stream, -j, --solid, --dedup, --pages, --sample, --decode, --parse or --gen\n"); result = 1; goto _clean; }
+    if (ifnIdx > 0 && !gen_specs.empty()) { fprintf(stderr, "use either --gen or input files\n"); result = 1; goto _clean; }
 
     if (real_time)
     {
@@ -1001,7 +1592,21 @@ int main( int argc, char** argv)
 #endif
 
     /* Main function */
-    if (join)
+    if (parse)
+        result = lzbench_parse(params, inFileNames, ifnIdx, encoder_list);
+    else if (stream)
+        result = lzbench_stream(params, inFileNames, ifnIdx, encoder_list, stream_spec);
+    else if (dict_train)
+        result = lzbench_dict_train(params, inFileNames, ifnIdx, dict_train_spec);
+    else if (dict_size || dict_file)
+        result = lzbench_dict(params, inFileNames, ifnIdx, encoder_list, dict_size, dict_file);
+    else if (!gen_specs.empty())
+        result = lzbench_gen(params, gen_specs, encoder_list);
+    else if (params->sample_count)
+        result = lzbench_sample(params, inFileNames, ifnIdx, encoder_list);
+    else if (params->decode_only)
+        result = lzbench_decode(params, inFileNames, ifnIdx, encoder_list, decode_format);
+    else if (join)
         result = lzbench_join(params, inFileNames, ifnIdx, encoder_list);
     else
         result = lzbench_main(params, inFileNames, ifnIdx, encoder_list);
@@ -1012,6 +1617,39 @@ int main( int argc, char** argv)
         LZBENCH_STDERR(2, "done... (cIters=%d dIters=%d cTime=%.1f dTime=%.1f chunkSize=%luKB cSpeed=%dMB)\n", params->c_iters, params->d_iters, params->cmintime/1000.0, params->dmintime/1000.0, (uint64_t)(params->chunk_size >> 10), params->cspeed);
     }
 
+    if (params->chunk_sweep.size() > 1 && params->textformat != CSV && params->textformat != HTML)
+        lzbench_sweep_report(params);
+
+    if (params->corpus && params->textformat != CSV && params->textformat != HTML)
+        lzbench_corpus_report(params);
+
+    if (params->dedup_avg && params->textformat != CSV && params->textformat != HTML)
+        lzbench_dedup_report(params);
+
+    if (params->page_size && params->textformat != CSV && params->textformat != HTML)
+        lzbench_page_report(params);
+
+    if (params->store_fallback && params->textformat != CSV && params->textformat != HTML)
+        lzbench_store_report(params);
+
+    if (params->classify && params->textformat != CSV && params->textformat != HTML)
+        lzbench_classify_report(params);
+
+    if (params->profile && lzbench_profile_report(params) != 0)
+        result = 1;
+
+    if (params->textformat == HTML)
+        lzbench_html_report(params);
+
+    if ((params->pareto || !params->recommend.empty()) && params->textformat != CSV && params->textformat != HTML)
+        pareto_report(params);
+
+    if (!params->baseline.empty() && params->textformat != CSV && params->textformat != HTML)
+        lzbench_compare_baseline(params);
+
+    if (params->save_file && lzbench_save_results(params, params->save_file) != 0)
+        result = 1;
+
     if (sort_col <= 0) goto _clean;
 
     printf("\nThe results sorted by column number %d:\n", sort_col);
@@ -1046,5 +1684,6 @@ _clean:
     free((void*)inFileNames);
     if (cpu_brand)
         free(cpu_brand);
+    lzbench_unload_plugins();
     return result;
 }
@@ -23,6 +23,7 @@
 #define PAD_SIZE (1024)
 #define MIN_PAGE_SIZE 4096  // smallest page size we expect, if it's wrong the first algorithm might be a bit slower
 #define DEFAULT_LOOP_TIME (100*1000000)  // 1/10 of a second
+#define LZBENCH_DEFAULT_CHUNK_SIZE (sizeof(size_t) > 4 ? (size_t)(1ULL << 40) : (size_t)((1ULL << 31) - (1ULL << 31)/6))  // the whole file up to this size
 #define GET_COMPRESS_BOUND(insize) (insize + insize/16 + PAD_SIZE)
 #define LZBENCH_PRINT(level, fmt, ...) if (params->verbose >= level) printf(fmt, __VA_ARGS__)
 #define LZBENCH_STDERR(level, fmt, ...) if (params->verbose >= level) { fprintf(stderr, fmt, __VA_ARGS__); fflush(stderr); }
@@ -54,7 +55,7 @@
     #define InitTimer(rate) if (!QueryPerformanceFrequency(&rate)) { printf("QueryPerformance not present"); };
     #define GetTime(now) QueryPerformanceCounter(&now);
     #define GetDiffTime(rate, start_ticks, end_ticks) (1000000000ULL*(end_ticks.QuadPart - start_ticks.QuadPart)/rate.QuadPart)
-    void uni_sleep(UINT milisec) { Sleep(milisec); };
+    inline void uni_sleep(UINT milisec) { Sleep(milisec); };
     #ifndef fseeko
         #ifdef _fseeki64
             #define fseeko _fseeki64
@@ -70,7 +71,7 @@
     #include <time.h>
     #include <unistd.h>
     #include <sys/resource.h>
-    void uni_sleep(uint32_t milisec) { usleep(milisec * 1000); };
+    inline void uni_sleep(uint32_t milisec) { usleep(milisec * 1000); };
 #if defined(__APPLE__) || defined(__MACH__)
     #include <mach/mach_time.h>
     typedef mach_timebase_info_data_t bench_rate_t;
@@ -89,18 +90,87 @@
 #endif
 #endif
 
-int g_exit_result = 0;
+extern int g_exit_result;
+
+// a single chunk measured by --profile, times in ns (dtime is 0 with --compress-only)
+typedef struct
+{
+    uint64_t offset, size, comprsize, ctime, dtime;
+} profile_point_t;
 
 typedef struct string_table
 {
     std::string col1_algname;
     uint64_t col2_ctime, col3_dtime, col4_comprsize, col5_origsize;
     std::string col6_filename;
-    string_table(std::string c1, uint64_t c2, uint64_t c3, uint64_t c4, uint64_t c5, std::string filename) : col1_algname(c1), col2_ctime(c2), col3_dtime(c3), col4_comprsize(c4), col5_origsize(c5), col6_filename(filename) {}
+    // identity and raw measurements used by --save and --baseline
+    std::string codec, codec_params, name_version;
+    int level;
+    uint64_t chunk_size;
+    std::vector<std::pair<uint64_t, uint64_t> > chunks;  // run-length encoded chunk sizes: (size, count)
+    std::vector<uint64_t> csamples, dsamples;  // time of every (de)compression iteration in ns, in measurement order
+    std::vector<uint64_t> cloops, dloops;      // mean time per iteration of every timing loop in ns, tested by --baseline
+    bool error;                                // compression or decompression failed
+    std::vector<profile_point_t> profile;      // --profile: measurements of every chunk
+    std::string data_class;                    // --classify: class of the input
+    uint64_t sub_block;                        // sub-block size when chunks were above the codec limit, 0 otherwise
+    string_table(std::string c1, uint64_t c2, uint64_t c3, uint64_t c4, uint64_t c5, std::string filename) : col1_algname(c1), col2_ctime(c2), col3_dtime(c3), col4_comprsize(c4), col5_origsize(c5), col6_filename(filename), level(0), chunk_size(0), error(false), sub_block(0) {}
 } string_table_t;
 
-enum textformat_e { MARKDOWN=1, TEXT, TEXT_FULL, CSV, TURBOBENCH, MARKDOWN2 };
+typedef std::vector<std::pair<std::string, std::string> > codec_kv_t; // key=value codec parameters given with -e
+
+enum textformat_e { MARKDOWN=1, TEXT, TEXT_FULL, CSV, TURBOBENCH, MARKDOWN2, NDJSON, HTML };
 enum timetype_e { FASTEST=1, AVERAGE, MEDIAN };
+enum pareto_metric_e { P_CSPEED, P_DSPEED, P_RATIO };
+
+// a condition of --recommend, e.g. dspeed>=2000 (speeds in MB/s, ratio as original/compressed size)
+typedef struct
+{
+    pareto_metric_e metric;
+    bool at_least;
+    double value;
+} pareto_cond_t;
+
+// --recommend=GOAL[,COND]...: the result with the highest GOAL that satisfies all conditions
+typedef struct
+{
+    std::string text;
+    pareto_metric_e goal;
+    std::vector<pareto_cond_t> conds;
+} pareto_query_t;
+
+enum store_detector_e { STORE_ENTROPY=1, STORE_LZ4 };
+
+// --store-fallback: chunks of an input (per chunk size of a -b list) found incompressible and the time of the detector alone
+typedef struct
+{
+    std::string filename;
+    uint64_t chunk_size, chunks, stored, size, stored_size, nanosec;
+} store_detect_t;
+
+// --dedup: content-defined chunks of an input and the time of chunking and fingerprinting
+typedef struct
+{
+    std::string filename;
+    uint64_t chunks, unique_chunks, size, unique_size, nanosec;
+} dedup_info_t;
+
+// --pages: zram-style results of a codec, latencies in us over the pages that were compressed
+typedef struct
+{
+    std::string name, filename;
+    uint64_t pages, same_filled, half, sectors_fit, zram_size, disk_size;
+    double c_p50, c_p99, c_max, d_p50, d_p99, d_max;
+} page_stats_t;
+
+// --solid: files of every size bucket compressed independently and as one solid block (sizes)
+#define SOLID_BUCKETS 4
+typedef struct
+{
+    std::string name;
+    uint64_t chunk_size;
+    uint64_t files[SOLID_BUCKETS], size[SOLID_BUCKETS], independent[SOLID_BUCKETS], solid[SOLID_BUCKETS];
+} solid_buckets_t;
 
 typedef struct
 {
@@ -111,10 +181,56 @@ typedef struct
     uint32_t c_iters, d_iters, cspeed, verbose, cmintime, dmintime, cloop_time, dloop_time;
     size_t mem_limit;
     int random_read;
+    uint32_t search_time;  // --search total time budget in seconds, 0 = disabled
+    int silent;            // measure without printing rows (--search rounds)
+    int pareto;            // --pareto: print the Pareto frontier of results
+    std::vector<pareto_query_t> recommend;
+    const char* save_file;          // --save: write results with all samples
+    std::vector<string_table_t> baseline;  // --baseline: results loaded from a file written by --save
+    const char* db_file;   // --db: persistent results database
+    int db_merge;          // --db-merge: measure again and merge samples instead of reusing them
+    uint64_t in_hash;      // hash of the current input for --db
+    const char* cpu_brand;
+    int real_time;         // real-time process priority (disabled with -x)
+    std::vector<size_t> chunk_sweep;      // -b with a list of chunk sizes in bytes
+    uint32_t sweep_cspeed, sweep_dspeed;  // --sweep-floor in MB/s
+    int corpus;            // --corpus: print totals over all files
+    int decode_only;       // --decode: inputs are compressed files, only decompression is measured
+    unsigned sample_count; // --sample: number of sampled chunks, 0 = disabled
+    int sample_entropy;    // --sample=K,entropy: stratify samples by entropy of probes
+    int profile;           // --profile: measure every chunk separately
+    const char* profile_file;  // --profile=FILE: write measurements of chunks as CSV
+    int classify;          // --classify: tag inputs with a data class and report the best codec per class
+    int store_fallback;    // --store-fallback: 0 = disabled, STORE_ENTROPY or STORE_LZ4 detector
+    int store_active;      // measuring the "+store" run: chunks found incompressible are copied
+    size_t sub_block;      // max_insize of the codec while chunks above it are measured as sub-blocks, 0 otherwise
+    std::vector<uint8_t> stored_chunks;   // chunks copied by the last compression of the "+store" run
+    std::vector<store_detect_t> store_detect;  // detector results for every input
+    const char* in_class;  // class of the current input
+    size_t dedup_avg;      // --dedup: average content-defined chunk size in bytes, 0 = disabled
+    std::vector<dedup_info_t> dedup_info;  // dedup results for every input
+    size_t page_size;      // --pages: page size in bytes, 0 = disabled
+    size_t page_sectors;   // --pages=KB,SECTORS: 512 B sectors a compressed page must fit in
+    std::vector<page_stats_t> page_stats;  // page results of every codec and input
+    int solid;             // --solid: -j files are also compressed as solid blocks
+    unsigned solid_group;  // --solid=N: files per solid block, 0 = the whole buffer
+    std::vector<size_t> solid_files;  // file sizes during the independent run of --solid
+    std::vector<solid_buckets_t> solid_buckets;  // size buckets of every codec
     std::vector<string_table_t> results;
     const char* in_filename;
 } lzbench_params_t;
 
+// --profile summary of a row, chunks are indexes into row.profile
+typedef struct
+{
+    size_t low_chunks;         // chunks with ratio (original/compressed) < PROFILE_LOW_RATIO
+    uint64_t low_bytes;
+    double min_ratio, median_ratio, max_ratio;
+    std::vector<size_t> slowest_c, slowest_d;  // the slowest 1% (at least 1) of chunks, sorted by offset
+} profile_summary_t;
+
+#define PROFILE_LOW_RATIO 1.05
+
 struct less_using_1st_column { inline bool operator() (const string_table_t& struct1, const string_table_t& struct2) {  return (struct1.col1_algname < struct2.col1_algname); } };
 struct less_using_2nd_column { inline bool operator() (const string_table_t& struct1, const string_table_t& struct2) {  return (struct1.col2_ctime > struct2.col2_ctime); } };
 struct less_using_3rd_column { inline bool operator() (const string_table_t& struct1, const string_table_t& struct2) {  return (struct1.col3_dtime > struct2.col3_dtime); } };
@@ -132,13 +248,35 @@ typedef struct
     int first_level;
     int last_level;
     int additional_param;
-    int unused;
+    uint32_t flags;       // C_* capability flags
+    uint64_t max_insize;  // the largest input accepted by the codec, 0 = unlimited
+    uint32_t padding;     // bytes the codec may touch past the end of its buffers
     compress_func compress;
     compress_func decompress;
     init_func init;
     deinit_func deinit;
 } compressor_desc_t;
 
+// a single codec/level/parameters run selected with -e
+typedef struct codec_candidate
+{
+    const compressor_desc_t* desc;
+    int level;
+    codec_kv_t kv;
+    codec_candidate(const compressor_desc_t* d, int l, const codec_kv_t& k) : desc(d), level(l), kv(k) {}
+} codec_candidate_t;
+
+// short names of LZBENCH_CAP_* used in comp_desc[]
+#define C_STR  LZBENCH_CAP_STREAMING
+#define C_DIC  LZBENCH_CAP_DICTIONARY
+#define C_TS   LZBENCH_CAP_THREAD_SAFE
+#define C_MT   LZBENCH_CAP_NATIVE_THREADS
+
+// max_insize limits: the harness passes GET_COMPRESS_BOUND(chunk) as outsize, so the bound of the limit has to fit as well
+#define LIMIT_INT   0x78000000ULL          // int-sized lengths and internal bound computations
+#define LIMIT_UINT  0xF0000000ULL          // unsigned int-sized lengths
+#define LIMIT_LZ4   LIMIT_INT              // below LZ4_MAX_INPUT_SIZE (0x7E000000)
+
 
 typedef struct
 {
@@ -150,100 +288,101 @@ typedef struct
 
 static const compressor_desc_t comp_desc[] =
 {
-     //                                       last_level,       unused,
-     // name,       name_version,    first_level,  additional_param,  compress_func,               decompress_func,               init_func,               deinit_func
-    { "memcpy",     "memcpy",                  0,   0,    0,       0, lzbench_memcpy,              lzbench_memcpy,                NULL,                    NULL },
-    { "brieflz",    "brieflz 1.3.0",           1,   9,    0,       0, lzbench_brieflz_compress,    lzbench_brieflz_decompress,    lzbench_brieflz_init,    lzbench_brieflz_deinit },
-    { "brotli",     "brotli 1.1.0",            0,  11,    0,       0, lzbench_brotli_compress,     lzbench_brotli_decompress,     NULL,                    NULL },
-    { "brotli22",   "brotli 1.1.0 -d22",       0,  11,   22,       0, lzbench_brotli_compress,     lzbench_brotli_decompress,     NULL,                    NULL },
-    { "brotli24",   "brotli 1.1.0 -d24",       0,  11,   24,       0, lzbench_brotli_compress,     lzbench_brotli_decompress,     NULL,                    NULL },
-    { "bsc0",       "bsc 3.3.5 -m0 -e2",       0,   0,    0,       0, lzbench_bsc_compress,        lzbench_bsc_decompress,        lzbench_bsc_init,        NULL },
-    { "bsc1",       "bsc 3.3.5 -m0 -e1",       0,   0,    1,       0, lzbench_bsc_compress,        lzbench_bsc_decompress,        lzbench_bsc_init,        NULL },
-    { "bsc2",       "bsc 3.3.5 -m0 -e0",       0,   0,    2,       0, lzbench_bsc_compress,        lzbench_bsc_decompress,        lzbench_bsc_init,        NULL },
-    { "bsc3",       "bsc 3.3.5 -m3 -e1",       0,   0,    3,       0, lzbench_bsc_compress,        lzbench_bsc_decompress,        lzbench_bsc_init,        NULL },
-    { "bsc4",       "bsc 3.3.5 -m4 -e1",       0,   0,    4,       0, lzbench_bsc_compress,        lzbench_bsc_decompress,        lzbench_bsc_init,        NULL },
-    { "bsc5",       "bsc 3.3.5 -m5 -e1",       0,   0,    5,       0, lzbench_bsc_compress,        lzbench_bsc_decompress,        lzbench_bsc_init,        NULL },
-    { "bsc6",       "bsc 3.3.5 -m6 -e1",       0,   0,    6,       0, lzbench_bsc_compress,        lzbench_bsc_decompress,        lzbench_bsc_init,        NULL },
-    { "bsc_cuda0",  "bsc 3.3.5 -G -m0 -e2",    0,   0,    0,       0, lzbench_bsc_cuda_compress,   lzbench_bsc_cuda_decompress,   lzbench_bsc_init,        NULL },
-    { "bsc_cuda1",  "bsc 3.3.5 -G -m0 -e1",    0,   0,    1,       0, lzbench_bsc_cuda_compress,   lzbench_bsc_cuda_decompress,   lzbench_bsc_init,        NULL },
-    { "bsc_cuda2",  "bsc 3.3.5 -G -m0 -e0",    0,   0,    2,       0, lzbench_bsc_cuda_compress,   lzbench_bsc_cuda_decompress,   lzbench_bsc_init,        NULL },
-    { "bsc_cuda3",  "bsc 3.3.5 -G -m3 -e1",    0,   0,    3,       0, lzbench_bsc_cuda_compress,   lzbench_bsc_cuda_decompress,   lzbench_bsc_init,        NULL },
-    { "bsc_cuda4",  "bsc 3.3.5 -G -m4 -e1",    0,   0,    4,       0, lzbench_bsc_cuda_compress,   lzbench_bsc_cuda_decompress,   lzbench_bsc_init,        NULL },
-    { "bsc_cuda5",  "bsc 3.3.5 -G -m5 -e1",    0,   0,    5,       0, lzbench_bsc_cuda_compress,   lzbench_bsc_cuda_decompress,   lzbench_bsc_init,        NULL },
-    { "bsc_cuda6",  "bsc 3.3.5 -G -m6 -e1",    0,   0,    6,       0, lzbench_bsc_cuda_compress,   lzbench_bsc_cuda_decompress,   lzbench_bsc_init,        NULL },
-    { "bsc_cuda7",  "bsc 3.3.5 -G -m7 -e0",    0,   0,    7,       0, lzbench_bsc_cuda_compress,   lzbench_bsc_cuda_decompress,   lzbench_bsc_init,        NULL },
-    { "bsc_cuda8",  "bsc 3.3.5 -G -m8 -e0",    0,   0,    8,       0, lzbench_bsc_cuda_compress,   lzbench_bsc_cuda_decompress,   lzbench_bsc_init,        NULL },
-    { "bzip2",      "bzip2 1.0.8",             1,   9,    0,       0, lzbench_bzip2_compress,      lzbench_bzip2_decompress,      NULL,                    NULL },
-    { "bzip3",      "bzip3 1.5.1",             1,  10,    0,       0, lzbench_bzip3_compress,      lzbench_bzip3_decompress,      NULL,                    NULL },
-    { "crush",      "crush 1.0",               0,   2,    0,       0, lzbench_crush_compress,      lzbench_crush_decompress,      NULL,                    NULL },
-    { "csc",        "csc 2016-10-13",          1,   5,    0,       0, lzbench_csc_compress,        lzbench_csc_decompress,        NULL,                    NULL },
-    { "cudaMemcpy", "cudaMemcpy",              0,   0,    0,       0, lzbench_cuda_memcpy,         lzbench_cuda_memcpy,           lzbench_cuda_init,       lzbench_cuda_deinit },
-    { "density",    "density 0.14.2",          1,   3,    0,       0, lzbench_density_compress,    lzbench_density_decompress,    lzbench_density_init,    lzbench_density_deinit },
-    { "fastlz",     "fastlz 0.5.0",            1,   2,    0,       0, lzbench_fastlz_compress,     lzbench_fastlz_decompress,     NULL,                    NULL },
-    { "fastlzma2",  "fastlzma2 1.0.1",         1,  10,    0,       0, lzbench_fastlzma2_compress,  lzbench_fastlzma2_decompress,  NULL,                    NULL },
-    { "gipfeli",    "gipfeli 2016-07-13",      0,   0,    0,       0, lzbench_gipfeli_compress,    lzbench_gipfeli_decompress,    NULL,                    NULL },
-    { "glza",       "glza 0.8",                0,   0,    0,       0, lzbench_glza_compress,       lzbench_glza_decompress,       NULL,                    NULL },
-    { "kanzi",      "kanzi 2.3",               1,   9,    0,       0, lzbench_kanzi_compress,      lzbench_kanzi_decompress,      NULL,                    NULL },
-    { "libdeflate", "libdeflate 1.23",         1,  12,    0,       0, lzbench_libdeflate_compress, lzbench_libdeflate_decompress, NULL,                    NULL },
-    { "lizard",     "lizard 2.1",  LIZARD_MIN_CLEVEL, LIZARD_MAX_CLEVEL, 0, 0, lzbench_lizard_compress,      lzbench_lizard_decompress,        NULL,                    NULL },
-    { "lz4",        "lz4 1.10.0",              0,   0,    0,       0, lzbench_lz4_compress,        lzbench_lz4_decompress,        NULL,                    NULL },
-    { "lz4fast",    "lz4 1.10.0 --fast",       1,  99,    0,       0, lzbench_lz4fast_compress,    lzbench_lz4_decompress,        NULL,                    NULL },
-    { "lz4hc",      "lz4hc 1.10.0",            1,  12,    0,       0, lzbench_lz4hc_compress,      lzbench_lz4_decompress,        NULL,                    NULL },
-    { "lzav",       "lzav 4.18",               1,   2,    0,       0, lzbench_lzav_compress,       lzbench_lzav_decompress,       NULL,                    NULL },
-    { "lzf",        "lzf 3.6",                 0,   1,    0,       0, lzbench_lzf_compress,        lzbench_lzf_decompress,        NULL,                    NULL },
-    { "lzfse",      "lzfse 2017-03-08",        0,   0,    0,       0, lzbench_lzfse_compress,      lzbench_lzfse_decompress,      lzbench_lzfse_init,      lzbench_lzfse_deinit },
-    { "lzg",        "lzg 1.0.10",              1,   9,    0,       0, lzbench_lzg_compress,        lzbench_lzg_decompress,        NULL,                    NULL },
-    { "lzham",      "lzham 1.0 -d26",          0,   4,    0,       0, lzbench_lzham_compress,      lzbench_lzham_decompress,      NULL,                    NULL },
-    { "lzham22",    "lzham 1.0 -d22",          0,   4,   22,       0, lzbench_lzham_compress,      lzbench_lzham_decompress,      NULL,                    NULL },
-    { "lzham24",    "lzham 1.0 -d24",          0,   4,   24,       0, lzbench_lzham_compress,      lzbench_lzham_decompress,      NULL,                    NULL },
-    { "lzjb",       "lzjb 2010",               0,   0,    0,       0, lzbench_lzjb_compress,       lzbench_lzjb_decompress,       NULL,                    NULL },
-    { "lzlib",      "lzlib 1.15",              0,   9,    0,       0, lzbench_lzlib_compress,      lzbench_lzlib_decompress,      NULL,                    NULL },
-    { "lzma",       "lzma 24.09",              0,   9,    0,       0, lzbench_lzma_compress,       lzbench_lzma_decompress,       NULL,                    NULL },
-    { "lzmat",      "lzmat 1.01",              0,   0,    0,       0, lzbench_lzmat_compress,      lzbench_lzmat_decompress,      NULL,                    NULL }, // decompression error (returns 0) and SEGFAULT (?)
-    { "lzo1",       "lzo1 2.10",               1,   1,    0,       0, lzbench_lzo1_compress,       lzbench_lzo1_decompress,       lzbench_lzo_init,        lzbench_lzo_deinit },
-    { "lzo1a",      "lzo1a 2.10",              1,   1,    0,       0, lzbench_lzo1a_compress,      lzbench_lzo1a_decompress,      lzbench_lzo_init,        lzbench_lzo_deinit },
-    { "lzo1b",      "lzo1b 2.10",              1,   1,    0,       0, lzbench_lzo1b_compress,      lzbench_lzo1b_decompress,      lzbench_lzo_init,        lzbench_lzo_deinit },
-    { "lzo1c",      "lzo1c 2.10",              1,   1,    0,       0, lzbench_lzo1c_compress,      lzbench_lzo1c_decompress,      lzbench_lzo_init,        lzbench_lzo_deinit },
-    { "lzo1f",      "lzof 2.10",               1,   1,    0,       0, lzbench_lzo1f_compress,      lzbench_lzo1f_decompress,      lzbench_lzo_init,        lzbench_lzo_deinit },
-    { "lzo1x",      "lzo1x 2.10",              1,   1,    0,       0, lzbench_lzo1x_compress,      lzbench_lzo1x_decompress,      lzbench_lzo_init,        lzbench_lzo_deinit },
-    { "lzo1y",      "lzo1y 2.10",              1,   1,    0,       0, lzbench_lzo1y_compress,      lzbench_lzo1y_decompress,      lzbench_lzo_init,        lzbench_lzo_deinit },
-    { "lzo1z",      "lzo1z 2.10",            999, 999,    0,       0, lzbench_lzo1z_compress,      lzbench_lzo1z_decompress,      lzbench_lzo_init,        lzbench_lzo_deinit },
-    { "lzo2a",      "lzo2a 2.10",            999, 999,    0,       0, lzbench_lzo2a_compress,      lzbench_lzo2a_decompress,      lzbench_lzo_init,        lzbench_lzo_deinit },
-    { "lzrw",       "lzrw 15-Jul-1991",        1,   5,    0,       0, lzbench_lzrw_compress,       lzbench_lzrw_decompress,       lzbench_lzrw_init,       lzbench_lzrw_deinit },
-    { "lzsse2",     "lzsse2 2019-04-18",       0,  17,    0,       0, lzbench_lzsse2_compress,     lzbench_lzsse2_decompress,     lzbench_lzsse2_init,     lzbench_lzsse2_deinit },
-    { "lzsse4",     "lzsse4 2019-04-18",       0,  17,    0,       0, lzbench_lzsse4_compress,     lzbench_lzsse4_decompress,     lzbench_lzsse4_init,     lzbench_lzsse4_deinit },
-    { "lzsse4fast", "lzsse4fast 2019-04-18",   0,   0,    0,       0, lzbench_lzsse4fast_compress, lzbench_lzsse4_decompress,     lzbench_lzsse4fast_init, lzbench_lzsse4fast_deinit },
-    { "lzsse8",     "lzsse8 2019-04-18",       0,  17,    0,       0, lzbench_lzsse8_compress,     lzbench_lzsse8_decompress,     lzbench_lzsse8_init,     lzbench_lzsse8_deinit },
-    { "lzsse8fast", "lzsse8fast 2019-04-18",   0,   0,    0,       0, lzbench_lzsse8fast_compress, lzbench_lzsse8_decompress,     lzbench_lzsse8fast_init, lzbench_lzsse8fast_deinit },
-    { "lzvn",       "lzvn 2017-03-08",         0,   0,    0,       0, lzbench_lzvn_compress,       lzbench_lzvn_decompress,       lzbench_lzvn_init,       lzbench_lzvn_deinit },
-    { "nakamichi",  "nakamichi okamigan",      0,   0,    0,       0, lzbench_nakamichi_compress,  lzbench_nakamichi_decompress,  NULL,                    NULL },
-    { "nvcomp_lz4", "nvcomp_lz4 2.2.0",        0,   7,    0,       0, lzbench_nvcomp_compress,     lzbench_nvcomp_decompress,     lzbench_nvcomp_init,     lzbench_nvcomp_deinit },
-    { "pithy",      "pithy 2011-12-24",        0,   9,    0,       0, lzbench_pithy_compress,      lzbench_pithy_decompress,      NULL,                    NULL }, // decompression error (returns 0)
-    { "ppmd8",      "ppmd8 24.09",             1,   9,    0,       0, lzbench_ppmd_compress,       lzbench_ppmd_decompress,       NULL,                    NULL },
-    { "quicklz",    "quicklz 1.5.0",           1,   3,    0,       0, lzbench_quicklz_compress,    lzbench_quicklz_decompress,    NULL,                    NULL },
-    { "slz_deflate","slz_deflate 1.2.1",       1,   3,    2,       0, lzbench_slz_compress,        lzbench_slz_decompress,        NULL,                    NULL },
-    { "slz_gzip",   "slz_gzip 1.2.1",          1,   3,    1,       0, lzbench_slz_compress,        lzbench_slz_decompress,        NULL,                    NULL },
-    { "slz_zlib",   "slz_zlib 1.2.1",          1,   3,    0,       0, lzbench_slz_compress,        lzbench_slz_decompress,        NULL,                    NULL },
-    { "snappy",     "snappy 1.2.1",            0,   0,    0,       0, lzbench_snappy_compress,     lzbench_snappy_decompress,     NULL,                    NULL },
-    { "tamp",       "tamp 1.3.1",              8,  15,    0,       0, lzbench_tamp_compress,       lzbench_tamp_decompress,       lzbench_tamp_init,       lzbench_tamp_deinit },
-    { "tornado",    "tornado 0.6a",            1,  16,    0,       0, lzbench_tornado_compress,    lzbench_tornado_decompress,    NULL,                    NULL },
-    { "ucl_nrv2b",  "ucl_nrv2b 1.03",          1,   9,    0,       0, lzbench_ucl_nrv2b_compress,  lzbench_ucl_nrv2b_decompress,  NULL,                    NULL },
-    { "ucl_nrv2d",  "ucl_nrv2d 1.03",          1,   9,    0,       0, lzbench_ucl_nrv2d_compress,  lzbench_ucl_nrv2d_decompress,  NULL,                    NULL },
-    { "ucl_nrv2e",  "ucl_nrv2e 1.03",          1,   9,    0,       0, lzbench_ucl_nrv2e_compress,  lzbench_ucl_nrv2e_decompress,  NULL,                    NULL },
-    { "wflz",       "wflz 2015-09-16",         0,   0,    0,       0, lzbench_wflz_compress,       lzbench_wflz_decompress,       lzbench_wflz_init,       lzbench_wflz_deinit }, // SEGFAULT on decompression with gcc 4.9+ -O3 on Ubuntu
-    { "xz",         "xz 5.6.3",                0,   9,    0,       0, lzbench_xz_compress,         lzbench_xz_decompress,         NULL,                    NULL },
-    { "yalz77",     "yalz77 2015-09-19",       1,  12,    0,       0, lzbench_yalz77_compress,     lzbench_yalz77_decompress,     NULL,                    NULL },
-    { "yappy",      "yappy 2014-03-22",        1,  12,    0,       0, lzbench_yappy_compress,      lzbench_yappy_decompress,      lzbench_yappy_init,      NULL },
-    { "zlib",       "zlib 1.3.1",              1,   9,    0,       0, lzbench_zlib_compress,       lzbench_zlib_decompress,       NULL,                    NULL },
-    { "zlib-ng",    "zlib-ng 2.2.3",           1,   9,    0,       0, lzbench_zlib_ng_compress,    lzbench_zlib_ng_decompress,    NULL,                    NULL },
-    { "zling",      "zling 2018-10-12",        0,   4,    0,       0, lzbench_zling_compress,      lzbench_zling_decompress,      NULL,                    NULL },
-    { "zstd",       "zstd 1.5.7",              1,  22,    0,       0, lzbench_zstd_compress,       lzbench_zstd_decompress,       lzbench_zstd_init,       lzbench_zstd_deinit },
-    { "zstd22",     "zstd 1.5.7 -d22",        16,  22,   22,       0, lzbench_zstd_compress,       lzbench_zstd_decompress,       lzbench_zstd_init,       lzbench_zstd_deinit },
-    { "zstd22LDM",  "zstd 1.5.7 --long -d22", 16,  22,   22,       0, lzbench_zstd_LDM_compress,   lzbench_zstd_decompress,       lzbench_zstd_LDM_init,   lzbench_zstd_deinit },
-    { "zstd24",     "zstd 1.5.7 -d24",        16,  22,   24,       0, lzbench_zstd_compress,       lzbench_zstd_decompress,       lzbench_zstd_init,       lzbench_zstd_deinit },
-    { "zstd24LDM",  "zstd 1.5.7 --long -d24", 16,  22,   24,       0, lzbench_zstd_LDM_compress,   lzbench_zstd_decompress,       lzbench_zstd_LDM_init,   lzbench_zstd_deinit },
-    { "zstdLDM",    "zstd 1.5.7 --long",       1,  22,    0,       0, lzbench_zstd_LDM_compress,   lzbench_zstd_decompress,       lzbench_zstd_LDM_init,   lzbench_zstd_deinit },
-    { "zstd_fast",  "zstd 1.5.7 --fast",      -5,  -1,    0,       0, lzbench_zstd_compress,       lzbench_zstd_decompress,       lzbench_zstd_init,       lzbench_zstd_deinit },
+     //                                     first_level,    additional_param,       max_insize,
+     // name,       name_version,                   last_level,      flags,                           padding, compress_func,               decompress_func,               init_func,               deinit_func
+    { "memcpy",     "memcpy",                   0,   0,   0, C_TS,                  0,            0, lzbench_memcpy,              lzbench_memcpy,                NULL,                    NULL },
+    { "auto",       "auto lz4/zstd/store",      1,   3,   0, C_TS,                  LIMIT_LZ4,    0, lzbench_auto_compress,       lzbench_auto_decompress,       lzbench_auto_init,       lzbench_auto_deinit },
+    { "brieflz",    "brieflz 1.3.0",            1,   9,   0, C_TS,                  LIMIT_UINT,   0, lzbench_brieflz_compress,    lzbench_brieflz_decompress,    lzbench_brieflz_init,    lzbench_brieflz_deinit },
+    { "brotli",     "brotli 1.1.0",             0,  11,   0, C_STR|C_DIC|C_TS,      0,            0, lzbench_brotli_compress,     lzbench_brotli_decompress,     NULL,                    NULL },
+    { "brotli22",   "brotli 1.1.0 -d22",        0,  11,  22, C_STR|C_DIC|C_TS,      0,            0, lzbench_brotli_compress,     lzbench_brotli_decompress,     NULL,                    NULL },
+    { "brotli24",   "brotli 1.1.0 -d24",        0,  11,  24, C_STR|C_DIC|C_TS,      0,            0, lzbench_brotli_compress,     lzbench_brotli_decompress,     NULL,                    NULL },
+    { "bsc0",       "bsc 3.3.5 -m0 -e2",        0,   0,   0, C_MT,                  LIMIT_INT,    0, lzbench_bsc_compress,        lzbench_bsc_decompress,        lzbench_bsc_init,        NULL },
+    { "bsc1",       "bsc 3.3.5 -m0 -e1",        0,   0,   1, C_MT,                  LIMIT_INT,    0, lzbench_bsc_compress,        lzbench_bsc_decompress,        lzbench_bsc_init,        NULL },
+    { "bsc2",       "bsc 3.3.5 -m0 -e0",        0,   0,   2, C_MT,                  LIMIT_INT,    0, lzbench_bsc_compress,        lzbench_bsc_decompress,        lzbench_bsc_init,        NULL },
+    { "bsc3",       "bsc 3.3.5 -m3 -e1",        0,   0,   3, C_MT,                  LIMIT_INT,    0, lzbench_bsc_compress,        lzbench_bsc_decompress,        lzbench_bsc_init,        NULL },
+    { "bsc4",       "bsc 3.3.5 -m4 -e1",        0,   0,   4, C_MT,                  LIMIT_INT,    0, lzbench_bsc_compress,        lzbench_bsc_decompress,        lzbench_bsc_init,        NULL },
+    { "bsc5",       "bsc 3.3.5 -m5 -e1",        0,   0,   5, C_MT,                  LIMIT_INT,    0, lzbench_bsc_compress,        lzbench_bsc_decompress,        lzbench_bsc_init,        NULL },
+    { "bsc6",       "bsc 3.3.5 -m6 -e1",        0,   0,   6, C_MT,                  LIMIT_INT,    0, lzbench_bsc_compress,        lzbench_bsc_decompress,        lzbench_bsc_init,        NULL },
+    { "bsc_cuda0",  "bsc 3.3.5 -G -m0 -e2",     0,   0,   0, 0,                     LIMIT_INT,    0, lzbench_bsc_cuda_compress,   lzbench_bsc_cuda_decompress,   lzbench_bsc_init,        NULL },
+    { "bsc_cuda1",  "bsc 3.3.5 -G -m0 -e1",     0,   0,   1, 0,                     LIMIT_INT,    0, lzbench_bsc_cuda_compress,   lzbench_bsc_cuda_decompress,   lzbench_bsc_init,        NULL },
+    { "bsc_cuda2",  "bsc 3.3.5 -G -m0 -e0",     0,   0,   2, 0,                     LIMIT_INT,    0, lzbench_bsc_cuda_compress,   lzbench_bsc_cuda_decompress,   lzbench_bsc_init,        NULL },
+    { "bsc_cuda3",  "bsc 3.3.5 -G -m3 -e1",     0,   0,   3, 0,                     LIMIT_INT,    0, lzbench_bsc_cuda_compress,   lzbench_bsc_cuda_decompress,   lzbench_bsc_init,        NULL },
+    { "bsc_cuda4",  "bsc 3.3.5 -G -m4 -e1",     0,   0,   4, 0,                     LIMIT_INT,    0, lzbench_bsc_cuda_compress,   lzbench_bsc_cuda_decompress,   lzbench_bsc_init,        NULL },
+    { "bsc_cuda5",  "bsc 3.3.5 -G -m5 -e1",     0,   0,   5, 0,                     LIMIT_INT,    0, lzbench_bsc_cuda_compress,   lzbench_bsc_cuda_decompress,   lzbench_bsc_init,        NULL },
+    { "bsc_cuda6",  "bsc 3.3.5 -G -m6 -e1",     0,   0,   6, 0,                     LIMIT_INT,    0, lzbench_bsc_cuda_compress,   lzbench_bsc_cuda_decompress,   lzbench_bsc_init,        NULL },
+    { "bsc_cuda7",  "bsc 3.3.5 -G -m7 -e0",     0,   0,   7, 0,                     LIMIT_INT,    0, lzbench_bsc_cuda_compress,   lzbench_bsc_cuda_decompress,   lzbench_bsc_init,        NULL },
+    { "bsc_cuda8",  "bsc 3.3.5 -G -m8 -e0",     0,   0,   8, 0,                     LIMIT_INT,    0, lzbench_bsc_cuda_compress,   lzbench_bsc_cuda_decompress,   lzbench_bsc_init,        NULL },
+    { "bzip2",      "bzip2 1.0.8",              1,   9,   0, C_STR|C_TS,            LIMIT_UINT,   0, lzbench_bzip2_compress,      lzbench_bzip2_decompress,      NULL,                    NULL },
+    { "bzip3",      "bzip3 1.5.1",              1,  10,   0, C_TS,                  0,            0, lzbench_bzip3_compress,      lzbench_bzip3_decompress,      NULL,                    NULL },
+    { "crush",      "crush 1.0",                0,   2,   0, 0,                     LIMIT_INT,    0, lzbench_crush_compress,      lzbench_crush_decompress,      NULL,                    NULL },
+    { "csc",        "csc 2016-10-13",           1,   5,   0, C_STR,                 0,            0, lzbench_csc_compress,        lzbench_csc_decompress,        NULL,                    NULL },
+    { "cudaMemcpy", "cudaMemcpy",               0,   0,   0, 0,                     0,            0, lzbench_cuda_memcpy,         lzbench_cuda_memcpy,           lzbench_cuda_init,       lzbench_cuda_deinit },
+    { "density",    "density 0.14.2",           1,   3,   0, 0,                     0,           64, lzbench_density_compress,    lzbench_density_decompress,    lzbench_density_init,    lzbench_density_deinit },
+    { "fastlz",     "fastlz 0.5.0",             1,   2,   0, C_TS,                  LIMIT_INT,    0, lzbench_fastlz_compress,     lzbench_fastlz_decompress,     NULL,                    NULL },
+    { "fastlzma2",  "fastlzma2 1.0.1",          1,  10,   0, C_STR|C_TS|C_MT,       0,            0, lzbench_fastlzma2_compress,  lzbench_fastlzma2_decompress,  NULL,                    NULL },
+    { "gipfeli",    "gipfeli 2016-07-13",       0,   0,   0, C_TS,                  0,            0, lzbench_gipfeli_compress,    lzbench_gipfeli_decompress,    NULL,                    NULL },
+    { "glza",       "glza 0.8",                 0,   0,   0, 0,                     0,            0, lzbench_glza_compress,       lzbench_glza_decompress,       NULL,                    NULL },
+    { "kanzi",      "kanzi 2.3",                1,   9,   0, C_STR|C_TS|C_MT,       LIMIT_INT,    0, lzbench_kanzi_compress,      lzbench_kanzi_decompress,      NULL,                    NULL },
+    { "libdeflate", "libdeflate 1.23",          1,  12,   0, C_TS,                  0,            0, lzbench_libdeflate_compress, lzbench_libdeflate_decompress, NULL,                    NULL },
+    { "lizard",     "lizard 2.1",             LIZARD_MIN_CLEVEL, LIZARD_MAX_CLEVEL,   0, C_STR|C_TS,            LIMIT_LZ4,    0, lzbench_lizard_compress,     lzbench_lizard_decompress,     NULL,                    NULL },
+    { "lz4",        "lz4 1.10.0",               0,   0,   0, C_STR|C_DIC|C_TS,      LIMIT_LZ4,    0, lzbench_lz4_compress,        lzbench_lz4_decompress,        NULL,                    NULL },
+    { "lz4fast",    "lz4 1.10.0 --fast",        1,  99,   0, C_STR|C_DIC|C_TS,      LIMIT_LZ4,    0, lzbench_lz4fast_compress,    lzbench_lz4_decompress,        NULL,                    NULL },
+    { "lz4hc",      "lz4hc 1.10.0",             1,  12,   0, C_STR|C_DIC|C_TS,      LIMIT_LZ4,    0, lzbench_lz4hc_compress,      lzbench_lz4_decompress,        NULL,                    NULL },
+    { "lzav",       "lzav 4.18",                1,   2,   0, C_TS,                  LIMIT_INT,    0, lzbench_lzav_compress,       lzbench_lzav_decompress,       NULL,                    NULL },
+    { "lzf",        "lzf 3.6",                  0,   1,   0, C_TS,                  LIMIT_UINT,   0, lzbench_lzf_compress,        lzbench_lzf_decompress,        NULL,                    NULL },
+    { "lzfse",      "lzfse 2017-03-08",         0,   0,   0, C_TS,                  0,            0, lzbench_lzfse_compress,      lzbench_lzfse_decompress,      lzbench_lzfse_init,      lzbench_lzfse_deinit },
+    { "lzg",        "lzg 1.0.10",               1,   9,   0, C_TS,                  LIMIT_UINT,   0, lzbench_lzg_compress,        lzbench_lzg_decompress,        NULL,                    NULL },
+    { "lzham",      "lzham 1.0 -d26",           0,   4,   0, C_STR|C_DIC|C_TS|C_MT, 0,            0, lzbench_lzham_compress,      lzbench_lzham_decompress,      NULL,                    NULL },
+    { "lzham22",    "lzham 1.0 -d22",           0,   4,  22, C_STR|C_DIC|C_TS|C_MT, 0,            0, lzbench_lzham_compress,      lzbench_lzham_decompress,      NULL,                    NULL },
+    { "lzham24",    "lzham 1.0 -d24",           0,   4,  24, C_STR|C_DIC|C_TS|C_MT, 0,            0, lzbench_lzham_compress,      lzbench_lzham_decompress,      NULL,                    NULL },
+    { "lzjb",       "lzjb 2010",                0,   0,   0, C_TS,                  0,            0, lzbench_lzjb_compress,       lzbench_lzjb_decompress,       NULL,                    NULL },
+    { "lzlib",      "lzlib 1.15",               0,   9,   0, C_STR|C_TS,            LIMIT_INT,    0, lzbench_lzlib_compress,      lzbench_lzlib_decompress,      NULL,                    NULL },
+    { "lzma",       "lzma 24.09",               0,   9,   0, C_STR|C_TS|C_MT,       0,            0, lzbench_lzma_compress,       lzbench_lzma_decompress,       NULL,                    NULL },
+    { "lzmat",      "lzmat 1.01",               0,   0,   0, 0,                     LIMIT_UINT,   0, lzbench_lzmat_compress,      lzbench_lzmat_decompress,      NULL,                    NULL }, // decompression error (returns 0) and SEGFAULT (?)
+    { "lzo1",       "lzo1 2.10",                1,   1,   0, C_TS,                  0,            0, lzbench_lzo1_compress,       lzbench_lzo1_decompress,       lzbench_lzo_init,        lzbench_lzo_deinit },
+    { "lzo1a",      "lzo1a 2.10",               1,   1,   0, C_TS,                  0,            0, lzbench_lzo1a_compress,      lzbench_lzo1a_decompress,      lzbench_lzo_init,        lzbench_lzo_deinit },
+    { "lzo1b",      "lzo1b 2.10",               1,   1,   0, C_TS,                  0,            0, lzbench_lzo1b_compress,      lzbench_lzo1b_decompress,      lzbench_lzo_init,        lzbench_lzo_deinit },
+    { "lzo1c",      "lzo1c 2.10",               1,   1,   0, C_TS,                  0,            0, lzbench_lzo1c_compress,      lzbench_lzo1c_decompress,      lzbench_lzo_init,        lzbench_lzo_deinit },
+    { "lzo1f",      "lzof 2.10",                1,   1,   0, C_TS,                  0,            0, lzbench_lzo1f_compress,      lzbench_lzo1f_decompress,      lzbench_lzo_init,        lzbench_lzo_deinit },
+    { "lzo1x",      "lzo1x 2.10",               1,   1,   0, C_TS,                  0,            0, lzbench_lzo1x_compress,      lzbench_lzo1x_decompress,      lzbench_lzo_init,        lzbench_lzo_deinit },
+    { "lzo1y",      "lzo1y 2.10",               1,   1,   0, C_TS,                  0,            0, lzbench_lzo1y_compress,      lzbench_lzo1y_decompress,      lzbench_lzo_init,        lzbench_lzo_deinit },
+    { "lzo1z",      "lzo1z 2.10",             999, 999,   0, C_TS,                  0,            0, lzbench_lzo1z_compress,      lzbench_lzo1z_decompress,      lzbench_lzo_init,        lzbench_lzo_deinit },
+    { "lzo2a",      "lzo2a 2.10",             999, 999,   0, C_TS,                  0,            0, lzbench_lzo2a_compress,      lzbench_lzo2a_decompress,      lzbench_lzo_init,        lzbench_lzo_deinit },
+    { "lzrw",       "lzrw 15-Jul-1991",         1,   5,   0, 0,                     LIMIT_UINT,   0, lzbench_lzrw_compress,       lzbench_lzrw_decompress,       lzbench_lzrw_init,       lzbench_lzrw_deinit },
+    { "lzsse2",     "lzsse2 2019-04-18",        0,  17,   0, C_TS,                  0,           16, lzbench_lzsse2_compress,     lzbench_lzsse2_decompress,     lzbench_lzsse2_init,     lzbench_lzsse2_deinit },
+    { "lzsse4",     "lzsse4 2019-04-18",        0,  17,   0, C_TS,                  0,           16, lzbench_lzsse4_compress,     lzbench_lzsse4_decompress,     lzbench_lzsse4_init,     lzbench_lzsse4_deinit },
+    { "lzsse4fast", "lzsse4fast 2019-04-18",    0,   0,   0, C_TS,                  0,           16, lzbench_lzsse4fast_compress, lzbench_lzsse4_decompress,     lzbench_lzsse4fast_init, lzbench_lzsse4fast_deinit },
+    { "lzsse8",     "lzsse8 2019-04-18",        0,  17,   0, C_TS,                  0,           16, lzbench_lzsse8_compress,     lzbench_lzsse8_decompress,     lzbench_lzsse8_init,     lzbench_lzsse8_deinit },
+    { "lzsse8fast", "lzsse8fast 2019-04-18",    0,   0,   0, C_TS,                  0,           16, lzbench_lzsse8fast_compress, lzbench_lzsse8_decompress,     lzbench_lzsse8fast_init, lzbench_lzsse8fast_deinit },
+    { "lzvn",       "lzvn 2017-03-08",          0,   0,   0, C_TS,                  0,            0, lzbench_lzvn_compress,       lzbench_lzvn_decompress,       lzbench_lzvn_init,       lzbench_lzvn_deinit },
+    { "nakamichi",  "nakamichi okamigan",       0,   0,   0, 0,                     LIMIT_UINT,   0, lzbench_nakamichi_compress,  lzbench_nakamichi_decompress,  NULL,                    NULL },
+    { "nvcomp_lz4", "nvcomp_lz4 2.2.0",         0,   7,   0, 0,                     0,            0, lzbench_nvcomp_compress,     lzbench_nvcomp_decompress,     lzbench_nvcomp_init,     lzbench_nvcomp_deinit },
+    { "pithy",      "pithy 2011-12-24",         0,   9,   0, C_TS,                  0,            0, lzbench_pithy_compress,      lzbench_pithy_decompress,      NULL,                    NULL }, // decompression error (returns 0)
+    { "ppmd8",      "ppmd8 24.09",              1,   9,   0, C_TS,                  0,            0, lzbench_ppmd_compress,       lzbench_ppmd_decompress,       NULL,                    NULL },
+    { "quicklz",    "quicklz 1.5.0",            1,   3,   0, C_TS,                  LIMIT_UINT,   0, lzbench_quicklz_compress,    lzbench_quicklz_decompress,    NULL,                    NULL },
+    { "slz_deflate", "slz_deflate 1.2.1",        1,   3,   2, C_STR|C_TS,            0,            0, lzbench_slz_compress,        lzbench_slz_decompress,        NULL,                    NULL },
+    { "slz_gzip",   "slz_gzip 1.2.1",           1,   3,   1, C_STR|C_TS,            0,            0, lzbench_slz_compress,        lzbench_slz_decompress,        NULL,                    NULL },
+    { "slz_zlib",   "slz_zlib 1.2.1",           1,   3,   0, C_STR|C_TS,            0,            0, lzbench_slz_compress,        lzbench_slz_decompress,        NULL,                    NULL },
+    { "snappy",     "snappy 1.2.1",             0,   0,   0, C_TS,                  0,            0, lzbench_snappy_compress,     lzbench_snappy_decompress,     NULL,                    NULL },
+    { "tamp",       "tamp 1.3.1",               8,  15,   0, C_STR|C_TS,            0,            0, lzbench_tamp_compress,       lzbench_tamp_decompress,       lzbench_tamp_init,       lzbench_tamp_deinit },
+    { "tornado",    "tornado 0.6a",             1,  16,   0, 0,                     LIMIT_UINT,   0, lzbench_tornado_compress,    lzbench_tornado_decompress,    NULL,                    NULL },
+    { "ucl_nrv2b",  "ucl_nrv2b 1.03",           1,   9,   0, C_TS,                  LIMIT_UINT,   0, lzbench_ucl_nrv2b_compress,  lzbench_ucl_nrv2b_decompress,  NULL,                    NULL },
+    { "ucl_nrv2d",  "ucl_nrv2d 1.03",           1,   9,   0, C_TS,                  LIMIT_UINT,   0, lzbench_ucl_nrv2d_compress,  lzbench_ucl_nrv2d_decompress,  NULL,                    NULL },
+    { "ucl_nrv2e",  "ucl_nrv2e 1.03",           1,   9,   0, C_TS,                  LIMIT_UINT,   0, lzbench_ucl_nrv2e_compress,  lzbench_ucl_nrv2e_decompress,  NULL,                    NULL },
+    { "wflz",       "wflz 2015-09-16",          0,   0,   0, 0,                     LIMIT_UINT,   0, lzbench_wflz_compress,       lzbench_wflz_decompress,       lzbench_wflz_init,       lzbench_wflz_deinit }, // SEGFAULT on decompression with gcc 4.9+ -O3 on Ubuntu
+    { "xz",         "xz 5.6.3",                 0,   9,   0, C_STR|C_TS,            0,            0, lzbench_xz_compress,         lzbench_xz_decompress,         NULL,                    NULL },
+    { "yalz77",     "yalz77 2015-09-19",        1,  12,   0, C_TS,                  0,            0, lzbench_yalz77_compress,     lzbench_yalz77_decompress,     NULL,                    NULL },
+    { "yappy",      "yappy 2014-03-22",         1,  12,   0, 0,                     0,            0, lzbench_yappy_compress,      lzbench_yappy_decompress,      lzbench_yappy_init,      NULL },
+    { "zlib",       "zlib 1.3.1",               1,   9,   0, C_STR|C_DIC|C_TS,      0,            0, lzbench_zlib_compress,       lzbench_zlib_decompress,       NULL,                    NULL },
+    { "zlib-ng",    "zlib-ng 2.2.3",            1,   9,   0, C_STR|C_DIC|C_TS,      0,            0, lzbench_zlib_ng_compress,    lzbench_zlib_ng_decompress,    NULL,                    NULL },
+    { "zling",      "zling 2018-10-12",         0,   4,   0, C_STR,                 0,            0, lzbench_zling_compress,      lzbench_zling_decompress,      NULL,                    NULL },
+    { "zstd",       "zstd 1.5.7",               1,  22,   0, C_STR|C_DIC|C_TS,      0,            0, lzbench_zstd_compress,       lzbench_zstd_decompress,       lzbench_zstd_init,       lzbench_zstd_deinit },
+    { "zstd22",     "zstd 1.5.7 -d22",         16,  22,  22, C_STR|C_DIC|C_TS,      0,            0, lzbench_zstd_compress,       lzbench_zstd_decompress,       lzbench_zstd_init,       lzbench_zstd_deinit },
+    { "zstd22LDM",  "zstd 1.5.7 --long -d22",  16,  22,  22, C_STR|C_DIC|C_TS,      0,            0, lzbench_zstd_LDM_compress,   lzbench_zstd_decompress,       lzbench_zstd_LDM_init,   lzbench_zstd_deinit },
+    { "zstd24",     "zstd 1.5.7 -d24",         16,  22,  24, C_STR|C_DIC|C_TS,      0,            0, lzbench_zstd_compress,       lzbench_zstd_decompress,       lzbench_zstd_init,       lzbench_zstd_deinit },
+    { "zstd24LDM",  "zstd 1.5.7 --long -d24",  16,  22,  24, C_STR|C_DIC|C_TS,      0,            0, lzbench_zstd_LDM_compress,   lzbench_zstd_decompress,       lzbench_zstd_LDM_init,   lzbench_zstd_deinit },
+    { "zstdLDM",    "zstd 1.5.7 --long",        1,  22,   0, C_STR|C_DIC|C_TS,      0,            0, lzbench_zstd_LDM_compress,   lzbench_zstd_decompress,       lzbench_zstd_LDM_init,   lzbench_zstd_deinit },
+    { "zstd_fast",  "zstd 1.5.7 --fast",       -5,  -1,   0, C_STR|C_DIC|C_TS,      0,            0, lzbench_zstd_compress,       lzbench_zstd_decompress,       lzbench_zstd_init,       lzbench_zstd_deinit },
 };
 
 const long int LZBENCH_COMPRESSOR_COUNT = sizeof(comp_desc)/sizeof(comp_desc[0]);
@@ -293,4 +432,115 @@ static const alias_desc_t alias_desc[] =
 
 const long int LZBENCH_ALIASES_COUNT = sizeof(alias_desc)/sizeof(alias_desc[0]);
 
+
+// lzbench.cpp
+int istrcmp(const char *str1, const char *str2);
+void format(std::string& s, const char* formatstring, ...);
+std::vector<std::string> split(const std::string &text, char sep);
+void print_header(lzbench_params_t *params);
+void print_speed(lzbench_params_t *params, string_table_t& row);
+void print_time(lzbench_params_t *params, string_table_t& row);
+void print_stats(lzbench_params_t *params, const compressor_desc_t* desc, int level, const codec_kv_t& kv, size_t chunk_size, std::vector<size_t> &chunk_sizes, std::vector<uint64_t> &citers, std::vector<uint64_t> &diters, std::vector<uint64_t> &cloops, std::vector<uint64_t> &dloops, size_t insize, size_t outsize, bool comp_error, bool decomp_error, bool cached);
+std::string format_chunk_size(uint64_t chunk_size);
+double lzbench_speed(uint64_t size, uint64_t nanosec);
+std::string json_string(const std::string& text);
+void *alloc_and_touch(size_t size, bool must_zero);
+void lzbench_expand_codec_list(lzbench_params_t *params, const char *namesWithParams, std::vector<codec_candidate_t>& out);
+void lzbench_process_mem_blocks(lzbench_params_t *params, std::vector<size_t> &file_sizes, const char *namesWithParams, uint8_t *inbuf, size_t insize, bench_rate_t rate);
+void lzbench_process_single_codec(lzbench_params_t *params, size_t max_chunk_size, std::vector<size_t> &chunk_sizes, const compressor_desc_t* desc, int level, const codec_kv_t& kv, uint8_t *inbuf, size_t insize, uint8_t *compbuf, size_t comprsize, uint8_t *decomp, bench_rate_t rate, int param1);
+char* cpu_brand_string(void);
+const char* lzbench_compiler();
+const char* lzbench_build_flags();
+
+// pareto.cpp
+bool pareto_dominates(const string_table_t& a, const string_table_t& b);
+std::vector<int> pareto_ranks(const std::vector<string_table_t>& rows);
+bool pareto_parse_query(const char* text, pareto_query_t& query);
+void pareto_recommend(const pareto_query_t& q, const std::vector<string_table_t>& rows);
+void pareto_recommend_json(const pareto_query_t& q, const std::vector<string_table_t>& rows, const char* key);
+void pareto_report(lzbench_params_t *params);
+
+// report.cpp
+void lzbench_html_report(lzbench_params_t *params);
+
+// datagen.cpp
+std::string lzbench_gen_spec(const char* text, uint64_t* size);
+void lzbench_generate(const char* text, uint8_t* buf);
+
+// decode.cpp
+bool lzbench_decode_format_valid(const char* format);
+int lzbench_decode(lzbench_params_t *params, const char** inFileNames, unsigned ifnIdx, char* encoder_list, const char* format);
+
+// sample.cpp
+int lzbench_sample(lzbench_params_t *params, const char** inFileNames, unsigned ifnIdx, char* encoder_list);
+
+// classify.cpp
+const char* lzbench_classify(const uint8_t* inbuf, size_t insize);
+void lzbench_classify_report(lzbench_params_t *params);
+
+// fallback.cpp
+bool lzbench_store_parse(const char* method, lzbench_params_t *params);
+bool lzbench_store_detect(lzbench_params_t *params, const uint8_t* chunk, size_t size);
+void lzbench_store_measure(lzbench_params_t *params, size_t chunk_size, std::vector<size_t> &chunk_sizes, uint8_t *inbuf, bench_rate_t rate);
+void lzbench_store_report(lzbench_params_t *params);
+
+// dedup.cpp
+uint8_t* lzbench_dedup(lzbench_params_t *params, std::vector<size_t> &file_sizes, const uint8_t *inbuf, size_t insize, std::vector<size_t> &unique_sizes, size_t& unique_size, bench_rate_t rate);
+void lzbench_dedup_report(lzbench_params_t *params);
+
+// page.cpp
+bool lzbench_page_parse(const char* text, lzbench_params_t *params);
+void lzbench_page_measure(lzbench_params_t *params, const string_table_t& row, const compressor_desc_t* desc, codec_options_t *codec_options, std::vector<size_t> &chunk_sizes, uint8_t *inbuf, uint8_t *compbuf, uint8_t *decomp, bench_rate_t rate);
+void lzbench_page_report(lzbench_params_t *params);
+
+// solid.cpp
+void lzbench_solid_buckets(lzbench_params_t *params, const string_table_t& row, const compressor_desc_t* desc, codec_options_t *codec_options, const uint8_t *inbuf);
+void lzbench_solid_report(lzbench_params_t *params, const std::string& independent, const std::string& solid);
+
+// dict.cpp
+bool lzbench_dict_train_spec_valid(const char* text);
+bool lzbench_dict_size_parse(const char* text, size_t* dict_size);
+int lzbench_dict_train(lzbench_params_t *params, const char** inFileNames, unsigned ifnIdx, const char* spec_text);
+int lzbench_dict(lzbench_params_t *params, const char** inFileNames, unsigned ifnIdx, char* encoder_list, size_t dict_size, const char* dict_file);
+
+// stream.cpp
+bool lzbench_stream_spec_valid(const char* text);
+int lzbench_stream(lzbench_params_t *params, const char** inFileNames, unsigned ifnIdx, char* encoder_list, const char* spec_text);
+
+// parse.cpp
+int lzbench_parse(lzbench_params_t *params, const char** inFileNames, unsigned ifnIdx, char* encoder_list);
+
+// profile.cpp
+void lzbench_profile_chunks(lzbench_params_t *params, string_table_t& row, const compressor_desc_t* desc, codec_options_t *codec_options, std::vector<size_t> &chunk_sizes, uint8_t *inbuf, uint8_t *compbuf, uint8_t *decomp, bench_rate_t rate);
+void lzbench_profile_summarize(const string_table_t& row, profile_summary_t& summary);
+int lzbench_profile_report(lzbench_params_t *params);
+
+// corpus.cpp
+void lzbench_corpus_report(lzbench_params_t *params);
+
+// sweep.cpp
+bool lzbench_sweep_floor_parse(const char* text, lzbench_params_t *params);
+void lzbench_sweep_report(lzbench_params_t *params);
+
+// results.cpp
+int lzbench_save_results(lzbench_params_t *params, const char* filename);
+int lzbench_load_results(const char* filename, std::vector<string_table_t>& rows);
+void lzbench_compare_baseline(lzbench_params_t *params);
+
+// db.cpp
+uint64_t lzbench_db_hash(const uint8_t* inbuf, size_t insize, const std::vector<size_t>& file_sizes);
+bool lzbench_db_lookup(lzbench_params_t *params, const std::string& name_version, int level, const std::string& codec_params, uint64_t chunk_size, uint64_t& comprsize, std::vector<uint64_t>& citers, std::vector<uint64_t>& diters, std::vector<uint64_t>& cloops, std::vector<uint64_t>& dloops);
+void lzbench_db_record(lzbench_params_t *params, const std::string& name_version, int level, const std::string& codec_params, uint64_t chunk_size, uint64_t origsize, uint64_t comprsize, std::vector<uint64_t>& citers, std::vector<uint64_t>& diters, std::vector<uint64_t>& cloops, std::vector<uint64_t>& dloops);
+
+// search.cpp
+void lzbench_search(lzbench_params_t *params, std::vector<size_t> &chunk_sizes, const char *namesWithParams, uint8_t *inbuf, size_t insize, uint8_t *compbuf, size_t comprsize, uint8_t *decomp, bench_rate_t rate);
+
+// registry.cpp
+const std::vector<compressor_desc_t>& lzbench_codecs();
+const compressor_desc_t* lzbench_find_codec(const char* name);
+size_t lzbench_max_padding();
+std::string lzbench_caps_string(const compressor_desc_t* desc);
+int lzbench_load_plugins(lzbench_params_t *params, const char* dir);
+void lzbench_unload_plugins();
+
 #endif
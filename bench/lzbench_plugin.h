@@ -0,0 +1,161 @@
+/*
+ * Copyright (c) Przemyslaw Skibinski <inikep@gmail.com>
+ * All rights reserved.
+ *
+ * This source code is dual-licensed under the GPLv2 and GPLv3 licenses.
+ * For additional details, refer to the LICENSE file located in the root
+ * directory of this source tree.
+ *
+ * lzbench_plugin.h: stable C ABI shared by built-in codecs and codec plugins
+ *
+ * A plugin is a shared library placed in the directory given with --plugins=DIR.
+ * It exports a single C function named LZBENCH_PLUGIN_ENTRY that returns a
+ * description of its codecs, e.g.:
+ *
+ *   #include "lzbench_plugin.h"
+ *
+ *   static int64_t my_compress(char *in, size_t insize, char *out, size_t outsize, codec_options_t *opt) { ... }
+ *   static int64_t my_decompress(char *in, size_t insize, char *out, size_t outsize, codec_options_t *opt) { ... }
+ *
+ *   static const lzbench_plugin_codec_t my_codecs[] = {
+ *       { "mycodec", "mycodec 1.0", 1, 9, 0, LZBENCH_CAP_THREAD_SAFE, 0, 0, my_compress, my_decompress, NULL, NULL },
+ *   };
+ *
+ *   LZBENCH_PLUGIN_EXPORT const lzbench_plugin_t* lzbench_plugin_register(void)
+ *   {
+ *       static const lzbench_plugin_t plugin = { LZBENCH_PLUGIN_ABI_VERSION, 1, my_codecs };
+ *       return &plugin;
+ *   }
+ *
+ * The functions have exactly the same semantics as the built-in wrappers in
+ * bench/codecs.h: compress/decompress return the number of produced bytes
+ * or a value <= 0 on error, init returns work memory passed in codec_options_t.
+ * Parameters given with -ecodec,level:key=value are read with lzbench_param_*().
+ */
+
+#ifndef LZBENCH_PLUGIN_H
+#define LZBENCH_PLUGIN_H
+
+#include <stddef.h> // size_t
+#include <stdint.h> // int64_t
+
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+#define LZBENCH_PLUGIN_ABI_VERSION 1
+#define LZBENCH_PLUGIN_ENTRY "lzbench_plugin_register"
+
+#if defined(_WIN32)
+    #define LZBENCH_PLUGIN_EXPORT __declspec(dllexport)
+#else
+    #define LZBENCH_PLUGIN_EXPORT __attribute__((visibility("default")))
+#endif
+
+
+/* codec capabilities */
+#define LZBENCH_CAP_STREAMING       (1U << 0)  /* library offers a streaming API with history across calls */
+#define LZBENCH_CAP_DICTIONARY      (1U << 1)  /* library accepts a user-provided dictionary */
+#define LZBENCH_CAP_THREAD_SAFE     (1U << 2)  /* compress/decompress may run concurrently with separate work memory */
+#define LZBENCH_CAP_NATIVE_THREADS  (1U << 3)  /* library can spawn its own worker threads (disabled in lzbench) */
+
+
+/* A codec parameter given as key=value after the level, e.g. -ezstd,3:wlog=27:strategy=btopt */
+typedef struct
+{
+    const char* key;
+    const char* value;     /* always set */
+    int64_t ivalue;        /* numeric value if is_int */
+    int is_int;
+    int used;              /* set by lzbench_param_*() to report parameters ignored by a codec */
+} codec_param_t;
+
+/* New fields are only ever appended to the end of this structure. */
+typedef struct
+{
+    int level;
+    int additional_param;
+    char* work_mem;
+//    int threads;
+    int param_count;
+    codec_param_t* params;
+} codec_options_t;
+
+
+static inline codec_param_t* lzbench_param_find(codec_options_t *codec_options, const char* key)
+{
+    int i;
+    for (i = 0; i < codec_options->param_count; i++) {
+        const char *a = codec_options->params[i].key, *b = key;
+        while (*a && *a == *b) a++, b++;
+        if (*a == *b) {
+            codec_options->params[i].used = 1;
+            return &codec_options->params[i];
+        }
+    }
+    return NULL;
+}
+
+/* returns the numeric value of key, or def if the key was not given or is not a number */
+static inline int64_t lzbench_param_int(codec_options_t *codec_options, const char* key, int64_t def)
+{
+    codec_param_t* p = lzbench_param_find(codec_options, key);
+    return (p && p->is_int) ? p->ivalue : def;
+}
+
+static inline const char* lzbench_param_str(codec_options_t *codec_options, const char* key, const char* def)
+{
+    codec_param_t* p = lzbench_param_find(codec_options, key);
+    return p ? p->value : def;
+}
+
+/* maps a symbolic value to its index in names[] (NULL-terminated), a numeric value is returned as is, def if missing, -1 if unknown */
+static inline int64_t lzbench_param_enum(codec_options_t *codec_options, const char* key, const char* const* names, int64_t def)
+{
+    int64_t i;
+    codec_param_t* p = lzbench_param_find(codec_options, key);
+    if (!p) return def;
+    if (p->is_int) return p->ivalue;
+    for (i = 0; names[i]; i++) {
+        const char *a = names[i], *b = p->value;
+        while (*a && *a == *b) a++, b++;
+        if (*a == *b) return i;
+    }
+    return -1;
+}
+
+
+typedef int64_t (*lzbench_plugin_compress_t)(char *in, size_t insize, char *out, size_t outsize, codec_options_t *codec_options);
+typedef char* (*lzbench_plugin_init_t)(size_t insize, size_t level, size_t additional_param);
+typedef void (*lzbench_plugin_deinit_t)(char* workmem);
+
+typedef struct
+{
+    const char* name;            /* name used with -e */
+    const char* name_version;    /* name printed in results */
+    int first_level;
+    int last_level;
+    int additional_param;        /* passed to init and codec_options_t */
+    uint32_t flags;              /* LZBENCH_CAP_* */
+    uint64_t max_insize;         /* the largest supported input in bytes (larger chunks are split), 0 = unlimited */
+    uint32_t padding;            /* bytes required after the end of input and output buffers */
+    lzbench_plugin_compress_t compress;
+    lzbench_plugin_compress_t decompress;
+    lzbench_plugin_init_t init;      /* optional */
+    lzbench_plugin_deinit_t deinit;  /* optional */
+} lzbench_plugin_codec_t;
+
+typedef struct
+{
+    uint32_t abi_version;        /* LZBENCH_PLUGIN_ABI_VERSION */
+    uint32_t codec_count;
+    const lzbench_plugin_codec_t* codecs;
+} lzbench_plugin_t;
+
+typedef const lzbench_plugin_t* (*lzbench_plugin_entry_t)(void);
+
+#if defined (__cplusplus)
+}
+#endif
+
+#endif // LZBENCH_PLUGIN_H
@@ -11,6 +11,91 @@
 
 #include "codecs.h"
 #include <stdio.h> // FILE
+#include <stdlib.h>
+#include <string.h>
+
+
+#if !defined(BENCH_REMOVE_LZ4) && !defined(BENCH_REMOVE_ZSTD)
+/*
+ * auto: a meta-codec that picks store, lz4, zstd -1 or zstd -6 for every chunk and writes
+ * a 1-byte tag before the payload. The chunk is sampled by the --store-fallback detectors
+ * (fallback.cpp): data with high order-0 entropy or that lz4 cannot shrink is stored, otherwise
+ * the level sets the speed target:
+ *   1  fastest   lz4
+ *   2  balanced  zstd -1 for skewed byte distributions (literals gain from Huffman), else lz4
+ *   3  strong    zstd -6 for skewed byte distributions, else zstd -1
+ * A chunk that does not shrink with the chosen codec is stored as well.
+ */
+#define AUTO_SKEWED        6.5    // bits per byte
+
+enum { AUTO_STORE, AUTO_LZ4, AUTO_ZSTD1, AUTO_ZSTD6 };
+
+char* lzbench_auto_init(size_t insize, size_t level, size_t)
+{
+    return lzbench_zstd_init(insize, level, 0);
+}
+
+void lzbench_auto_deinit(char* workmem)
+{
+    lzbench_zstd_deinit(workmem);
+}
+
+static int auto_choose(const uint8_t* in, size_t insize, int level)
+{
+    double entropy = lzbench_sample_entropy(in, insize);
+
+    if (entropy >= STORE_MIN_ENTROPY || lzbench_sample_lz4_incompressible(in, insize)) return AUTO_STORE;
+
+    if (level <= 1) return AUTO_LZ4;
+    if (level == 2) return (entropy < AUTO_SKEWED) ? AUTO_ZSTD1 : AUTO_LZ4;
+    return (entropy < AUTO_SKEWED) ? AUTO_ZSTD6 : AUTO_ZSTD1;
+}
+
+int64_t lzbench_auto_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, codec_options_t *codec_options)
+{
+    codec_options_t options = { 0, 0, codec_options->work_mem, 0, NULL };
+    int64_t clen = 0;
+    int tag;
+
+    if (outsize < insize + 1) return 0;
+    tag = (insize == 0) ? AUTO_STORE : auto_choose((const uint8_t*)inbuf, insize, codec_options->level);
+
+    if (tag == AUTO_LZ4)
+        clen = lzbench_lz4_compress(inbuf, insize, outbuf + 1, outsize - 1, &options);
+    else if (tag != AUTO_STORE) {
+        options.level = (tag == AUTO_ZSTD1) ? 1 : 6;
+        clen = lzbench_zstd_compress(inbuf, insize, outbuf + 1, outsize - 1, &options);
+    }
+    if (clen <= 0 || (size_t)clen >= insize) {
+        tag = AUTO_STORE;
+        memcpy(outbuf + 1, inbuf, insize);
+        clen = insize;
+    }
+    outbuf[0] = (char)tag;
+    return clen + 1;
+}
+
+int64_t lzbench_auto_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, codec_options_t *codec_options)
+{
+    codec_options_t options = { 0, 0, codec_options->work_mem, 0, NULL };
+
+    if (insize < 1) return 0;
+    switch (inbuf[0])
+    {
+        case AUTO_STORE:
+            if (insize - 1 > outsize) return 0;
+            memcpy(outbuf, inbuf + 1, insize - 1);
+            return insize - 1;
+        case AUTO_LZ4:
+            return lzbench_lz4_decompress(inbuf + 1, insize - 1, outbuf, outsize, &options);
+        case AUTO_ZSTD1:
+        case AUTO_ZSTD6:
+            return lzbench_zstd_decompress(inbuf + 1, insize - 1, outbuf, outsize, &options);
+    }
+    return 0;
+}
+#endif
+
 
 
 #ifndef BENCH_REMOVE_GLZA
@@ -0,0 +1,181 @@
+/*
+ * Copyright (c) Przemyslaw Skibinski <inikep@gmail.com>
+ * All rights reserved.
+ *
+ * This source code is dual-licensed under the GPLv2 and GPLv3 licenses.
+ * For additional details, refer to the LICENSE file located in the root
+ * directory of this source tree.
+ *
+ * page.cpp: page compression as done by zram/zswap and database page compression (--pages)
+ *
+ * The input is split into independent pages (-b is set to the page size) and after the regular
+ * measurement of a codec every full page is handled like zram does: pages filled with a single
+ * repeated 8-byte word are only recorded, other pages are compressed and decompressed separately
+ * (the best of PAGE_RUNS runs for the latency of each page). The report gives latency percentiles,
+ * the share of pages that fit in half a page or in the given number of 512 B sectors and the
+ * memory saved with the zram rules (pages compressed to more than 3/4 of the page are stored raw)
+ * and the disk space saved by punching holes of whole sectors.
+ */
+
+#include "lzbench.h"
+#include <algorithm> // sort
+#include <string.h>
+
+#define PAGE_RUNS 3
+#define PAGE_SECTOR 512
+
+
+bool lzbench_page_parse(const char* text, lzbench_params_t *params)
+{
+    char* end;
+    unsigned long kb = text ? strtoul(text, &end, 10) : 4;
+    unsigned long sectors = 0;
+
+    if (text && *end == ',') sectors = strtoul(end + 1, &end, 10);
+    if ((text && *end != 0) || kb < 1 || kb > 64 || (kb & (kb - 1))) {
+        fprintf(stderr, "--pages: expected KB[,SECTORS] with a page size of 1, 2, 4 ... 64 KB\n");
+        return false;
+    }
+    params->page_size = kb << 10;
+    params->page_sectors = sectors ? sectors : params->page_size / PAGE_SECTOR - 1;
+    if (params->page_sectors >= params->page_size / PAGE_SECTOR) {
+        fprintf(stderr, "--pages: a %lu KB page has %d sectors, SECTORS must be lower\n", kb, (int)(params->page_size / PAGE_SECTOR));
+        return false;
+    }
+    return true;
+}
+
+
+// zram same-filled pages: a single word repeated over the whole page
+static bool same_filled(const uint8_t* page, size_t size)
+{
+    uint64_t first, word;
+    memcpy(&first, page, sizeof(first));
+    for (size_t i=sizeof(word); i<size; i+=sizeof(word))
+    {
+        memcpy(&word, page + i, sizeof(word));
+        if (word != first) return false;
+    }
+    return true;
+}
+
+
+static double percentile(const std::vector<uint64_t>& sorted, double p)
+{
+    if (sorted.empty()) return 0;
+    return sorted[(size_t)(p * (sorted.size() - 1) + 0.5)] / 1000.0;
+}
+
+
+/*
+ * Measures every full page of inbuf with the codec that has just been benchmarked; a tail
+ * shorter than a page (of every file with -j) is left out. Pages that fail stop the measurement,
+ * as the row already reports the error.
+ */
+void lzbench_page_measure(lzbench_params_t *params, const string_table_t& row, const compressor_desc_t* desc, codec_options_t *codec_options, std::vector<size_t> &chunk_sizes, uint8_t *inbuf, uint8_t *compbuf, uint8_t *decomp, bench_rate_t rate)
+{
+    bench_timer_t start_ticks, end_ticks;
+    const size_t page = params->page_size;
+    std::vector<uint64_t> ctimes, dtimes;
+    page_stats_t s;
+    uint8_t* p = inbuf;
+
+    s.pages = s.same_filled = s.half = s.sectors_fit = s.zram_size = s.disk_size = 0;
+    s.name = row.col1_algname;
+    s.filename = row.col6_filename;
+    for (size_t i=0; i<chunk_sizes.size(); p += chunk_sizes[i++])
+    {
+        if (chunk_sizes[i] != page) continue;
+        s.pages++;
+        if (same_filled(p, page)) {
+            s.same_filled++;
+            s.half++;
+            s.sectors_fit++;
+            continue;
+        }
+
+        uint64_t ctime = 0, dtime = 0;
+        int64_t clen = 0, dlen;
+        for (int r=0; r<PAGE_RUNS; r++)
+        {
+            GetTime(start_ticks);
+            clen = desc->compress((char*)p, page, (char*)compbuf, GET_COMPRESS_BOUND(page), codec_options);
+            GetTime(end_ticks);
+            if (clen <= 0) {
+                LZBENCH_PRINT(0, "ERROR in %s: --pages compression error at offset %llu\n", desc->name, (unsigned long long)(p - inbuf));
+                return;
+            }
+            uint64_t nanosec = GetDiffTime(rate, start_ticks, end_ticks);
+            if (r == 0 || nanosec < ctime) ctime = nanosec;
+        }
+        for (int r=0; r<PAGE_RUNS && !params->compress_only; r++)
+        {
+            GetTime(start_ticks);
+            dlen = desc->decompress((char*)compbuf, clen, (char*)decomp, page, codec_options);
+            GetTime(end_ticks);
+            if (dlen != (int64_t)page || memcmp(p, decomp, page) != 0) {
+                LZBENCH_PRINT(0, "ERROR in %s: --pages decompression error at offset %llu\n", desc->name, (unsigned long long)(p - inbuf));
+                return;
+            }
+            uint64_t nanosec = GetDiffTime(rate, start_ticks, end_ticks);
+            if (r == 0 || nanosec < dtime) dtime = nanosec;
+        }
+        ctimes.push_back(ctime);
+        if (!params->compress_only) dtimes.push_back(dtime);
+
+        size_t sectors = (clen + PAGE_SECTOR - 1) / PAGE_SECTOR;
+        if ((size_t)clen <= page / 2) s.half++;
+        if (sectors <= params->page_sectors) {
+            s.sectors_fit++;
+            s.disk_size += sectors * PAGE_SECTOR;
+        } else
+            s.disk_size += page;
+        s.zram_size += ((size_t)clen > page / 4 * 3) ? page : clen;
+    }
+    if (s.pages == 0) return;
+
+    std::sort(ctimes.begin(), ctimes.end());
+    std::sort(dtimes.begin(), dtimes.end());
+    s.c_p50 = percentile(ctimes, 0.5);
+    s.c_p99 = percentile(ctimes, 0.99);
+    s.c_max = percentile(ctimes, 1);
+    s.d_p50 = percentile(dtimes, 0.5);
+    s.d_p99 = percentile(dtimes, 0.99);
+    s.d_max = percentile(dtimes, 1);
+    params->page_stats.push_back(s);
+}
+
+
+void lzbench_page_report(lzbench_params_t *params)
+{
+    const size_t page = params->page_size;
+
+    if (params->textformat != NDJSON)
+        printf("\nPages of %d KB (zram: same-filled pages are not compressed, pages compressed above %d bytes are stored raw):\n",
+               (int)(page >> 10), (int)(page / 4 * 3));
+
+    for (size_t i=0; i<params->page_stats.size(); i++)
+    {
+        const page_stats_t& s = params->page_stats[i];
+        uint64_t size = s.pages * page;
+        double zram_saved = (1 - (double)s.zram_size / size) * 100, disk_saved = (1 - (double)s.disk_size / size) * 100;
+
+        if (params->textformat == NDJSON) {
+            printf("{\"type\":\"pages\",\"name\":%s,\"file\":%s,\"page_size\":%d,\"pages\":%llu,\"same_filled\":%llu,\"fit_half\":%llu,\"sectors\":%d,\"fit_sectors\":%llu",
+                   json_string(s.name).c_str(), json_string(s.filename).c_str(), (int)page, (unsigned long long)s.pages, (unsigned long long)s.same_filled,
+                   (unsigned long long)s.half, (int)params->page_sectors, (unsigned long long)s.sectors_fit);
+            printf(",\"memory_saved_pct\":%.2f,\"disk_saved_pct\":%.2f,\"clat_us\":[%.3f,%.3f,%.3f],\"dlat_us\":[%.3f,%.3f,%.3f]}\n",
+                   zram_saved, disk_saved, s.c_p50, s.c_p99, s.c_max, s.d_p50, s.d_p99, s.d_max);
+            continue;
+        }
+
+        printf("%s on %s: %llu pages, same-filled %.1f%%, fit in half %.1f%%, in %d sectors %.1f%%, memory saved %.1f%%, disk saved %.1f%%\n",
+               s.name.c_str(), s.filename.c_str(), (unsigned long long)s.pages, s.same_filled * 100.0 / s.pages,
+               s.half * 100.0 / s.pages, (int)params->page_sectors, s.sectors_fit * 100.0 / s.pages, zram_saved, disk_saved);
+        if (s.pages == s.same_filled) continue;
+        printf("  latency p50/p99/max: compression %.2f / %.2f / %.2f us", s.c_p50, s.c_p99, s.c_max);
+        if (!params->compress_only)
+            printf(", decompression %.2f / %.2f / %.2f us", s.d_p50, s.d_p99, s.d_max);
+        printf("\n");
+    }
+}
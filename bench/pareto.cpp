@@ -0,0 +1,290 @@
+/*
+ * Copyright (c) Przemyslaw Skibinski <inikep@gmail.com>
+ * All rights reserved.
+ *
+ * This source code is dual-licensed under the GPLv2 and GPLv3 licenses.
+ * For additional details, refer to the LICENSE file located in the root
+ * directory of this source tree.
+ *
+ * pareto.cpp: Pareto dominance over compression speed, decompression speed and ratio,
+ *            the Pareto frontier report (--pareto) and codec recommendations (--recommend)
+ */
+
+#include "lzbench.h"
+#include <algorithm> // find
+#include <stdlib.h> // strtod
+
+
+/*
+ * Rows are compared by compressed/original size and by times, so rows measured on
+ * different inputs must not be mixed. A time of 0 (error or --compress-only) is the worst value.
+ */
+static inline double row_ratio(const string_table_t& r) { return r.col5_origsize ? (double)r.col4_comprsize / r.col5_origsize : 1.0; }
+static inline double row_speed(uint64_t origsize, uint64_t nanosec) { return nanosec ? (double)origsize / nanosec : 0.0; }
+
+
+bool pareto_dominates(const string_table_t& a, const string_table_t& b)
+{
+    double ra = row_ratio(a), rb = row_ratio(b);
+    double ca = row_speed(a.col5_origsize, a.col2_ctime), cb = row_speed(b.col5_origsize, b.col2_ctime);
+    double da = row_speed(a.col5_origsize, a.col3_dtime), db = row_speed(b.col5_origsize, b.col3_dtime);
+
+    if (ra > rb || ca < cb || da < db) return false;
+    return ra < rb || ca > cb || da > db;
+}
+
+
+/*
+ * Non-dominated sorting: rank 0 is the Pareto frontier, rank 1 the frontier of the remaining rows, etc.
+ */
+std::vector<int> pareto_ranks(const std::vector<string_table_t>& rows)
+{
+    std::vector<int> rank(rows.size(), -1);
+    size_t ranked = 0;
+
+    for (int front = 0; ranked < rows.size(); front++)
+    {
+        std::vector<size_t> current;
+        for (size_t i=0; i<rows.size(); i++)
+        {
+            if (rank[i] >= 0) continue;
+            bool dominated = false;
+            for (size_t j=0; j<rows.size() && !dominated; j++)
+                dominated = (j != i) && rank[j] < 0 && pareto_dominates(rows[j], rows[i]);
+            if (!dominated) current.push_back(i);
+        }
+        for (size_t k=0; k<current.size(); k++)
+            rank[current[k]] = front;
+        ranked += current.size();
+    }
+    return rank;
+}
+
+
+static const char* metric_names[] = { "cspeed", "dspeed", "ratio" };
+
+// speeds in MB/s as printed by print_speed(), ratio as original/compressed size; 0 for errors
+static double row_metric(const string_table_t& r, pareto_metric_e metric)
+{
+    switch (metric)
+    {
+        case P_CSPEED: return r.col2_ctime ? r.col5_origsize * 1000.0 / r.col2_ctime : 0;
+        case P_DSPEED: return r.col3_dtime ? r.col5_origsize * 1000.0 / r.col3_dtime : 0;
+        default:       return r.col4_comprsize ? (double)r.col5_origsize / r.col4_comprsize : 0;
+    }
+}
+
+
+static bool parse_metric(const std::string& name, pareto_metric_e& metric)
+{
+    for (int i=0; i<3; i++)
+        if (istrcmp(name.c_str(), metric_names[i]) == 0) { metric = (pareto_metric_e)i; return true; }
+    return false;
+}
+
+
+/*
+ * GOAL[,COND]... where GOAL is cspeed, dspeed or ratio and COND is METRIC>=VALUE or METRIC<=VALUE,
+ * e.g. "ratio,dspeed>=2GB,cspeed>=200" or "dspeed,ratio>=3". Speeds are in MB/s unless followed by GB.
+ */
+bool pareto_parse_query(const char* text, pareto_query_t& query)
+{
+    std::vector<std::string> parts = split(text, ',');
+
+    query.text = text;
+    query.conds.clear();
+    if (!parse_metric(parts[0], query.goal)) {
+        fprintf(stderr, "--recommend: unknown goal \"%s\" (use cspeed, dspeed or ratio)\n", parts[0].c_str());
+        return false;
+    }
+
+    for (size_t i=1; i<parts.size(); i++)
+    {
+        pareto_cond_t cond;
+        size_t op = parts[i].find_first_of("<>");
+        char* end = NULL;
+
+        if (op == std::string::npos || op+1 >= parts[i].size() || parts[i][op+1] != '=' || !parse_metric(parts[i].substr(0, op), cond.metric)) {
+            fprintf(stderr, "--recommend: invalid condition \"%s\" (use e.g. dspeed>=2000 or ratio>=3)\n", parts[i].c_str());
+            return false;
+        }
+        cond.at_least = (parts[i][op] == '>');
+        cond.value = strtod(parts[i].c_str() + op + 2, &end);
+        if (end == parts[i].c_str() + op + 2) {
+            fprintf(stderr, "--recommend: missing value in \"%s\"\n", parts[i].c_str());
+            return false;
+        }
+        if (cond.metric != P_RATIO && (*end == 'G' || *end == 'g')) cond.value *= 1000;
+        query.conds.push_back(cond);
+    }
+    return true;
+}
+
+
+// how much a row misses a condition relative to its value, 0 if satisfied
+static double violation(const string_table_t& r, const pareto_cond_t& cond)
+{
+    double v = row_metric(r, cond.metric);
+    double miss = cond.at_least ? cond.value - v : v - cond.value;
+    return (miss > 0 && cond.value > 0) ? miss / cond.value : (miss > 0 ? 1 : 0);
+}
+
+
+static void print_metrics(const string_table_t& r)
+{
+    printf("%-23s ratio %5.2f  cspeed %8.2f MB/s  dspeed %8.2f MB/s", r.col1_algname.c_str(), row_metric(r, P_RATIO), row_metric(r, P_CSPEED), row_metric(r, P_DSPEED));
+}
+
+
+/*
+ * Returns the results that satisfy all conditions, the best by the goal first; if there are
+ * none, closest is the result that misses the conditions by the least (closest_miss).
+ */
+static std::vector<size_t> recommend(const pareto_query_t& q, const std::vector<string_table_t>& rows, size_t& closest, double& closest_miss)
+{
+    std::vector<size_t> ok;
+
+    closest = 0;
+    closest_miss = 0;
+    for (size_t i=0; i<rows.size(); i++)
+    {
+        double miss = 0;
+        for (size_t c=0; c<q.conds.size(); c++)
+            miss = MAX(miss, violation(rows[i], q.conds[c]));
+        if (miss == 0)
+            ok.push_back(i);
+        else if (closest_miss == 0 || miss < closest_miss)
+            closest = i, closest_miss = miss;
+    }
+
+    // stable selection sort by the goal, the first result is the recommendation
+    for (size_t i=0; i<ok.size(); i++)
+        for (size_t j=i+1; j<ok.size(); j++)
+            if (row_metric(rows[ok[j]], q.goal) > row_metric(rows[ok[i]], q.goal))
+                std::swap(ok[i], ok[j]);
+    return ok;
+}
+
+
+void pareto_recommend(const pareto_query_t& q, const std::vector<string_table_t>& rows)
+{
+    size_t closest;
+    double closest_miss;
+    std::vector<size_t> ok = recommend(q, rows, closest, closest_miss);
+
+    printf("\nRecommendation for %s (%s):\n", q.text.c_str(), rows[0].col6_filename.c_str());
+    if (ok.empty()) {
+        printf("  no result satisfies all conditions; the closest one misses by %.1f%%:\n  ", closest_miss * 100);
+        print_metrics(rows[closest]);
+        printf("\n");
+        return;
+    }
+
+    double best = row_metric(rows[ok[0]], q.goal);
+    printf("  best:      ");
+    print_metrics(rows[ok[0]]);
+    printf("\n");
+    for (size_t i=1; i<ok.size() && i<=2; i++)
+    {
+        double v = row_metric(rows[ok[i]], q.goal);
+        printf("  runner-up: ");
+        print_metrics(rows[ok[i]]);
+        printf("  %s %.1f%% lower\n", metric_names[q.goal], best > 0 ? (best - v) * 100 / best : 0);
+    }
+    if (ok.size() == 1)
+        printf("  no runner-up: %d of %d results violate the conditions\n", (int)(rows.size() - 1), (int)rows.size());
+}
+
+
+static std::string json_metrics(const string_table_t& r)
+{
+    std::string s;
+    format(s, "{\"name\":%s,\"ratio\":%.3f,\"cspeed\":%.2f,\"dspeed\":%.2f}", json_string(r.col1_algname).c_str(),
+           row_metric(r, P_RATIO), row_metric(r, P_CSPEED), row_metric(r, P_DSPEED));
+    return s;
+}
+
+
+// NDJSON record of a recommendation (the best result and up to two runners-up), rows are of one file or class named by key
+void pareto_recommend_json(const pareto_query_t& q, const std::vector<string_table_t>& rows, const char* key)
+{
+    size_t closest;
+    double closest_miss;
+    std::vector<size_t> ok = recommend(q, rows, closest, closest_miss);
+
+    printf("{\"type\":\"recommend\",\"query\":%s,\"%s\":%s", json_string(q.text).c_str(), key, json_string(rows[0].col6_filename).c_str());
+    if (ok.empty()) {
+        printf(",\"best\":null,\"closest\":%s,\"closest_miss_pct\":%.1f}\n", json_metrics(rows[closest]).c_str(), closest_miss * 100);
+        return;
+    }
+    printf(",\"best\":%s,\"runners_up\":[", json_metrics(rows[ok[0]]).c_str());
+    for (size_t i=1; i<ok.size() && i<=2; i++)
+        printf("%s%s", i > 1 ? "," : "", json_metrics(rows[ok[i]]).c_str());
+    printf("]}\n");
+}
+
+
+// NDJSON records of the frontier and of the recommendations
+static void pareto_json(lzbench_params_t *params, const std::vector<string_table_t>& rows)
+{
+    const std::string& file = rows[0].col6_filename;
+
+    if (params->pareto)
+    {
+        std::vector<int> rank = pareto_ranks(rows);
+        for (size_t k=0; k<rows.size(); k++)
+            if (rank[k] == 0)
+                printf("{\"type\":\"pareto\",\"file\":%s,\"result\":%s}\n", json_string(file).c_str(), json_metrics(rows[k]).c_str());
+    }
+
+    for (size_t q=0; q<params->recommend.size(); q++)
+        pareto_recommend_json(params->recommend[q], rows, "file");
+}
+
+
+/*
+ * Prints the Pareto frontier (--pareto) and answers --recommend queries separately for
+ * every input file, as speeds and ratios of different inputs are not comparable. With -o7
+ * they are printed as NDJSON records; -o4 (CSV) and -o8 (HTML) leave them out.
+ */
+void pareto_report(lzbench_params_t *params)
+{
+    std::vector<std::string> files;
+
+    for (size_t i=0; i<params->results.size(); i++)
+        if (std::find(files.begin(), files.end(), params->results[i].col6_filename) == files.end())
+            files.push_back(params->results[i].col6_filename);
+
+    for (size_t f=0; f<files.size(); f++)
+    {
+        std::vector<string_table_t> rows;
+        for (size_t i=0; i<params->results.size(); i++)
+            if (params->results[i].col6_filename == files[f] && params->results[i].col2_ctime)
+                rows.push_back(params->results[i]);
+        if (rows.empty()) continue;
+        if (params->textformat == NDJSON) {
+            pareto_json(params, rows);
+            continue;
+        }
+
+        if (params->pareto)
+        {
+            std::vector<int> rank = pareto_ranks(rows);
+            int frontier = 0;
+            for (size_t k=0; k<rank.size(); k++) frontier += (rank[k] == 0);
+            printf("\nPareto frontier for %s: %d of %d results\n", files[f].c_str(), frontier, (int)rows.size());
+            print_header(params);
+            for (size_t k=0; k<rows.size(); k++)
+            {
+                if (rank[k] != 0) continue;
+                if (params->show_speed)
+                    print_speed(params, rows[k]);
+                else
+                    print_time(params, rows[k]);
+            }
+        }
+
+        for (size_t q=0; q<params->recommend.size(); q++)
+            pareto_recommend(params->recommend[q], rows);
+    }
+}
@@ -0,0 +1,302 @@
+/*
+ * Copyright (c) Przemyslaw Skibinski <inikep@gmail.com>
+ * All rights reserved.
+ *
+ * This source code is dual-licensed under the GPLv2 and GPLv3 licenses.
+ * For additional details, refer to the LICENSE file located in the root
+ * directory of this source tree.
+ *
+ * parse.cpp: LZ77 parse statistics (--parse)
+ *
+ * Instead of a benchmark every -e codec/level parses the input and the shape of the parse is
+ * printed: histograms of match lengths, match offsets by cache distance, literal run lengths
+ * and the literal fraction. zstd sequences come from ZSTD_generateSequences(), lz4, lz4fast
+ * and lz4hc are walked on their compressed blocks. Other codecs are skipped.
+ */
+
+#include "lzbench.h"
+#include "util.h"
+#include <stdlib.h>
+#include <string.h>
+#if !defined(_WIN32)
+#include <unistd.h>  // sysconf
+#endif
+
+#ifndef BENCH_REMOVE_ZSTD
+#define ZSTD_STATIC_LINKING_ONLY
+#define ZSTD_DISABLE_DEPRECATE_WARNINGS
+#include "zstd/lib/zstd.h"
+#endif
+
+#define PARSE_DEFAULT_CODECS "zstd,1,3,9,19/lz4/lz4hc,4,9,12"
+#define PARSE_STEP           (16 << 20)  // the largest part parsed at once, bounds the memory for sequences
+#define PARSE_DEFAULT_LLC    (8 << 20)   // when the size of the last level cache is unknown
+#define PARSE_MLEN_BUCKETS   8
+#define PARSE_OFFSET_BUCKETS 4
+#define PARSE_LRUN_BUCKETS   6
+
+static const uint64_t mlen_edges[PARSE_MLEN_BUCKETS] = { 0, 4, 8, 16, 32, 64, 128, 256 };
+static const char* mlen_names[PARSE_MLEN_BUCKETS] = { "<4", "4-7", "8-15", "16-31", "32-63", "64-127", "128-255", "256+" };
+static const char* offset_names[PARSE_OFFSET_BUCKETS] = { "<32K", "<1M", "<LLC", ">=LLC" };
+static const uint64_t lrun_edges[PARSE_LRUN_BUCKETS] = { 0, 1, 4, 16, 64, 256 };
+static const char* lrun_names[PARSE_LRUN_BUCKETS] = { "0", "1-3", "4-15", "16-63", "64-255", "256+" };
+
+typedef struct
+{
+    std::string name;
+    uint64_t origsize, literals, matches, runs;
+    uint64_t mlen[PARSE_MLEN_BUCKETS], offset[PARSE_OFFSET_BUCKETS], lrun[PARSE_LRUN_BUCKETS];
+} parse_stats_t;
+
+
+static uint64_t llc_size()
+{
+#if defined(_SC_LEVEL3_CACHE_SIZE)
+    long size = sysconf(_SC_LEVEL3_CACHE_SIZE);
+    if (size > 0) return size;
+#endif
+    return PARSE_DEFAULT_LLC;
+}
+
+
+static int bucket(uint64_t value, const uint64_t* edges, int count)
+{
+    int b = 0;
+    while (b + 1 < count && value >= edges[b + 1]) b++;
+    return b;
+}
+
+
+static void add_sequence(parse_stats_t& s, uint64_t llc, uint64_t litlen, uint64_t mlen, uint64_t offset)
+{
+    s.literals += litlen;
+    s.runs++;
+    s.lrun[bucket(litlen, lrun_edges, PARSE_LRUN_BUCKETS)]++;
+    if (mlen == 0) return;
+
+    s.matches++;
+    s.mlen[bucket(mlen, mlen_edges, PARSE_MLEN_BUCKETS)]++;
+    s.offset[offset < (32 << 10) ? 0 : offset < (1 << 20) ? 1 : offset < llc ? 2 : 3]++;
+}
+
+
+#ifndef BENCH_REMOVE_ZSTD
+static bool parse_zstd(parse_stats_t& s, uint64_t llc, int level, const uint8_t* in, size_t insize)
+{
+    static ZSTD_CCtx* cctx = ZSTD_createCCtx();
+    std::vector<ZSTD_Sequence> seqs(ZSTD_sequenceBound(insize));
+
+    ZSTD_CCtx_reset(cctx, ZSTD_reset_session_and_parameters);
+    ZSTD_CCtx_setParameter(cctx, ZSTD_c_compressionLevel, level);
+    size_t count = ZSTD_generateSequences(cctx, &seqs[0], seqs.size(), in, insize);
+    if (ZSTD_isError(count)) return false;
+
+    for (size_t i=0; i<count; i++)
+    {
+        if (seqs[i].matchLength == 0 && seqs[i].litLength == 0) continue; // an empty block delimiter
+        add_sequence(s, llc, seqs[i].litLength, seqs[i].matchLength, seqs[i].offset);
+    }
+    return true;
+}
+#endif
+
+
+// walks a raw LZ4 block: token, literal length, literals, 2-byte offset, match length (+4)
+static bool parse_lz4_block(parse_stats_t& s, uint64_t llc, const uint8_t* ip, size_t size)
+{
+    const uint8_t* end = ip + size;
+
+    while (ip < end)
+    {
+        uint64_t litlen = *ip >> 4, mlen = *ip & 15;
+        ip++;
+        if (litlen == 15)
+            do { if (ip >= end) return false; litlen += *ip; } while (*ip++ == 255);
+        if ((uint64_t)(end - ip) < litlen) return false;
+        ip += litlen;
+        if (ip == end) { add_sequence(s, llc, litlen, 0, 0); break; } // the last literals
+        if (end - ip < 2) return false;
+        uint64_t offset = ip[0] | (ip[1] << 8);
+        ip += 2;
+        if (mlen == 15)
+            do { if (ip >= end) return false; mlen += *ip; } while (*ip++ == 255);
+        add_sequence(s, llc, litlen, mlen + 4, offset);
+    }
+    return true;
+}
+
+
+static bool is_lz4_block(const compressor_desc_t* desc)
+{
+    return !strcmp(desc->name, "lz4") || !strcmp(desc->name, "lz4fast") || !strcmp(desc->name, "lz4hc");
+}
+
+
+static std::string short_name(const codec_candidate_t& c)
+{
+    std::string s;
+    if (c.desc->first_level == 0 && c.desc->last_level == 0)
+        format(s, "%s", c.desc->name);
+    else
+        format(s, "%s -%d", c.desc->name, c.level);
+    return s;
+}
+
+
+// parses inbuf in -b chunks, chunks larger than PARSE_STEP are parsed in parts
+static bool parse_input(lzbench_params_t *params, const codec_candidate_t& c, uint64_t llc, const uint8_t* inbuf, size_t insize, parse_stats_t& s)
+{
+    size_t chunk_size = MIN(params->chunk_size, (size_t)PARSE_STEP);
+    std::vector<uint8_t> outbuf;
+    char* workmem = NULL;
+    bool ok = true;
+
+    if (is_lz4_block(c.desc)) {
+        outbuf.resize(GET_COMPRESS_BOUND(MIN(chunk_size, insize)));
+        if (c.desc->init) workmem = c.desc->init(chunk_size, c.level, c.desc->additional_param);
+    }
+    codec_options_t codec_options = { c.level, c.desc->additional_param, workmem, 0, NULL };
+
+    for (size_t pos=0; pos<insize && ok; pos+=chunk_size)
+    {
+        size_t part = MIN(chunk_size, insize - pos);
+#ifndef BENCH_REMOVE_ZSTD
+        if (!strcmp(c.desc->name, "zstd")) {
+            ok = parse_zstd(s, llc, c.level, inbuf + pos, part);
+            continue;
+        }
+#endif
+        int64_t clen = c.desc->compress((char*)inbuf + pos, part, (char*)&outbuf[0], outbuf.size(), &codec_options);
+        ok = clen > 0 && parse_lz4_block(s, llc, &outbuf[0], clen);
+    }
+
+    if (c.desc->deinit) c.desc->deinit(workmem);
+    return ok;
+}
+
+
+static void print_json_parse(const parse_stats_t& s, const char* filename, uint64_t llc)
+{
+    printf("{\"type\":\"parse\",\"name\":%s,\"file\":%s,\"orig_size\":%llu,\"llc\":%llu,\"literals\":%llu,\"matches\":%llu", json_string(s.name).c_str(),
+           json_string(filename).c_str(), (unsigned long long)s.origsize, (unsigned long long)llc, (unsigned long long)s.literals, (unsigned long long)s.matches);
+    printf(",\"match_length\":{");
+    for (int b=0; b<PARSE_MLEN_BUCKETS; b++) printf("%s\"%s\":%llu", b ? "," : "", mlen_names[b], (unsigned long long)s.mlen[b]);
+    printf("},\"offset\":{");
+    for (int b=0; b<PARSE_OFFSET_BUCKETS; b++) printf("%s\"%s\":%llu", b ? "," : "", offset_names[b], (unsigned long long)s.offset[b]);
+    printf("},\"literal_run\":{");
+    for (int b=0; b<PARSE_LRUN_BUCKETS; b++) printf("%s\"%s\":%llu", b ? "," : "", lrun_names[b], (unsigned long long)s.lrun[b]);
+    printf("}}\n");
+}
+
+
+// one column per parse: buckets are percentages of matches (lengths, offsets) or of literal runs
+static void print_parse_table(const std::vector<parse_stats_t>& stats, const char* filename, uint64_t llc)
+{
+    printf("\nParse statistics of %s (LLC = %llu KB):\n%-19s", filename, (unsigned long long)(llc >> 10), "");
+    for (size_t k=0; k<stats.size(); k++) printf(" %11s", stats[k].name.c_str());
+    printf("\n%-19s", "literal fraction");
+    for (size_t k=0; k<stats.size(); k++) printf(" %10.2f%%", stats[k].origsize ? stats[k].literals * 100.0 / stats[k].origsize : 0);
+    printf("\n%-19s", "matches");
+    for (size_t k=0; k<stats.size(); k++) printf(" %11llu", (unsigned long long)stats[k].matches);
+    printf("\n%-19s", "avg match length");
+    for (size_t k=0; k<stats.size(); k++) printf(" %11.2f", stats[k].matches ? (stats[k].origsize - stats[k].literals) / (double)stats[k].matches : 0);
+    printf("\n%-19s", "avg literal run");
+    for (size_t k=0; k<stats.size(); k++) printf(" %11.2f", stats[k].runs ? stats[k].literals / (double)stats[k].runs : 0);
+    printf("\n");
+
+    for (int b=0; b<PARSE_MLEN_BUCKETS; b++)
+    {
+        printf("match length %-6s", mlen_names[b]);
+        for (size_t k=0; k<stats.size(); k++) printf(" %10.2f%%", stats[k].matches ? stats[k].mlen[b] * 100.0 / stats[k].matches : 0);
+        printf("\n");
+    }
+    for (int b=0; b<PARSE_OFFSET_BUCKETS; b++)
+    {
+        printf("offset %-12s", offset_names[b]);
+        for (size_t k=0; k<stats.size(); k++) printf(" %10.2f%%", stats[k].matches ? stats[k].offset[b] * 100.0 / stats[k].matches : 0);
+        printf("\n");
+    }
+    for (int b=0; b<PARSE_LRUN_BUCKETS; b++)
+    {
+        printf("literal run %-7s", lrun_names[b]);
+        for (size_t k=0; k<stats.size(); k++) printf(" %10.2f%%", stats[k].runs ? stats[k].lrun[b] * 100.0 / stats[k].runs : 0);
+        printf("\n");
+    }
+}
+
+
+int lzbench_parse(lzbench_params_t *params, const char** inFileNames, unsigned ifnIdx, char* encoder_list)
+{
+    std::vector<codec_candidate_t> all, candidates;
+    uint64_t llc = llc_size();
+
+    lzbench_expand_codec_list(params, encoder_list ? encoder_list : PARSE_DEFAULT_CODECS, all);
+    for (size_t k=0; k<all.size(); k++)
+    {
+#ifndef BENCH_REMOVE_ZSTD
+        if (!strcmp(all[k].desc->name, "zstd")) { candidates.push_back(all[k]); continue; }
+#endif
+        if (is_lz4_block(all[k].desc)) candidates.push_back(all[k]);
+        else fprintf(stderr, "--parse: %s is not supported (use zstd, lz4, lz4fast or lz4hc), skipped\n", all[k].desc->name);
+    }
+    for (size_t k=0; k<candidates.size(); k++)
+        if (!candidates[k].kv.empty())
+            fprintf(stderr, "warning: --parse ignores parameters of %s\n", candidates[k].desc->name);
+    if (candidates.empty()) return 1;
+
+    for (unsigned i=0; i<ifnIdx; i++)
+    {
+        FILE* in;
+        if (UTIL_isDirectory(inFileNames[i])) {
+            fprintf(stderr, "warning: use -r to process directories (%s)\n", inFileNames[i]);
+            continue;
+        }
+        if (!(in = fopen(inFileNames[i], "rb"))) {
+            perror(inFileNames[i]);
+            continue;
+        }
+
+        fseeko(in, 0L, SEEK_END);
+        size_t insize = ftello(in);
+        rewind(in);
+        uint8_t* inbuf = (uint8_t*)alloc_and_touch(insize + lzbench_max_padding(), false);
+        if (!inbuf)
+        {
+            printf("Not enough memory!");
+            fclose(in);
+            return 3;
+        }
+        insize = fread(inbuf, 1, insize, in);
+        fclose(in);
+
+        const char* pch = strrchr(inFileNames[i], '\\');
+        const char* filename = pch ? pch+1 : inFileNames[i];
+        std::vector<parse_stats_t> stats;
+
+        for (size_t k=0; k<candidates.size(); k++)
+        {
+            parse_stats_t s;
+            memset(s.mlen, 0, sizeof(s.mlen));
+            memset(s.offset, 0, sizeof(s.offset));
+            memset(s.lrun, 0, sizeof(s.lrun));
+            s.name = short_name(candidates[k]);
+            s.origsize = insize;
+            s.literals = s.matches = s.runs = 0;
+
+            LZBENCH_STDERR(2, "%s parsing %s     \r", s.name.c_str(), filename);
+            if (!parse_input(params, candidates[k], llc, inbuf, insize, s)) {
+                fprintf(stderr, "%s: %s failed to parse the input, skipped\n", filename, s.name.c_str());
+                g_exit_result = 10;
+                continue;
+            }
+            if (params->textformat == NDJSON) print_json_parse(s, filename, llc);
+            else stats.push_back(s);
+        }
+
+        if (!stats.empty())
+            print_parse_table(stats, filename, llc);
+        free(inbuf);
+    }
+
+    return g_exit_result;
+}
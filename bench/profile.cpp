@@ -0,0 +1,230 @@
+/*
+ * Copyright (c) Przemyslaw Skibinski <inikep@gmail.com>
+ * All rights reserved.
+ *
+ * This source code is dual-licensed under the GPLv2 and GPLv3 licenses.
+ * For additional details, refer to the LICENSE file located in the root
+ * directory of this source tree.
+ *
+ * profile.cpp: compressibility and speed map across the input (--profile)
+ *
+ * After the regular measurement of a codec every -b chunk is compressed and decompressed
+ * separately (the best of PROFILE_RUNS runs) to get its compressed size and times. The report
+ * shows the share of chunks that hardly compress and the slowest 1% regions of the input;
+ * --profile=FILE writes all chunks as CSV and -o8 draws them over offsets.
+ */
+
+#include "lzbench.h"
+#include <algorithm> // sort
+#include <string.h>  // memcmp
+
+#define PROFILE_RUNS 3
+#define PROFILE_MAX_REGIONS 10
+
+
+/*
+ * Measures every chunk of inbuf with the codec that has just been benchmarked. Chunks that
+ * fail to compress or decompress stop the profile, as the row already reports the error.
+ */
+void lzbench_profile_chunks(lzbench_params_t *params, string_table_t& row, const compressor_desc_t* desc, codec_options_t *codec_options, std::vector<size_t> &chunk_sizes, uint8_t *inbuf, uint8_t *compbuf, uint8_t *decomp, bench_rate_t rate)
+{
+    bench_timer_t start_ticks, end_ticks;
+    uint64_t offset = 0;
+
+    row.profile.reserve(chunk_sizes.size());
+    for (size_t i=0; i<chunk_sizes.size(); i++)
+    {
+        size_t part = chunk_sizes[i];
+        profile_point_t p = { offset, part, 0, 0, 0 };
+        int64_t clen = 0, dlen;
+
+        for (int r=0; r<PROFILE_RUNS; r++)
+        {
+            GetTime(start_ticks);
+            clen = desc->compress((char*)inbuf + offset, part, (char*)compbuf, GET_COMPRESS_BOUND(part), codec_options);
+            GetTime(end_ticks);
+            if (clen <= 0) {
+                LZBENCH_PRINT(0, "ERROR in %s: --profile compression error at offset %llu\n", desc->name, (unsigned long long)offset);
+                return;
+            }
+            uint64_t nanosec = GetDiffTime(rate, start_ticks, end_ticks);
+            if (r == 0 || nanosec < p.ctime) p.ctime = nanosec;
+        }
+        p.comprsize = clen;
+
+        for (int r=0; r<PROFILE_RUNS && !params->compress_only; r++)
+        {
+            GetTime(start_ticks);
+            dlen = desc->decompress((char*)compbuf, clen, (char*)decomp, part, codec_options);
+            GetTime(end_ticks);
+            if (dlen != (int64_t)part || memcmp(inbuf + offset, decomp, part) != 0) {
+                LZBENCH_PRINT(0, "ERROR in %s: --profile decompression error at offset %llu\n", desc->name, (unsigned long long)offset);
+                return;
+            }
+            uint64_t nanosec = GetDiffTime(rate, start_ticks, end_ticks);
+            if (r == 0 || nanosec < p.dtime) p.dtime = nanosec;
+        }
+
+        row.profile.push_back(p);
+        offset += part;
+        LZBENCH_STDERR(2, "%s profile %d/%d chunks     \r", desc->name, (int)i+1, (int)chunk_sizes.size());
+    }
+}
+
+
+static double point_ratio(const profile_point_t& p)
+{
+    return (double)p.size / p.comprsize;
+}
+
+struct less_by_ratio { const std::vector<profile_point_t>& p; less_by_ratio(const std::vector<profile_point_t>& pts) : p(pts) {} bool operator() (size_t a, size_t b) const { return point_ratio(p[a]) < point_ratio(p[b]); } };
+// slower first: a longer time per byte, compared without division
+struct slower_compression { const std::vector<profile_point_t>& p; slower_compression(const std::vector<profile_point_t>& pts) : p(pts) {} bool operator() (size_t a, size_t b) const { return (double)p[a].ctime * p[b].size > (double)p[b].ctime * p[a].size; } };
+struct slower_decompression { const std::vector<profile_point_t>& p; slower_decompression(const std::vector<profile_point_t>& pts) : p(pts) {} bool operator() (size_t a, size_t b) const { return (double)p[a].dtime * p[b].size > (double)p[b].dtime * p[a].size; } };
+
+
+void lzbench_profile_summarize(const string_table_t& row, profile_summary_t& summary)
+{
+    const std::vector<profile_point_t>& points = row.profile;
+    std::vector<size_t> order(points.size());
+    size_t slowest = MAX(points.size() / 100, (size_t)1);
+
+    summary.low_chunks = 0;
+    summary.low_bytes = 0;
+    summary.min_ratio = summary.median_ratio = summary.max_ratio = 0;
+    summary.slowest_c.clear();
+    summary.slowest_d.clear();
+    if (points.empty()) return;
+
+    for (size_t i=0; i<points.size(); i++)
+    {
+        order[i] = i;
+        if (point_ratio(points[i]) < PROFILE_LOW_RATIO) {
+            summary.low_chunks++;
+            summary.low_bytes += points[i].size;
+        }
+    }
+
+    std::sort(order.begin(), order.end(), less_by_ratio(points));
+    summary.min_ratio = point_ratio(points[order[0]]);
+    summary.median_ratio = (point_ratio(points[order[(order.size()-1)/2]]) + point_ratio(points[order[order.size()/2]])) / 2;
+    summary.max_ratio = point_ratio(points[order.back()]);
+
+    std::sort(order.begin(), order.end(), slower_compression(points));
+    summary.slowest_c.assign(order.begin(), order.begin() + slowest);
+    std::sort(summary.slowest_c.begin(), summary.slowest_c.end());
+
+    if (points[0].dtime)
+    {
+        std::sort(order.begin(), order.end(), slower_decompression(points));
+        summary.slowest_d.assign(order.begin(), order.begin() + slowest);
+        std::sort(summary.slowest_d.begin(), summary.slowest_d.end());
+    }
+}
+
+
+// adjacent chunks are printed as a single region: offset-end (MB/s of the slowest chunk)
+static void print_regions(const std::vector<profile_point_t>& points, const std::vector<size_t>& chunks, bool decompression)
+{
+    size_t regions = 0;
+
+    for (size_t i=0; i<chunks.size(); )
+    {
+        size_t j = i + 1;
+        while (j < chunks.size() && chunks[j] == chunks[j-1] + 1) j++;
+
+        double speed = 0;
+        for (size_t k=i; k<j; k++)
+        {
+            const profile_point_t& p = points[chunks[k]];
+            uint64_t nanosec = decompression ? p.dtime : p.ctime;
+            double s = nanosec ? p.size * 1000.0 / nanosec : 0;
+            if (k == i || s < speed) speed = s;
+        }
+        const profile_point_t& last = points[chunks[j-1]];
+        if (regions++ < PROFILE_MAX_REGIONS)
+            printf(" %llu-%llu (%.1f MB/s)", (unsigned long long)points[chunks[i]].offset, (unsigned long long)(last.offset + last.size), speed);
+        i = j;
+    }
+    if (regions > PROFILE_MAX_REGIONS)
+        printf(" and %d more", (int)(regions - PROFILE_MAX_REGIONS));
+    printf("\n");
+}
+
+
+static void print_json_profile(const string_table_t& row, const profile_summary_t& s)
+{
+    printf("{\"type\":\"profile\",\"name\":%s,\"file\":%s,\"chunks\":%d,\"low_ratio_chunks\":%d,\"low_ratio_bytes\":%llu",
+           json_string(row.col1_algname).c_str(), json_string(row.col6_filename).c_str(), (int)row.profile.size(), (int)s.low_chunks, (unsigned long long)s.low_bytes);
+    printf(",\"min_ratio\":%.3f,\"median_ratio\":%.3f,\"max_ratio\":%.3f", s.min_ratio, s.median_ratio, s.max_ratio);
+    printf(",\"slowest_compression\":[");
+    for (size_t i=0; i<s.slowest_c.size(); i++)
+        printf("%s%llu", i ? "," : "", (unsigned long long)row.profile[s.slowest_c[i]].offset);
+    printf("],\"slowest_decompression\":[");
+    for (size_t i=0; i<s.slowest_d.size(); i++)
+        printf("%s%llu", i ? "," : "", (unsigned long long)row.profile[s.slowest_d[i]].offset);
+    printf("]}\n");
+}
+
+
+static int write_profile_csv(lzbench_params_t *params, const char* filename)
+{
+    FILE* f = fopen(filename, "w");
+    if (!f) {
+        perror(filename);
+        return 1;
+    }
+
+    fprintf(f, "name,filename,offset,size,compressed_size,ratio,ctime_ns,dtime_ns\n");
+    for (size_t i=0; i<params->results.size(); i++)
+    {
+        const string_table_t& r = params->results[i];
+        for (size_t k=0; k<r.profile.size(); k++)
+        {
+            const profile_point_t& p = r.profile[k];
+            fprintf(f, "%s,%s,%llu,%llu,%llu,%.4f,%llu,%llu\n", r.col1_algname.c_str(), r.col6_filename.c_str(), (unsigned long long)p.offset,
+                    (unsigned long long)p.size, (unsigned long long)p.comprsize, point_ratio(p), (unsigned long long)p.ctime, (unsigned long long)p.dtime);
+        }
+    }
+
+    if (fclose(f) != 0) {
+        perror(filename);
+        return 1;
+    }
+    return 0;
+}
+
+
+/*
+ * Prints the summary of every profiled row (the HTML report draws it itself, CSV users get
+ * the chunks from --profile=FILE) and writes the CSV file of --profile=FILE. Returns 1 if the file cannot be written.
+ */
+int lzbench_profile_report(lzbench_params_t *params)
+{
+    for (size_t i=0; i<params->results.size() && params->textformat != CSV && params->textformat != HTML; i++)
+    {
+        const string_table_t& r = params->results[i];
+        profile_summary_t s;
+        if (r.profile.empty()) continue;
+
+        lzbench_profile_summarize(r, s);
+        if (params->textformat == NDJSON) {
+            print_json_profile(r, s);
+            continue;
+        }
+
+        printf("\nProfile of %s on %s (%d chunks of %s):\n", r.col1_algname.c_str(), r.col6_filename.c_str(), (int)r.profile.size(), format_chunk_size(r.chunk_size).c_str() + 3);
+        printf("  ratio < %.2f: %d chunks (%.1f%%), %.1f%% of bytes\n", PROFILE_LOW_RATIO, (int)s.low_chunks, s.low_chunks * 100.0 / r.profile.size(), s.low_bytes * 100.0 / r.col5_origsize);
+        printf("  ratio min/median/max: %.3f / %.3f / %.3f\n", s.min_ratio, s.median_ratio, s.max_ratio);
+        printf("  slowest 1%% compression:  ");
+        print_regions(r.profile, s.slowest_c, false);
+        if (!s.slowest_d.empty()) {
+            printf("  slowest 1%% decompression:");
+            print_regions(r.profile, s.slowest_d, true);
+        }
+    }
+
+    if (params->profile_file)
+        return write_profile_csv(params, params->profile_file);
+    return 0;
+}
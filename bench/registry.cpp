@@ -0,0 +1,219 @@
+/*
+ * Copyright (c) Przemyslaw Skibinski <inikep@gmail.com>
+ * All rights reserved.
+ *
+ * This source code is dual-licensed under the GPLv2 and GPLv3 licenses.
+ * For additional details, refer to the LICENSE file located in the root
+ * directory of this source tree.
+ *
+ * registry.cpp: runtime list of codecs built from comp_desc[] and plugins loaded with --plugins=DIR
+ */
+
+#include "lzbench.h"
+#include <algorithm> // sort
+#include <string.h>
+
+#ifndef BENCH_REMOVE_PLUGINS
+#ifdef WINDOWS
+    typedef HMODULE plugin_handle_t;
+    #define PLUGIN_OPEN(path) LoadLibraryA(path)
+    #define PLUGIN_SYM(handle, name) GetProcAddress(handle, name)
+    #define PLUGIN_CLOSE(handle) FreeLibrary(handle)
+#else
+    #include <dirent.h>
+    #include <dlfcn.h>
+    typedef void* plugin_handle_t;
+    #define PLUGIN_OPEN(path) dlopen(path, RTLD_NOW | RTLD_LOCAL)
+    #define PLUGIN_SYM(handle, name) dlsym(handle, name)
+    #define PLUGIN_CLOSE(handle) dlclose(handle)
+#endif
+
+static std::vector<plugin_handle_t> g_plugin_handles;
+#endif // BENCH_REMOVE_PLUGINS
+
+static std::vector<compressor_desc_t> g_codecs;
+
+
+static std::vector<compressor_desc_t>& codec_list()
+{
+    if (g_codecs.empty())
+        g_codecs.assign(comp_desc, comp_desc + LZBENCH_COMPRESSOR_COUNT);
+    return g_codecs;
+}
+
+
+const std::vector<compressor_desc_t>& lzbench_codecs()
+{
+    return codec_list();
+}
+
+
+const compressor_desc_t* lzbench_find_codec(const char* name)
+{
+    std::vector<compressor_desc_t>& codecs = codec_list();
+    for (size_t i=0; i<codecs.size(); i++)
+        if (istrcmp(codecs[i].name, name) == 0)
+            return &codecs[i];
+    return NULL;
+}
+
+
+size_t lzbench_max_padding()
+{
+    std::vector<compressor_desc_t>& codecs = codec_list();
+    size_t padding = PAD_SIZE;
+    for (size_t i=0; i<codecs.size(); i++)
+        padding = MAX(padding, (size_t)codecs[i].padding);
+    return padding;
+}
+
+
+std::string lzbench_caps_string(const compressor_desc_t* desc)
+{
+    std::string caps;
+    if (desc->flags & C_STR) caps += "stream,";
+    if (desc->flags & C_DIC) caps += "dict,";
+    if (desc->flags & C_TS)  caps += "thread-safe,";
+    if (desc->flags & C_MT)  caps += "native-threads,";
+    if (desc->max_insize) {
+        std::string limit;
+        if (desc->max_insize >= (1ULL << 20))
+            format(limit, "max %lluMB,", (unsigned long long)(desc->max_insize >> 20));
+        else
+            format(limit, "max %llu bytes,", (unsigned long long)desc->max_insize);
+        caps += limit;
+    }
+    if (desc->padding) {
+        std::string pad;
+        format(pad, "pad %u,", desc->padding);
+        caps += pad;
+    }
+    if (!caps.empty()) caps.erase(caps.size()-1);
+    return caps;
+}
+
+
+#ifndef BENCH_REMOVE_PLUGINS
+static int load_plugin(lzbench_params_t *params, const std::string& path)
+{
+    plugin_handle_t handle = PLUGIN_OPEN(path.c_str());
+    if (!handle) {
+#ifdef WINDOWS
+        fprintf(stderr, "warning: cannot load plugin %s (error %lu)\n", path.c_str(), (unsigned long)GetLastError());
+#else
+        fprintf(stderr, "warning: cannot load plugin %s (%s)\n", path.c_str(), dlerror());
+#endif
+        return 0;
+    }
+
+    lzbench_plugin_entry_t entry = (lzbench_plugin_entry_t)PLUGIN_SYM(handle, LZBENCH_PLUGIN_ENTRY);
+    const lzbench_plugin_t* plugin = entry ? entry() : NULL;
+    if (!plugin) {
+        fprintf(stderr, "warning: %s does not export " LZBENCH_PLUGIN_ENTRY "()\n", path.c_str());
+        PLUGIN_CLOSE(handle);
+        return 0;
+    }
+    if (plugin->abi_version != LZBENCH_PLUGIN_ABI_VERSION) {
+        fprintf(stderr, "warning: %s uses plugin ABI %u, expected %u\n", path.c_str(), plugin->abi_version, LZBENCH_PLUGIN_ABI_VERSION);
+        PLUGIN_CLOSE(handle);
+        return 0;
+    }
+
+    std::vector<compressor_desc_t>& codecs = codec_list();
+    int added = 0;
+    for (uint32_t i=0; i<plugin->codec_count; i++)
+    {
+        const lzbench_plugin_codec_t* pc = &plugin->codecs[i];
+        if (!pc->name || !pc->name_version || !pc->compress || !pc->decompress) {
+            fprintf(stderr, "warning: %s: codec #%u is incomplete\n", path.c_str(), i);
+            continue;
+        }
+        if (lzbench_find_codec(pc->name)) {
+            fprintf(stderr, "warning: %s: codec \"%s\" is already registered\n", path.c_str(), pc->name);
+            continue;
+        }
+        compressor_desc_t desc = { pc->name, pc->name_version, pc->first_level, pc->last_level, pc->additional_param,
+                                   pc->flags, pc->max_insize, pc->padding, pc->compress, pc->decompress, pc->init, pc->deinit };
+        codecs.push_back(desc);
+        added++;
+        LZBENCH_PRINT(4, "plugin %s: registered %s\n", path.c_str(), pc->name_version);
+    }
+
+    if (added == 0)
+        PLUGIN_CLOSE(handle);
+    else
+        g_plugin_handles.push_back(handle);
+    return added;
+}
+
+
+static bool has_plugin_extension(const char* name)
+{
+    static const char* exts[] = { ".so", ".dll", ".dylib" };
+    size_t len = strlen(name);
+    for (size_t i=0; i<sizeof(exts)/sizeof(exts[0]); i++) {
+        size_t elen = strlen(exts[i]);
+        if (len > elen && istrcmp(name + len - elen, exts[i]) == 0)
+            return true;
+    }
+    return false;
+}
+
+
+int lzbench_load_plugins(lzbench_params_t *params, const char* dir)
+{
+    std::vector<std::string> files;
+
+#ifdef WINDOWS
+    WIN32_FIND_DATAA fd;
+    std::string pattern = std::string(dir) + "\\*";
+    HANDLE hFind = FindFirstFileA(pattern.c_str(), &fd);
+    if (hFind == INVALID_HANDLE_VALUE) {
+        fprintf(stderr, "cannot open plugin directory %s\n", dir);
+        return -1;
+    }
+    do {
+        if (!(fd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) && has_plugin_extension(fd.cFileName))
+            files.push_back(std::string(dir) + "\\" + fd.cFileName);
+    } while (FindNextFileA(hFind, &fd));
+    FindClose(hFind);
+#else
+    DIR* d = opendir(dir);
+    if (!d) {
+        perror(dir);
+        return -1;
+    }
+    struct dirent* entry;
+    while ((entry = readdir(d)) != NULL)
+        if (has_plugin_extension(entry->d_name))
+            files.push_back(std::string(dir) + "/" + entry->d_name);
+    closedir(d);
+#endif
+
+    std::sort(files.begin(), files.end()); // deterministic registration order
+    int count = 0;
+    for (size_t i=0; i<files.size(); i++)
+        count += load_plugin(params, files[i]);
+    return count;
+}
+
+
+void lzbench_unload_plugins()
+{
+    g_codecs.clear();
+    for (size_t i=0; i<g_plugin_handles.size(); i++)
+        PLUGIN_CLOSE(g_plugin_handles[i]);
+    g_plugin_handles.clear();
+}
+
+#else
+
+int lzbench_load_plugins(lzbench_params_t *params, const char* dir)
+{
+    fprintf(stderr, "plugin support was disabled at build time (DONT_BUILD_PLUGINS=1)\n");
+    return -1;
+}
+
+void lzbench_unload_plugins() { }
+
+#endif // BENCH_REMOVE_PLUGINS
@@ -0,0 +1,335 @@
+/*
+ * Copyright (c) Przemyslaw Skibinski <inikep@gmail.com>
+ * All rights reserved.
+ *
+ * This source code is dual-licensed under the GPLv2 and GPLv3 licenses.
+ * For additional details, refer to the LICENSE file located in the root
+ * directory of this source tree.
+ *
+ * report.cpp: self-contained HTML report with inline SVG charts (-o8)
+ *
+ * For every input file two scatter plots are drawn: compression speed vs ratio and
+ * decompression speed vs ratio, both with log-scale axes. Levels of a codec are connected
+ * as a curve and the Pareto frontier of each chart is highlighted. Results of --profile add
+ * the ratio and speeds of every chunk over input offsets.
+ */
+
+#include "lzbench.h"
+#include <algorithm> // sort, find
+#include <math.h>    // log10, pow, floor
+
+#define CHART_WIDTH   760
+#define CHART_HEIGHT  500
+#define CHART_LEFT    70
+#define CHART_RIGHT   20
+#define CHART_TOP     30
+#define CHART_BOTTOM  50
+
+static const char* palette[] = { "#1f77b4", "#ff7f0e", "#2ca02c", "#d62728", "#9467bd", "#8c564b", "#e377c2", "#7f7f7f", "#bcbd22", "#17becf" };
+static const int palette_size = sizeof(palette)/sizeof(palette[0]);
+
+typedef struct
+{
+    double x, y;          // speed in MB/s, ratio as original/compressed size
+    const string_table_t* row;
+} chart_point_t;
+
+struct less_by_speed { const std::vector<chart_point_t>& p; less_by_speed(const std::vector<chart_point_t>& pts) : p(pts) {} bool operator() (size_t a, size_t b) const { return p[a].x < p[b].x; } };
+struct less_by_level { const std::vector<chart_point_t>& p; less_by_level(const std::vector<chart_point_t>& pts) : p(pts) {} bool operator() (size_t a, size_t b) const { return p[a].row->level < p[b].row->level; } };
+
+
+static std::string html_escape(const std::string& text)
+{
+    std::string out;
+    for (size_t i=0; i<text.size(); i++)
+    {
+        switch (text[i])
+        {
+            case '&': out += "&amp;"; break;
+            case '<': out += "&lt;"; break;
+            case '>': out += "&gt;"; break;
+            case '"': out += "&quot;"; break;
+            default:  out += text[i];
+        }
+    }
+    return out;
+}
+
+
+// 1-2-5 ticks for speeds, finer steps for ratios which usually span less than a decade
+static std::vector<double> log_ticks(double lo, double hi, bool fine)
+{
+    static const double coarse_steps[] = { 1, 2, 5 };
+    static const double fine_steps[] = { 1, 1.1, 1.2, 1.3, 1.4, 1.5, 1.6, 1.8, 2, 2.2, 2.5, 3, 3.5, 4, 5, 6, 7, 8, 9 };
+    const double* steps = fine ? fine_steps : coarse_steps;
+    int nsteps = fine ? (int)(sizeof(fine_steps)/sizeof(fine_steps[0])) : 3;
+    std::vector<double> ticks;
+
+    for (int e = (int)floor(log10(lo)) - 1; e <= (int)floor(log10(hi)) + 1; e++)
+        for (int i=0; i<nsteps; i++)
+        {
+            double v = steps[i] * pow(10.0, e);
+            if (v >= lo * 0.9999 && v <= hi * 1.0001) ticks.push_back(v);
+        }
+    // keep at most 12 ticks
+    std::vector<double> out;
+    size_t every = ticks.size() / 12 + 1;
+    for (size_t i=0; i<ticks.size(); i+=every) out.push_back(ticks[i]);
+    return out;
+}
+
+
+static double scale(double v, double lo, double hi, double from, double to)
+{
+    return from + (log10(v) - log10(lo)) / (log10(hi) - log10(lo)) * (to - from);
+}
+
+
+static void print_chart(const char* title, const std::vector<chart_point_t>& points, const std::vector<std::vector<size_t> >& series)
+{
+    double xmin = points[0].x, xmax = xmin, ymin = points[0].y, ymax = ymin;
+    for (size_t i=1; i<points.size(); i++)
+    {
+        xmin = MIN(xmin, points[i].x); xmax = MAX(xmax, points[i].x);
+        ymin = MIN(ymin, points[i].y); ymax = MAX(ymax, points[i].y);
+    }
+    // leave some room around the points
+    xmin /= 1.3; xmax *= 1.3; ymin /= 1.05; ymax *= 1.05;
+    if (xmin <= 0) xmin = 0.01;
+    if (ymin <= 0) ymin = 0.01;
+
+    const double x0 = CHART_LEFT, x1 = CHART_WIDTH - CHART_RIGHT, y0 = CHART_HEIGHT - CHART_BOTTOM, y1 = CHART_TOP;
+
+    printf("<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"%d\" height=\"%d\" viewBox=\"0 0 %d %d\">\n", CHART_WIDTH, CHART_HEIGHT, CHART_WIDTH, CHART_HEIGHT);
+    printf("<text x=\"%d\" y=\"18\" class=\"title\">%s</text>\n", CHART_WIDTH/2, title);
+    printf("<rect x=\"%.0f\" y=\"%.0f\" width=\"%.0f\" height=\"%.0f\" class=\"frame\"/>\n", x0, y1, x1 - x0, y0 - y1);
+
+    std::vector<double> ticks = log_ticks(xmin, xmax, false);
+    for (size_t i=0; i<ticks.size(); i++)
+    {
+        double x = scale(ticks[i], xmin, xmax, x0, x1);
+        printf("<line x1=\"%.1f\" y1=\"%.0f\" x2=\"%.1f\" y2=\"%.0f\" class=\"grid\"/><text x=\"%.1f\" y=\"%.0f\" class=\"xtick\">%g</text>\n", x, y0, x, y1, x, y0 + 16, ticks[i]);
+    }
+    ticks = log_ticks(ymin, ymax, true);
+    for (size_t i=0; i<ticks.size(); i++)
+    {
+        double y = scale(ticks[i], ymin, ymax, y0, y1);
+        printf("<line x1=\"%.0f\" y1=\"%.1f\" x2=\"%.0f\" y2=\"%.1f\" class=\"grid\"/><text x=\"%.0f\" y=\"%.1f\" class=\"ytick\">%g</text>\n", x0, y, x1, y, x0 - 6, y + 4, ticks[i]);
+    }
+    printf("<text x=\"%.0f\" y=\"%d\" class=\"label\">speed [MB/s, log scale]</text>\n", (x0 + x1) / 2, CHART_HEIGHT - 10);
+    printf("<text x=\"16\" y=\"%.0f\" class=\"label\" transform=\"rotate(-90 16 %.0f)\">ratio [original/compressed, log scale]</text>\n", (y0 + y1) / 2, (y0 + y1) / 2);
+
+    // Pareto frontier of this chart: no other point is both faster and compresses better
+    std::vector<size_t> frontier;
+    for (size_t i=0; i<points.size(); i++)
+    {
+        bool dominated = false;
+        for (size_t j=0; j<points.size() && !dominated; j++)
+            dominated = (points[j].x >= points[i].x && points[j].y >= points[i].y && (points[j].x > points[i].x || points[j].y > points[i].y));
+        if (!dominated) frontier.push_back(i);
+    }
+    std::sort(frontier.begin(), frontier.end(), less_by_speed(points));
+    printf("<polyline class=\"pareto\" points=\"");
+    for (size_t i=0; i<frontier.size(); i++)
+        printf("%.1f,%.1f ", scale(points[frontier[i]].x, xmin, xmax, x0, x1), scale(points[frontier[i]].y, ymin, ymax, y0, y1));
+    printf("\"/>\n");
+
+    for (size_t c=0; c<series.size(); c++)
+    {
+        const char* color = palette[c % palette_size];
+        if (series[c].size() > 1)
+        {
+            printf("<polyline fill=\"none\" stroke=\"%s\" stroke-width=\"1.5\" points=\"", color);
+            for (size_t k=0; k<series[c].size(); k++)
+                printf("%.1f,%.1f ", scale(points[series[c][k]].x, xmin, xmax, x0, x1), scale(points[series[c][k]].y, ymin, ymax, y0, y1));
+            printf("\"/>\n");
+        }
+        for (size_t k=0; k<series[c].size(); k++)
+        {
+            const chart_point_t& p = points[series[c][k]];
+            bool on_frontier = std::find(frontier.begin(), frontier.end(), series[c][k]) != frontier.end();
+            printf("<circle cx=\"%.1f\" cy=\"%.1f\" r=\"%d\" fill=\"%s\"%s><title>%s: %.2f MB/s, ratio %.3f%s</title></circle>\n",
+                   scale(p.x, xmin, xmax, x0, x1), scale(p.y, ymin, ymax, y0, y1), on_frontier ? 5 : 3, color, on_frontier ? " class=\"front\"" : "",
+                   html_escape(p.row->col1_algname).c_str(), p.x, p.y, on_frontier ? " (Pareto frontier)" : "");
+        }
+    }
+    printf("</svg>\n");
+}
+
+
+// values over input offsets (linear x axis in MB) with a log-scale y axis, one polyline per series
+static void print_offset_chart(const char* title, const char* ylabel, const std::vector<profile_point_t>& points, const std::vector<std::vector<double> >& series, const char** names)
+{
+    double xmax = (points.back().offset + points.back().size) / 1048576.0, ymin = 0, ymax = 0;
+    for (size_t c=0; c<series.size(); c++)
+        for (size_t i=0; i<series[c].size(); i++)
+        {
+            if (series[c][i] <= 0) continue;
+            if (ymin == 0 || series[c][i] < ymin) ymin = series[c][i];
+            ymax = MAX(ymax, series[c][i]);
+        }
+    if (ymin == 0) return;
+    ymin /= 1.05; ymax *= 1.05;
+
+    const double x0 = CHART_LEFT, x1 = CHART_WIDTH - CHART_RIGHT, y0 = CHART_HEIGHT - CHART_BOTTOM, y1 = CHART_TOP;
+
+    printf("<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"%d\" height=\"%d\" viewBox=\"0 0 %d %d\">\n", CHART_WIDTH, CHART_HEIGHT, CHART_WIDTH, CHART_HEIGHT);
+    printf("<text x=\"%d\" y=\"18\" class=\"title\">%s</text>\n", CHART_WIDTH/2, title);
+    printf("<rect x=\"%.0f\" y=\"%.0f\" width=\"%.0f\" height=\"%.0f\" class=\"frame\"/>\n", x0, y1, x1 - x0, y0 - y1);
+
+    // about 10 ticks with a 1-2-5 step
+    double step = pow(10.0, floor(log10(xmax / 10)));
+    if (xmax / step > 50) step *= 5; else if (xmax / step > 20) step *= 2;
+    for (double v=0; v<=xmax; v+=step)
+    {
+        double x = x0 + v / xmax * (x1 - x0);
+        printf("<line x1=\"%.1f\" y1=\"%.0f\" x2=\"%.1f\" y2=\"%.0f\" class=\"grid\"/><text x=\"%.1f\" y=\"%.0f\" class=\"xtick\">%g</text>\n", x, y0, x, y1, x, y0 + 16, v);
+    }
+    std::vector<double> ticks = log_ticks(ymin, ymax, true);
+    for (size_t i=0; i<ticks.size(); i++)
+    {
+        double y = scale(ticks[i], ymin, ymax, y0, y1);
+        printf("<line x1=\"%.0f\" y1=\"%.1f\" x2=\"%.0f\" y2=\"%.1f\" class=\"grid\"/><text x=\"%.0f\" y=\"%.1f\" class=\"ytick\">%g</text>\n", x0, y, x1, y, x0 - 6, y + 4, ticks[i]);
+    }
+    printf("<text x=\"%.0f\" y=\"%d\" class=\"label\">offset [MB]</text>\n", (x0 + x1) / 2, CHART_HEIGHT - 10);
+    printf("<text x=\"16\" y=\"%.0f\" class=\"label\" transform=\"rotate(-90 16 %.0f)\">%s</text>\n", (y0 + y1) / 2, (y0 + y1) / 2, ylabel);
+
+    // every chunk is drawn as a horizontal step from its offset to its end
+    for (size_t c=0; c<series.size(); c++)
+    {
+        printf("<polyline fill=\"none\" stroke=\"%s\" stroke-width=\"1\" points=\"", palette[c % palette_size]);
+        for (size_t i=0; i<points.size(); i++)
+        {
+            if (series[c][i] <= 0) continue;
+            double y = scale(series[c][i], ymin, ymax, y0, y1);
+            printf("%.1f,%.1f %.1f,%.1f ", x0 + points[i].offset / 1048576.0 / xmax * (x1 - x0), y, x0 + (points[i].offset + points[i].size) / 1048576.0 / xmax * (x1 - x0), y);
+        }
+        printf("\"><title>%s</title></polyline>\n", names[c]);
+    }
+    printf("</svg>\n");
+}
+
+
+static void print_profile(const string_table_t& r)
+{
+    static const char* ratio_names[] = { "ratio" };
+    static const char* speed_names[] = { "compression", "decompression" };
+    std::vector<std::vector<double> > ratio(1), speed(2);
+    profile_summary_t s;
+
+    for (size_t i=0; i<r.profile.size(); i++)
+    {
+        const profile_point_t& p = r.profile[i];
+        ratio[0].push_back((double)p.size / p.comprsize);
+        speed[0].push_back(p.ctime ? p.size * 1000.0 / p.ctime : 0);
+        speed[1].push_back(p.dtime ? p.size * 1000.0 / p.dtime : 0);
+    }
+    lzbench_profile_summarize(r, s);
+
+    printf("<h3>Profile of %s (%d chunks)</h3>\n", html_escape(r.col1_algname).c_str(), (int)r.profile.size());
+    printf("<p>ratio &lt; %.2f: %d chunks (%.1f%%), %.1f%% of bytes; ratio min/median/max: %.3f / %.3f / %.3f</p>\n", PROFILE_LOW_RATIO,
+           (int)s.low_chunks, s.low_chunks * 100.0 / r.profile.size(), s.low_bytes * 100.0 / r.col5_origsize, s.min_ratio, s.median_ratio, s.max_ratio);
+    print_offset_chart("Ratio over offset", "ratio [original/compressed, log scale]", r.profile, ratio, ratio_names);
+    printf("<div class=\"legend\"><span><i style=\"background:%s\"></i>compression</span> <span><i style=\"background:%s\"></i>decompression</span></div>\n", palette[0], palette[1]);
+    print_offset_chart("Speed over offset", "speed [MB/s, log scale]", r.profile, speed, speed_names);
+}
+
+
+static void print_file_report(const std::string& filename, const std::vector<const string_table_t*>& rows)
+{
+    std::vector<std::string> codecs;
+    std::vector<chart_point_t> cpoints, dpoints;
+    std::vector<std::vector<size_t> > cseries, dseries;
+
+    // codecs in order of appearance, levels sorted to draw curves
+    for (size_t i=0; i<rows.size(); i++)
+    {
+        std::string codec = rows[i]->codec.empty() ? rows[i]->col1_algname : rows[i]->codec;
+        if (std::find(codecs.begin(), codecs.end(), codec) == codecs.end())
+            codecs.push_back(codec);
+    }
+    cseries.resize(codecs.size());
+    dseries.resize(codecs.size());
+
+    for (size_t i=0; i<rows.size(); i++)
+    {
+        const string_table_t& r = *rows[i];
+        std::string codec = r.codec.empty() ? r.col1_algname : r.codec;
+        size_t c = std::find(codecs.begin(), codecs.end(), codec) - codecs.begin();
+        double ratio = (double)r.col5_origsize / r.col4_comprsize;
+        if (r.col2_ctime) {
+            chart_point_t p = { r.col5_origsize * 1000.0 / r.col2_ctime, ratio, &r };
+            cseries[c].push_back(cpoints.size());
+            cpoints.push_back(p);
+        }
+        if (r.col3_dtime) {
+            chart_point_t p = { r.col5_origsize * 1000.0 / r.col3_dtime, ratio, &r };
+            dseries[c].push_back(dpoints.size());
+            dpoints.push_back(p);
+        }
+    }
+    for (size_t c=0; c<codecs.size(); c++)
+    {
+        std::sort(cseries[c].begin(), cseries[c].end(), less_by_level(cpoints));
+        std::sort(dseries[c].begin(), dseries[c].end(), less_by_level(dpoints));
+    }
+
+    printf("<h2>%s</h2>\n<div class=\"legend\">", html_escape(filename).c_str());
+    for (size_t c=0; c<codecs.size(); c++)
+        printf("<span><i style=\"background:%s\"></i>%s</span> ", palette[c % palette_size], html_escape(codecs[c]).c_str());
+    printf("<span><i class=\"front\"></i>Pareto frontier</span></div>\n");
+
+    if (!cpoints.empty()) print_chart("Compression speed vs ratio", cpoints, cseries);
+    if (!dpoints.empty()) print_chart("Decompression speed vs ratio", dpoints, dseries);
+
+    printf("<table>\n<tr><th>Compressor name</th><th>Compression</th><th>Decompression</th><th>Compr. size</th><th>Ratio</th></tr>\n");
+    for (size_t i=0; i<rows.size(); i++)
+    {
+        const string_table_t& r = *rows[i];
+        printf("<tr><td>%s</td>", html_escape(r.col1_algname).c_str());
+        if (r.col2_ctime) printf("<td>%.2f MB/s</td>", r.col5_origsize * 1000.0 / r.col2_ctime); else printf("<td>ERROR</td>");
+        if (r.col3_dtime) printf("<td>%.2f MB/s</td>", r.col5_origsize * 1000.0 / r.col3_dtime); else printf("<td>ERROR</td>");
+        printf("<td>%llu</td><td>%.3f</td></tr>\n", (unsigned long long)r.col4_comprsize, (double)r.col5_origsize / r.col4_comprsize);
+    }
+    printf("</table>\n");
+
+    for (size_t i=0; i<rows.size(); i++)
+        if (!rows[i]->profile.empty())
+            print_profile(*rows[i]);
+}
+
+
+void lzbench_html_report(lzbench_params_t *params)
+{
+    std::vector<std::string> files;
+
+    for (size_t i=0; i<params->results.size(); i++)
+        if (std::find(files.begin(), files.end(), params->results[i].col6_filename) == files.end())
+            files.push_back(params->results[i].col6_filename);
+
+    printf("<!DOCTYPE html>\n<html>\n<head>\n<meta charset=\"utf-8\">\n<title>" PROGNAME " " PROGVERSION " report</title>\n<style>\n");
+    printf("body { font-family: sans-serif; margin: 20px; }\n");
+    printf("svg { display: block; margin: 10px 0; } svg text { font-size: 11px; }\n");
+    printf(".title { font-size: 14px !important; font-weight: bold; text-anchor: middle; }\n");
+    printf(".frame { fill: none; stroke: #444; } .grid { stroke: #ddd; }\n");
+    printf(".xtick { text-anchor: middle; } .ytick { text-anchor: end; } .label { text-anchor: middle; font-size: 12px !important; }\n");
+    printf(".pareto { fill: none; stroke: #000; stroke-width: 6; stroke-opacity: 0.15; stroke-linejoin: round; }\n");
+    printf("circle.front { stroke: #000; stroke-width: 1.5; }\n");
+    printf(".legend span { margin-right: 12px; white-space: nowrap; } .legend i { display: inline-block; width: 10px; height: 10px; margin-right: 4px; }\n");
+    printf(".legend i.front { background: #fff; border: 2px solid #000; border-radius: 50%%; width: 7px; height: 7px; }\n");
+    printf("table { border-collapse: collapse; } td, th { border: 1px solid #ccc; padding: 2px 8px; text-align: right; } td:first-child { text-align: left; }\n");
+    printf("</style>\n</head>\n<body>\n<h1>" PROGNAME " " PROGVERSION " (%d-bit " PROGOS ")</h1>\n", (int)(8 * sizeof(uint8_t*)));
+    printf("<p>%s, %s %s</p>\n", html_escape(params->cpu_brand ? params->cpu_brand : "").c_str(), html_escape(lzbench_compiler()).c_str(), html_escape(lzbench_build_flags()).c_str());
+
+    for (size_t f=0; f<files.size(); f++)
+    {
+        std::vector<const string_table_t*> rows;
+        for (size_t i=0; i<params->results.size(); i++)
+            if (params->results[i].col6_filename == files[f] && params->results[i].col4_comprsize)
+                rows.push_back(&params->results[i]);
+        if (!rows.empty())
+            print_file_report(files[f], rows);
+    }
+
+    printf("</body>\n</html>\n");
+}
@@ -0,0 +1,295 @@
+/*
+ * Copyright (c) Przemyslaw Skibinski <inikep@gmail.com>
+ * All rights reserved.
+ *
+ * This source code is dual-licensed under the GPLv2 and GPLv3 licenses.
+ * For additional details, refer to the LICENSE file located in the root
+ * directory of this source tree.
+ *
+ * results.cpp: machine-readable result files (--save) and comparison with a baseline (--baseline)
+ *
+ * A result file is tab-separated text with one row per codec/level/parameters/file:
+ *   codec level params name_version filename chunk_size origsize comprsize ctime dtime cloops dloops
+ * where times are in nanoseconds and loops are comma-separated lists of the mean time per iteration
+ * of every timing loop. Single iterations shorter than 10 us are not timed on their own, so only
+ * the loop means are samples of the same kind for all codecs and are used by the test.
+ */
+
+#include "lzbench.h"
+#include <algorithm> // sort
+#include <math.h>    // erfc, sqrt
+#include <stdlib.h>
+#include <string.h>
+
+#define RESULTS_MAGIC       "# lzbench results v1"
+#define BASELINE_ALPHA      0.05   // significance level of the Mann-Whitney U test
+#define BASELINE_MIN_SAMPLES 3     // fewer samples are not tested, only deltas are shown
+#define BASELINE_MIN_SHIFT  2.0    // smaller differences of median speeds (in %) are never flagged
+
+
+static std::string join_samples(const std::vector<uint64_t>& samples)
+{
+    std::string text, num;
+    for (size_t i=0; i<samples.size(); i++) {
+        format(num, "%s%llu", i ? "," : "", (unsigned long long)samples[i]);
+        text += num;
+    }
+    return text;
+}
+
+
+static void parse_samples(const std::string& text, std::vector<uint64_t>& samples)
+{
+    std::vector<std::string> nums = split(text, ',');
+    for (size_t i=0; i<nums.size(); i++)
+        if (!nums[i].empty())
+            samples.push_back(strtoull(nums[i].c_str(), NULL, 10));
+}
+
+
+int lzbench_save_results(lzbench_params_t *params, const char* filename)
+{
+    FILE* f = fopen(filename, "w");
+    if (!f) {
+        perror(filename);
+        return 1;
+    }
+
+    fprintf(f, RESULTS_MAGIC " (" PROGNAME " " PROGVERSION ")\n");
+    for (size_t i=0; i<params->results.size(); i++)
+    {
+        const string_table_t& r = params->results[i];
+        fprintf(f, "%s\t%d\t%s\t%s\t%s\t%llu\t%llu\t%llu\t%llu\t%llu\t%s\t%s\n", r.codec.c_str(), r.level, r.codec_params.c_str(),
+                r.col1_algname.c_str(), r.col6_filename.c_str(), (unsigned long long)r.chunk_size, (unsigned long long)r.col5_origsize,
+                (unsigned long long)r.col4_comprsize, (unsigned long long)r.col2_ctime, (unsigned long long)r.col3_dtime,
+                join_samples(r.cloops).c_str(), join_samples(r.dloops).c_str());
+    }
+
+    if (fclose(f) != 0) {
+        perror(filename);
+        return 1;
+    }
+    return 0;
+}
+
+
+int lzbench_load_results(const char* filename, std::vector<string_table_t>& rows)
+{
+    char line[1 << 16];
+    FILE* f = fopen(filename, "r");
+    if (!f) {
+        perror(filename);
+        return 1;
+    }
+
+    if (!fgets(line, sizeof(line), f) || strncmp(line, RESULTS_MAGIC, strlen(RESULTS_MAGIC)) != 0) {
+        fprintf(stderr, "%s: not a result file written with --save\n", filename);
+        fclose(f);
+        return 1;
+    }
+
+    std::string text;
+    while (fgets(line, sizeof(line), f))
+    {
+        text += line;
+        if (text.empty() || text[text.size()-1] != '\n') continue; // a line longer than the buffer
+        text.erase(text.size()-1);
+
+        std::vector<std::string> cols = split(text, '\t');
+        text.clear();
+        if (cols.size() != 12) {
+            fprintf(stderr, "%s: skipping malformed line with %d columns\n", filename, (int)cols.size());
+            continue;
+        }
+
+        string_table_t r(cols[3], strtoull(cols[8].c_str(), NULL, 10), strtoull(cols[9].c_str(), NULL, 10),
+                         strtoull(cols[7].c_str(), NULL, 10), strtoull(cols[6].c_str(), NULL, 10), cols[4]);
+        r.codec = cols[0];
+        r.level = atoi(cols[1].c_str());
+        r.codec_params = cols[2];
+        r.chunk_size = strtoull(cols[5].c_str(), NULL, 10);
+        parse_samples(cols[10], r.cloops);
+        parse_samples(cols[11], r.dloops);
+        rows.push_back(r);
+    }
+
+    fclose(f);
+    return 0;
+}
+
+
+/*
+ * Two-sided p-value of the Mann-Whitney U test (normal approximation with tie correction).
+ * Returns 1.0 when there are too few samples to test.
+ */
+static double mann_whitney_p(const std::vector<double>& a, const std::vector<double>& b)
+{
+    size_t n1 = a.size(), n2 = b.size(), n = n1 + n2;
+    if (n1 < BASELINE_MIN_SAMPLES || n2 < BASELINE_MIN_SAMPLES) return 1.0;
+
+    std::vector<std::pair<double, int> > all;
+    for (size_t i=0; i<n1; i++) all.push_back(std::make_pair(a[i], 0));
+    for (size_t i=0; i<n2; i++) all.push_back(std::make_pair(b[i], 1));
+    std::sort(all.begin(), all.end());
+
+    double rank_sum = 0, ties = 0;
+    for (size_t i=0; i<n; )
+    {
+        size_t j = i;
+        while (j < n && all[j].first == all[i].first) j++;
+        double t = (double)(j - i), rank = (i + 1 + j) / 2.0; // average rank of a tie group
+        for (size_t k=i; k<j; k++)
+            if (all[k].second == 0) rank_sum += rank;
+        ties += t*t*t - t;
+        i = j;
+    }
+
+    double u = rank_sum - n1 * (n1 + 1) / 2.0;
+    double mu = n1 * n2 / 2.0;
+    double sigma = sqrt(n1 * n2 / 12.0 * ((n + 1) - ties / (n * (n - 1.0))));
+    if (sigma == 0) return 1.0;
+
+    double z = (fabs(u - mu) - 0.5) / sigma;
+    if (z < 0) z = 0;
+    return erfc(z / sqrt(2.0));
+}
+
+
+static void to_speeds(const std::vector<uint64_t>& times, uint64_t origsize, std::vector<double>& speeds)
+{
+    speeds.clear();
+    for (size_t i=0; i<times.size(); i++)
+        if (times[i]) speeds.push_back(lzbench_speed(origsize, times[i]));
+}
+
+
+static const string_table_t* find_baseline(lzbench_params_t *params, const string_table_t& r)
+{
+    for (size_t i=0; i<params->baseline.size(); i++)
+    {
+        const string_table_t& b = params->baseline[i];
+        if (b.codec == r.codec && b.level == r.level && b.codec_params == r.codec_params && b.col6_filename == r.col6_filename && b.chunk_size == r.chunk_size)
+            return &b;
+    }
+    return NULL;
+}
+
+
+typedef struct
+{
+    double now, before, delta, p;  // speeds in MB/s, delta in %, p < 0 when not tested
+    int verdict;                   // -1 for a significant slowdown, 1 for a significant speedup
+} speed_cmp_t;
+
+
+static void compare_speed(uint64_t origsize, uint64_t time, const std::vector<uint64_t>& samples, uint64_t base_origsize, uint64_t base_time, const std::vector<uint64_t>& base_samples, speed_cmp_t& c)
+{
+    std::vector<double> s1, s2;
+
+    c.now = lzbench_speed(origsize, time);
+    c.before = lzbench_speed(base_origsize, base_time);
+    c.delta = c.p = -1;
+    c.verdict = 0;
+    if (!c.now || !c.before) {
+        if (!c.now && c.before) c.verdict = -1;
+        return;
+    }
+
+    to_speeds(samples, origsize, s1);
+    to_speeds(base_samples, base_origsize, s2);
+    c.delta = (c.now - c.before) * 100 / c.before;
+    if (s1.size() < BASELINE_MIN_SAMPLES || s2.size() < BASELINE_MIN_SAMPLES) return;
+    c.p = mann_whitney_p(s1, s2);
+
+    // with many samples even tiny shifts are significant, so also require a visible change of medians
+    std::sort(s1.begin(), s1.end());
+    std::sort(s2.begin(), s2.end());
+    double shift = (c.p < BASELINE_ALPHA) ? (s1[s1.size()/2] - s2[s2.size()/2]) * 100 / s2[s2.size()/2] : 0;
+    if (fabs(shift) >= BASELINE_MIN_SHIFT) c.verdict = (shift < 0) ? -1 : 1;
+}
+
+
+// "speed delta p" for one direction
+static void print_speed_cmp(const speed_cmp_t& c)
+{
+    if (!c.now || !c.before)
+        printf("%9s %7s %6s", c.now ? "" : "ERROR", "", "");
+    else if (c.p < 0)
+        printf("%9.1f %+6.1f%% %6s", c.now, c.delta, "-");
+    else
+        printf("%9.1f %+6.1f%% %6.3f", c.now, c.delta, c.p);
+}
+
+
+static void print_json_speed_cmp(const char* name, const speed_cmp_t& c)
+{
+    printf(",\"%s\":%.2f,\"base_%s\":%.2f", name, c.now, name, c.before);
+    if (c.now && c.before) printf(",\"%s_delta_pct\":%.2f", name, c.delta); else printf(",\"%s_delta_pct\":null", name);
+    if (c.p >= 0) printf(",\"%s_p\":%.4f", name, c.p); else printf(",\"%s_p\":null", name);
+}
+
+
+// a table, or with -o7 one "baseline" record per compared result and a "baseline_summary" record
+void lzbench_compare_baseline(lzbench_params_t *params)
+{
+    int compared = 0, regressions = 0, improvements = 0, missing = 0;
+    bool json = params->textformat == NDJSON;
+
+    if (!json) {
+        printf("\nComparison with baseline (Mann-Whitney U test, alpha=%.2f, min. median shift %.0f%%, speeds in MB/s):\n", BASELINE_ALPHA, BASELINE_MIN_SHIFT);
+        printf("%-23s %9s %7s %6s %9s %7s %6s %6s %7s Filename\n", "Compressor name", "Compr.", "delta", "p", "Decompr.", "delta", "p", "Ratio", "delta");
+    }
+
+    for (size_t i=0; i<params->results.size(); i++)
+    {
+        const string_table_t& r = params->results[i];
+        const string_table_t* b = find_baseline(params, r);
+        if (!b) { missing++; continue; }
+
+        speed_cmp_t c, d;
+        std::vector<const char*> flags;
+        compared++;
+        compare_speed(r.col5_origsize, r.col2_ctime, r.cloops, b->col5_origsize, b->col2_ctime, b->cloops, c);
+        if (!params->compress_only)
+            compare_speed(r.col5_origsize, r.col3_dtime, r.dloops, b->col5_origsize, b->col3_dtime, b->dloops, d);
+
+        double ratio = r.col4_comprsize * 100.0 / r.col5_origsize;
+        double base_ratio = b->col4_comprsize * 100.0 / b->col5_origsize;
+        if (c.verdict < 0) flags.push_back("slower-compression");
+        if (!params->compress_only && d.verdict < 0) flags.push_back("slower-decompression");
+        if (ratio > base_ratio + 0.005) flags.push_back("worse-ratio");
+        bool improved = flags.empty() && (c.verdict > 0 || (!params->compress_only && d.verdict > 0) || ratio < base_ratio - 0.005);
+        if (!flags.empty()) regressions++;
+        else if (improved) improvements++;
+
+        if (json) {
+            printf("{\"type\":\"baseline\",\"name\":%s,\"file\":%s", json_string(r.col1_algname).c_str(), json_string(r.col6_filename).c_str());
+            print_json_speed_cmp("cspeed", c);
+            if (!params->compress_only) print_json_speed_cmp("dspeed", d);
+            printf(",\"size_pct\":%.2f,\"base_size_pct\":%.2f,\"regressions\":[", ratio, base_ratio);
+            for (size_t f=0; f<flags.size(); f++) printf("%s\"%s\"", f ? "," : "", flags[f]);
+            printf("],\"improved\":%s}\n", improved ? "true" : "false");
+            continue;
+        }
+
+        printf("%-23s ", r.col1_algname.c_str());
+        print_speed_cmp(c);
+        printf(" ");
+        if (params->compress_only) printf("%9s %7s %6s", "-", "", ""); else print_speed_cmp(d);
+        printf(" %6.2f %+7.2f %s", ratio, ratio - base_ratio, r.col6_filename.c_str());
+        if (!flags.empty()) {
+            printf("  REGRESSION:");
+            for (size_t f=0; f<flags.size(); f++) printf(" %s", flags[f]);
+        }
+        else if (improved) printf("  improved");
+        printf("\n");
+    }
+
+    if (json) {
+        printf("{\"type\":\"baseline_summary\",\"compared\":%d,\"regressions\":%d,\"improvements\":%d,\"missing\":%d}\n", compared, regressions, improvements, missing);
+        return;
+    }
+    printf("%d results compared: %d regressions, %d improvements", compared, regressions, improvements);
+    if (missing) printf(", %d results not found in the baseline", missing);
+    printf("\n");
+}
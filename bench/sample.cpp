@@ -0,0 +1,303 @@
+/*
+ * Copyright (c) Przemyslaw Skibinski <inikep@gmail.com>
+ * All rights reserved.
+ *
+ * This source code is dual-licensed under the GPLv2 and GPLv3 licenses.
+ * For additional details, refer to the LICENSE file located in the root
+ * directory of this source tree.
+ *
+ * sample.cpp: estimates for huge files from K sampled chunks (--sample=K[,entropy])
+ *
+ * The file is split into K strata of equal size and one chunk (-b, 1 MB by default) is read
+ * from a random position in every stratum. With "entropy" the file is first probed at 16*K
+ * places, the probes are sorted by order-0 entropy and split into K groups of equal size,
+ * and the chunk is taken from a random probe of each group, so that both well and poorly
+ * compressible regions are represented. Every stratum covers the same share of the file, so
+ * the full-file ratio and speeds are estimated as sum(compressed) / sum(original) and
+ * sum(bytes) / sum(time) of the samples. 95% confidence intervals come from a bootstrap
+ * over the samples.
+ */
+
+#include "lzbench.h"
+#include "util.h"
+#include <algorithm> // sort
+#include <math.h>    // log
+#include <string.h>
+
+#define SAMPLE_CHUNK_SIZE    (1 << 20)   // used when -b is not given
+#define SAMPLE_PROBES        16          // entropy probes per sample
+#define SAMPLE_PROBE_SIZE    4096
+#define SAMPLE_BOOTSTRAP     2000        // bootstrap resamples
+
+typedef struct
+{
+    uint64_t origsize, comprsize, ctime, dtime;
+} sample_result_t;
+
+typedef struct
+{
+    double estimate, lo, hi;
+} sample_ci_t;
+
+typedef struct
+{
+    double entropy;
+    uint64_t offset;
+} sample_probe_t;
+
+struct less_by_entropy { bool operator() (const sample_probe_t& a, const sample_probe_t& b) const { return a.entropy < b.entropy; } };
+
+
+// splitmix64, the same sampling plan for the same file size and K
+static uint64_t sample_next(uint64_t& state)
+{
+    uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+
+static double order0_entropy(const uint8_t* buf, size_t size)
+{
+    uint32_t count[256] = { 0 };
+    double h = 0;
+    for (size_t i=0; i<size; i++) count[buf[i]]++;
+    for (int i=0; i<256; i++)
+        if (count[i]) h -= count[i] * log((double)count[i] / size);
+    return h / (size * log(2.0));
+}
+
+
+// start offsets of K chunks of chunk_size bytes
+static bool sample_offsets(FILE* in, uint64_t filesize, uint64_t chunk_size, unsigned k, bool entropy, std::vector<uint64_t>& offsets)
+{
+    uint64_t state = filesize ^ k;
+    uint64_t last = filesize - chunk_size;
+
+    if (!entropy)
+    {
+        uint64_t stratum = filesize / k;
+        for (unsigned i=0; i<k; i++)
+        {
+            uint64_t start = i * stratum;
+            uint64_t span = (stratum > chunk_size) ? stratum - chunk_size : 0;
+            offsets.push_back(MIN(start + (span ? sample_next(state) % (span + 1) : 0), last));
+        }
+        return true;
+    }
+
+    unsigned nprobes = k * SAMPLE_PROBES;
+    uint64_t region = filesize / nprobes;
+    std::vector<sample_probe_t> probes(nprobes);
+    std::vector<uint8_t> buf(SAMPLE_PROBE_SIZE);
+    for (unsigned i=0; i<nprobes; i++)
+    {
+        probes[i].offset = i * region;
+        if (fseeko(in, probes[i].offset, SEEK_SET) != 0) return false;
+        size_t n = fread(&buf[0], 1, MIN((uint64_t)SAMPLE_PROBE_SIZE, region), in);
+        probes[i].entropy = n ? order0_entropy(&buf[0], n) : 0;
+    }
+    std::sort(probes.begin(), probes.end(), less_by_entropy());
+
+    for (unsigned i=0; i<k; i++)
+    {
+        const sample_probe_t& p = probes[i * SAMPLE_PROBES + sample_next(state) % SAMPLE_PROBES];
+        uint64_t span = (region > chunk_size) ? region - chunk_size : 0;
+        offsets.push_back(MIN(p.offset + (span ? sample_next(state) % (span + 1) : 0), last));
+    }
+    std::sort(offsets.begin(), offsets.end());
+    return true;
+}
+
+
+/*
+ * ratio = sum(comprsize) / sum(origsize), speeds = sum(origsize) / sum(time) with
+ * percentile bootstrap intervals. Returns false if any sample failed.
+ */
+static bool sample_estimate(const std::vector<sample_result_t>& s, sample_ci_t& ratio, sample_ci_t& cspeed, sample_ci_t& dspeed)
+{
+    uint64_t state = s.size();
+    std::vector<double> r(SAMPLE_BOOTSTRAP), c(SAMPLE_BOOTSTRAP), d(SAMPLE_BOOTSTRAP);
+    double orig = 0, compr = 0, ctime = 0, dtime = 0;
+
+    for (size_t i=0; i<s.size(); i++)
+    {
+        orig += s[i].origsize; compr += s[i].comprsize; ctime += s[i].ctime; dtime += s[i].dtime;
+        if (!s[i].ctime) return false;
+    }
+    ratio.estimate = compr * 100 / orig;
+    cspeed.estimate = orig * 1000 / ctime;
+    dspeed.estimate = dtime ? orig * 1000 / dtime : 0;
+
+    for (int b=0; b<SAMPLE_BOOTSTRAP; b++)
+    {
+        orig = compr = ctime = dtime = 0;
+        for (size_t i=0; i<s.size(); i++)
+        {
+            const sample_result_t& x = s[sample_next(state) % s.size()];
+            orig += x.origsize; compr += x.comprsize; ctime += x.ctime; dtime += x.dtime;
+        }
+        r[b] = compr * 100 / orig;
+        c[b] = orig * 1000 / ctime;
+        d[b] = dtime ? orig * 1000 / dtime : 0;
+    }
+    std::sort(r.begin(), r.end());
+    std::sort(c.begin(), c.end());
+    std::sort(d.begin(), d.end());
+    ratio.lo = r[SAMPLE_BOOTSTRAP / 40];   ratio.hi = r[SAMPLE_BOOTSTRAP - 1 - SAMPLE_BOOTSTRAP / 40];
+    cspeed.lo = c[SAMPLE_BOOTSTRAP / 40];  cspeed.hi = c[SAMPLE_BOOTSTRAP - 1 - SAMPLE_BOOTSTRAP / 40];
+    dspeed.lo = d[SAMPLE_BOOTSTRAP / 40];  dspeed.hi = d[SAMPLE_BOOTSTRAP - 1 - SAMPLE_BOOTSTRAP / 40];
+    return true;
+}
+
+
+static void print_ci(const sample_ci_t& ci, const char* fmt, int width)
+{
+    char text[64];
+    snprintf(text, sizeof(text), fmt, ci.estimate, ci.lo, ci.hi);
+    printf(" %-*s", width, text);
+}
+
+
+static int sample_file(lzbench_params_t *params, const char* filename, char* encoder_list, bool& header, bench_rate_t rate)
+{
+    FILE* in = fopen(filename, "rb");
+    if (!in) {
+        perror(filename);
+        return 0;
+    }
+
+    fseeko(in, 0L, SEEK_END);
+    uint64_t filesize = ftello(in);
+    uint64_t chunk_size = (params->chunk_size < LZBENCH_DEFAULT_CHUNK_SIZE) ? params->chunk_size : SAMPLE_CHUNK_SIZE;
+    unsigned k = params->sample_count;
+    const char* pch = strrchr(filename, '\\');
+    const char* name = pch ? pch+1 : filename;
+    std::vector<uint64_t> offsets;
+
+    if (filesize < (uint64_t)k * chunk_size)
+    {
+        fprintf(stderr, "%s: %d samples of %llu bytes cover the whole file, sampling skipped\n", name, k, (unsigned long long)chunk_size);
+        fclose(in);
+        return 0;
+    }
+    if (!sample_offsets(in, filesize, chunk_size, k, params->sample_entropy, offsets))
+    {
+        perror(filename);
+        fclose(in);
+        return 0;
+    }
+
+    uint8_t* inbuf = (uint8_t*)alloc_and_touch(chunk_size + lzbench_max_padding(), false);
+    if (!inbuf)
+    {
+        printf("Not enough memory, please use -b option!");
+        fclose(in);
+        return 3;
+    }
+
+    // every sample is benchmarked silently; its rows are removed after the estimates are made
+    size_t first_row = params->results.size();
+    std::vector<size_t> file_sizes;
+    std::string sample_name;
+    int saved_silent = params->silent;
+    params->silent = 1;
+    for (unsigned i=0; i<k; i++)
+    {
+        fseeko(in, offsets[i], SEEK_SET);
+        size_t insize = fread(inbuf, 1, chunk_size, in);
+        format(sample_name, "%s @%llu", name, (unsigned long long)offsets[i]);
+        params->in_filename = sample_name.c_str();
+        LZBENCH_STDERR(2, "sample %d/%d at offset %llu          \r", i+1, k, (unsigned long long)offsets[i]);
+        file_sizes.assign(1, insize);
+        lzbench_process_mem_blocks(params, file_sizes, encoder_list?encoder_list:alias_desc[0].params, inbuf, insize, rate);
+    }
+    params->silent = saved_silent;
+    fclose(in);
+    free(inbuf);
+
+    // rows of the same codec/level/parameters from all samples
+    std::vector<string_table_t> estimates;
+    std::vector<sample_ci_t> cis;
+    for (size_t i=first_row; i<params->results.size(); i++)
+    {
+        const string_table_t& first = params->results[i];
+        bool done = false;
+        for (size_t e=0; e<estimates.size() && !done; e++)
+            done = (estimates[e].codec == first.codec && estimates[e].level == first.level && estimates[e].codec_params == first.codec_params && estimates[e].chunk_size == first.chunk_size);
+        if (done) continue;
+
+        std::vector<sample_result_t> samples;
+        for (size_t j=i; j<params->results.size(); j++)
+        {
+            const string_table_t& r = params->results[j];
+            if (r.codec == first.codec && r.level == first.level && r.codec_params == first.codec_params && r.chunk_size == first.chunk_size)
+            {
+                sample_result_t s = { r.col5_origsize, r.col4_comprsize, r.col2_ctime, r.col3_dtime };
+                if (!r.col3_dtime && !params->compress_only) s.ctime = 0; // an error
+                samples.push_back(s);
+            }
+        }
+
+        sample_ci_t ci[3];
+        bool ok = (samples.size() == k) && sample_estimate(samples, ci[0], ci[1], ci[2]);
+        string_table_t row(first.col1_algname, ok ? (uint64_t)(filesize * 1000 / ci[1].estimate) : 0,
+                           (ok && ci[2].estimate) ? (uint64_t)(filesize * 1000 / ci[2].estimate) : 0,
+                           ok ? (uint64_t)(filesize * ci[0].estimate / 100) : 0, filesize, name);
+        row.codec = first.codec;
+        row.level = first.level;
+        row.codec_params = first.codec_params;
+        row.name_version = first.name_version;
+        row.chunk_size = first.chunk_size;
+        estimates.push_back(row);
+        cis.insert(cis.end(), ci, ci + 3);
+        if (!ok) cis[cis.size() - 3].estimate = -1;
+    }
+    params->results.erase(params->results.begin() + first_row, params->results.end());
+
+    if (!header) { print_header(params); header = true; }
+    for (size_t e=0; e<estimates.size(); e++)
+    {
+        params->results.push_back(estimates[e]);
+        if (params->show_speed)
+            print_speed(params, params->results.back());
+        else
+            print_time(params, params->results.back());
+    }
+
+    if (params->textformat == NDJSON || params->textformat == CSV || params->textformat == HTML) return 0;
+    printf("\nEstimates for %s from %d%s samples of %llu bytes (%.3f%% of the file), 95%% bootstrap intervals:\n",
+           name, k, params->sample_entropy ? " entropy-stratified" : " stratified", (unsigned long long)chunk_size, k * chunk_size * 100.0 / filesize);
+    printf("%-23s %-24s %-24s %s\n", "Compressor name", " Compression MB/s", " Decompression MB/s", " Ratio %");
+    for (size_t e=0; e<estimates.size(); e++)
+    {
+        printf("%-23s", estimates[e].col1_algname.c_str());
+        if (cis[e*3].estimate < 0) { printf(" ERROR\n"); continue; }
+        print_ci(cis[e*3 + 1], "%.1f [%.1f, %.1f]", 24);
+        if (params->compress_only) printf(" %-24s", "-");
+        else print_ci(cis[e*3 + 2], "%.1f [%.1f, %.1f]", 24);
+        print_ci(cis[e*3], "%.2f [%.2f, %.2f]", 0);
+        printf("\n");
+    }
+    return 0;
+}
+
+
+int lzbench_sample(lzbench_params_t *params, const char** inFileNames, unsigned ifnIdx, char* encoder_list)
+{
+    bench_rate_t rate;
+    bool header = false;
+
+    InitTimer(rate);
+    for (unsigned i=0; i<ifnIdx; i++)
+    {
+        if (UTIL_isDirectory(inFileNames[i])) {
+            fprintf(stderr, "warning: use -r to process directories (%s)\n", inFileNames[i]);
+            continue;
+        }
+        int ret = sample_file(params, inFileNames[i], encoder_list, header, rate);
+        if (ret) return ret;
+    }
+    return g_exit_result;
+}
@@ -0,0 +1,179 @@
+/*
+ * Copyright (c) Przemyslaw Skibinski <inikep@gmail.com>
+ * All rights reserved.
+ *
+ * This source code is dual-licensed under the GPLv2 and GPLv3 licenses.
+ * For additional details, refer to the LICENSE file located in the root
+ * directory of this source tree.
+ *
+ * search.cpp: time-budgeted search for the Pareto set of codecs (--search=SEC)
+ *
+ * Successive halving over ceil(log2(N))+1 rounds for N candidates selected with -e. Round r
+ * measures the surviving candidates on a sample of insize >> (rounds-1-r) bytes (at least
+ * SEARCH_MIN_SAMPLE, built from evenly spaced slices of SEARCH_SLICE_SIZE), so the sample
+ * doubles every round and the last round uses the whole input. What is left of the time
+ * budget is split evenly between the remaining rounds and candidates and sets the minimum
+ * measurement time. After a round whole Pareto fronts are kept, starting with the frontier,
+ * until at least half of the measured candidates survive; candidates with errors or slower
+ * than -s are dropped. When the budget runs out the survivors of the last measured round are
+ * reported.
+ */
+
+#include "lzbench.h"
+#include <string.h>
+
+#define SEARCH_SLICE_SIZE   (64*1024)   // samples are built from evenly spaced slices of the input
+#define SEARCH_MIN_SAMPLE   (256*1024)
+
+
+// copies evenly spaced slices of inbuf to sample
+static void build_sample(uint8_t *inbuf, size_t insize, uint8_t *sample, size_t sample_size)
+{
+    size_t slices = (sample_size + SEARCH_SLICE_SIZE - 1) / SEARCH_SLICE_SIZE;
+    size_t step = insize / slices;
+    size_t pos = 0;
+
+    for (size_t i=0; i<slices && pos < sample_size; i++)
+    {
+        size_t len = MIN((size_t)SEARCH_SLICE_SIZE, sample_size - pos);
+        memcpy(sample + pos, inbuf + i*step, len);
+        pos += len;
+    }
+}
+
+
+void lzbench_search(lzbench_params_t *params, std::vector<size_t> &chunk_sizes, const char *namesWithParams, uint8_t *inbuf, size_t insize, uint8_t *compbuf, size_t comprsize, uint8_t *decomp, bench_rate_t rate)
+{
+    std::vector<codec_candidate_t> candidates;
+    std::vector<size_t> alive;
+    std::vector<string_table_t> rows;
+    bench_timer_t start_ticks, now_ticks;
+    std::string filename = params->in_filename ? params->in_filename : "";
+    std::string sample_name;
+    uint8_t *sample = NULL;
+
+    lzbench_expand_codec_list(params, namesWithParams, candidates);
+    if (candidates.empty()) return;
+
+    int rounds = 1;
+    while ((1ULL << (rounds-1)) < candidates.size()) rounds++;
+
+    lzbench_params_t saved = *params;
+    params->c_iters = params->d_iters = 1;
+    params->silent = 1;
+
+    for (size_t i=0; i<candidates.size(); i++)
+        alive.push_back(i);
+
+    uint64_t budget = (uint64_t)params->search_time * 1000000000ULL;
+    GetTime(start_ticks);
+
+    for (int r=0; r<rounds && !alive.empty(); r++)
+    {
+        size_t sample_size = (r == rounds-1) ? insize : MAX(insize >> (rounds-1-r), (size_t)SEARCH_MIN_SAMPLE);
+        uint8_t *buf = inbuf;
+        std::vector<size_t> sample_chunks;
+        std::vector<size_t>* chunks = &chunk_sizes;
+        size_t max_chunk_size = MIN(params->chunk_size, insize);
+
+        GetTime(now_ticks);
+        uint64_t elapsed = GetDiffTime(rate, start_ticks, now_ticks);
+        if (r > 0 && elapsed >= budget) {
+            LZBENCH_STDERR(2, "search: time budget exhausted after %d of %d rounds\n", r, rounds);
+            break;
+        }
+
+        if (sample_size < insize)
+        {
+            if (!sample) sample = (uint8_t*)alloc_and_touch(insize + lzbench_max_padding(), false);
+            if (!sample) { printf("Not enough memory, please use -m option!\n"); g_exit_result = 3; break; }
+            build_sample(inbuf, insize, sample, sample_size);
+            buf = sample;
+            for (size_t left = sample_size; left > 0; left -= MIN(left, params->chunk_size))
+                sample_chunks.push_back(MIN(left, params->chunk_size));
+            chunks = &sample_chunks;
+            max_chunk_size = MIN(params->chunk_size, sample_size);
+            format(sample_name, "%s [sample %llu KB]", filename.c_str(), (unsigned long long)(sample_size >> 10));
+            params->in_filename = sample_name.c_str();
+        }
+        else
+        {
+            sample_size = insize;
+            params->in_filename = saved.in_filename;
+        }
+
+        // split what is left of the budget evenly between the remaining rounds and candidates
+        uint64_t per_candidate = (budget > elapsed ? budget - elapsed : 0) / (rounds - r) / alive.size();
+        params->cmintime = params->dmintime = (uint32_t)(per_candidate / 2 / 1000000);
+        params->cloop_time = params->dloop_time = (uint32_t)MIN((uint64_t)DEFAULT_LOOP_TIME, per_candidate / 8);
+
+        LZBENCH_STDERR(2, "search round %d/%d: %d candidates on %llu KB, %.2fs each     \n", r+1, rounds, (int)alive.size(), (unsigned long long)(sample_size >> 10), per_candidate/1000000000.0);
+
+        std::vector<size_t> measured;
+        rows.clear();
+        for (size_t k=0; k<alive.size(); k++)
+        {
+            const codec_candidate_t& c = candidates[alive[k]];
+            size_t before = params->results.size();
+            lzbench_process_single_codec(params, max_chunk_size, *chunks, c.desc, c.level, c.kv, buf, sample_size, compbuf, comprsize, decomp, rate, c.level);
+            if (params->results.size() == before) continue; // skipped or slower than -s
+            string_table_t row = params->results.back();
+            params->results.pop_back();
+            if (row.col2_ctime == 0 || (row.col3_dtime == 0 && !params->compress_only)) continue; // error
+            measured.push_back(alive[k]);
+            rows.push_back(row);
+        }
+
+        alive = measured;
+        if (r == rounds-1) break;
+
+        // keep whole Pareto fronts until at least half of the candidates survive
+        std::vector<int> rank = pareto_ranks(rows);
+        std::vector<size_t> next;
+        std::vector<string_table_t> next_rows;
+        for (int front=0; next.size() < MAX((size_t)1, (alive.size()+1)/2) || front == 0; front++)
+        {
+            bool any = false;
+            for (size_t k=0; k<alive.size(); k++)
+                if (rank[k] == front) { next.push_back(alive[k]); next_rows.push_back(rows[k]); any = true; }
+            if (!any) break;
+        }
+        LZBENCH_STDERR(3, "search round %d/%d: dropped %d dominated candidates\n", r+1, rounds, (int)(alive.size() - next.size()));
+        alive = next;
+        rows = next_rows;
+    }
+
+    GetTime(now_ticks);
+    params->c_iters = saved.c_iters; params->d_iters = saved.d_iters;
+    params->cmintime = saved.cmintime; params->dmintime = saved.dmintime;
+    params->cloop_time = saved.cloop_time; params->dloop_time = saved.dloop_time;
+    params->silent = saved.silent;
+    params->in_filename = saved.in_filename;
+
+    for (size_t k=0; k<rows.size(); k++)
+    {
+        params->results.push_back(rows[k]);
+        if (params->show_speed)
+            print_speed(params, params->results.back());
+        else
+            print_time(params, params->results.back());
+    }
+
+    if (params->verbose >= 1 && !rows.empty())
+    {
+        std::vector<int> rank = pareto_ranks(rows);
+        int frontier = 0;
+        for (size_t k=0; k<rank.size(); k++) frontier += (rank[k] == 0);
+        printf("\nPareto set: %d of %d candidates in %.1f s\n", frontier, (int)candidates.size(), GetDiffTime(rate, start_ticks, now_ticks)/1000000000.0);
+        for (size_t k=0; k<rows.size(); k++)
+        {
+            if (rank[k] != 0) continue;
+            if (params->show_speed)
+                print_speed(params, rows[k]);
+            else
+                print_time(params, rows[k]);
+        }
+    }
+
+    free(sample);
+}
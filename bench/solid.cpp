@@ -0,0 +1,163 @@
+/*
+ * Copyright (c) Przemyslaw Skibinski <inikep@gmail.com>
+ * All rights reserved.
+ *
+ * This source code is dual-licensed under the GPLv2 and GPLv3 licenses.
+ * For additional details, refer to the LICENSE file located in the root
+ * directory of this source tree.
+ *
+ * solid.cpp: solid vs independent compression of joined files (--solid)
+ *
+ * With -j every file is compressed independently. --solid benchmarks the joined files a second
+ * time as solid blocks: the whole buffer or groups of N consecutive files (-b still splits larger
+ * blocks). The report puts the ratio and speeds of both runs side by side. To show where the
+ * independent overhead comes from, files are put into size buckets and for every bucket the sum
+ * of independently compressed files is compared with the bucket compressed as one solid block
+ * (measured once after the independent run, sizes only).
+ */
+
+#include "lzbench.h"
+#include <string.h>
+
+static const uint64_t bucket_limits[SOLID_BUCKETS] = { 1 << 10, 4 << 10, 64 << 10, (uint64_t)-1 };
+static const char* const bucket_names[SOLID_BUCKETS] = { "< 1 KB", "1-4 KB", "4-64 KB", "> 64 KB" };
+
+
+static int bucket_of(uint64_t size)
+{
+    int b = 0;
+    while (size >= bucket_limits[b]) b++;
+    return b;
+}
+
+
+// compressed size of buf split like the benchmark does (-b and the codec input limit), 0 on error
+static uint64_t compressed_size(lzbench_params_t *params, const compressor_desc_t* desc, codec_options_t *codec_options, const uint8_t* buf, size_t size, std::vector<uint8_t>& out)
+{
+    size_t piece_max = params->chunk_size;
+    uint64_t sum = 0;
+
+    if (desc->max_insize && piece_max > desc->max_insize) piece_max = desc->max_insize;
+    for (size_t pos = 0; pos < size; )
+    {
+        size_t piece = MIN(size - pos, piece_max);
+        if (out.size() < GET_COMPRESS_BOUND(piece)) out.resize(GET_COMPRESS_BOUND(piece));
+        int64_t clen = desc->compress((char*)buf + pos, piece, (char*)&out[0], out.size(), codec_options);
+        if (clen <= 0) return 0;
+        sum += clen;
+        pos += piece;
+    }
+    return sum;
+}
+
+
+/*
+ * Called after the independent run of a codec: compresses every file and every size bucket
+ * (its files concatenated) to split the gap between independent and solid compression.
+ */
+void lzbench_solid_buckets(lzbench_params_t *params, const string_table_t& row, const compressor_desc_t* desc, codec_options_t *codec_options, const uint8_t *inbuf)
+{
+    const std::vector<size_t>& files = params->solid_files;
+    std::vector<uint8_t> bucket_data, out;
+    solid_buckets_t s;
+    const uint8_t* p;
+
+    s.name = row.col1_algname;
+    s.chunk_size = row.chunk_size;
+    memset(s.files, 0, sizeof(s.files));
+    memset(s.size, 0, sizeof(s.size));
+    memset(s.independent, 0, sizeof(s.independent));
+    memset(s.solid, 0, sizeof(s.solid));
+
+    p = inbuf;
+    for (size_t f=0; f<files.size(); p += files[f++])
+    {
+        int b = bucket_of(files[f]);
+        uint64_t clen = compressed_size(params, desc, codec_options, p, files[f], out);
+        if (files[f] && !clen) return;
+        s.files[b]++;
+        s.size[b] += files[f];
+        s.independent[b] += clen;
+    }
+
+    for (int b=0; b<SOLID_BUCKETS; b++)
+    {
+        if (!s.files[b]) continue;
+        bucket_data.clear();
+        p = inbuf;
+        for (size_t f=0; f<files.size(); p += files[f++])
+            if (bucket_of(files[f]) == b)
+                bucket_data.insert(bucket_data.end(), p, p + files[f]);
+        if (bucket_data.empty()) continue;
+        if (!(s.solid[b] = compressed_size(params, desc, codec_options, &bucket_data[0], bucket_data.size(), out))) return;
+    }
+    params->solid_buckets.push_back(s);
+}
+
+
+void lzbench_solid_report(lzbench_params_t *params, const std::string& independent, const std::string& solid)
+{
+    if (params->textformat != NDJSON)
+    {
+        if (params->solid_group)
+            printf("\nIndependent vs solid compression of %s in groups of %u files:\n", independent.c_str(), params->solid_group);
+        else
+            printf("\nIndependent vs solid compression of %s as a whole:\n", independent.c_str());
+    }
+
+    for (size_t i=0; i<params->results.size(); i++)
+    {
+        const string_table_t& r = params->results[i];
+        if (r.col6_filename != independent || !r.col4_comprsize) continue;
+
+        for (size_t j=0; j<params->results.size(); j++)
+        {
+            const string_table_t& s = params->results[j];
+            if (s.col6_filename != solid || s.codec != r.codec || s.level != r.level || s.codec_params != r.codec_params) continue;
+            if (params->chunk_sweep.size() > 1 && s.chunk_size != r.chunk_size) continue;
+
+            if (params->textformat == NDJSON) {
+                printf("{\"type\":\"solid\",\"name\":%s,\"file\":%s,\"chunk_size\":%llu,\"group\":%u,\"size_pct\":%.2f,\"solid_size_pct\":%.2f,\"cspeed\":%.2f,\"solid_cspeed\":%.2f",
+                       json_string(r.col1_algname).c_str(), json_string(independent).c_str(), (unsigned long long)r.chunk_size, params->solid_group,
+                       r.col4_comprsize * 100.0 / r.col5_origsize, s.col4_comprsize * 100.0 / s.col5_origsize,
+                       lzbench_speed(r.col5_origsize, r.col2_ctime), lzbench_speed(s.col5_origsize, s.col2_ctime));
+                if (!params->compress_only)
+                    printf(",\"dspeed\":%.2f,\"solid_dspeed\":%.2f", lzbench_speed(r.col5_origsize, r.col3_dtime), lzbench_speed(s.col5_origsize, s.col3_dtime));
+                printf("}\n");
+                break;
+            }
+            printf("%-23s size %.2f%% -> %.2f%% (solid output %.1f%% smaller), compression %.1f -> %.1f MB/s", r.col1_algname.c_str(),
+                   r.col4_comprsize * 100.0 / r.col5_origsize, s.col4_comprsize * 100.0 / s.col5_origsize,
+                   (1 - (double)s.col4_comprsize / r.col4_comprsize) * 100, lzbench_speed(r.col5_origsize, r.col2_ctime), lzbench_speed(s.col5_origsize, s.col2_ctime));
+            if (!params->compress_only)
+                printf(", decompression %.1f -> %.1f MB/s", lzbench_speed(r.col5_origsize, r.col3_dtime), lzbench_speed(s.col5_origsize, s.col3_dtime));
+            printf("\n");
+            break;
+        }
+
+        for (size_t k=0; k<params->solid_buckets.size(); k++)
+        {
+            const solid_buckets_t& s = params->solid_buckets[k];
+            if (s.name != r.col1_algname || s.chunk_size != r.chunk_size) continue;
+
+            uint64_t gap = 0;
+            for (int b=0; b<SOLID_BUCKETS; b++)
+                gap += s.independent[b] - MIN(s.independent[b], s.solid[b]);
+            for (int b=0; b<SOLID_BUCKETS; b++)
+            {
+                if (!s.files[b]) continue;
+                uint64_t g = s.independent[b] - MIN(s.independent[b], s.solid[b]);
+                if (params->textformat == NDJSON) {
+                    printf("{\"type\":\"solid_bucket\",\"name\":%s,\"file\":%s,\"chunk_size\":%llu,\"bucket\":\"%s\",\"files\":%d,\"size\":%llu,\"compr_size\":%llu,\"solid_compr_size\":%llu,\"overhead\":%llu}\n",
+                           json_string(r.col1_algname).c_str(), json_string(independent).c_str(), (unsigned long long)r.chunk_size, bucket_names[b],
+                           (int)s.files[b], (unsigned long long)s.size[b], (unsigned long long)s.independent[b], (unsigned long long)s.solid[b], (unsigned long long)g);
+                    continue;
+                }
+                printf("  %-8s %6d files %12llu bytes: independent %llu, solid within the bucket %llu, overhead %llu bytes (%.1f%% of all)\n",
+                       bucket_names[b], (int)s.files[b], (unsigned long long)s.size[b], (unsigned long long)s.independent[b],
+                       (unsigned long long)s.solid[b], (unsigned long long)g, gap ? g * 100.0 / gap : 0);
+            }
+            break;
+        }
+    }
+}
@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) Przemyslaw Skibinski <inikep@gmail.com>
+ * All rights reserved.
+ *
+ * This source code is dual-licensed under the GPLv2 and GPLv3 licenses.
+ * For additional details, refer to the LICENSE file located in the root
+ * directory of this source tree.
+ *
+ * state_codecs.h: library calls shared by the wrappers of --stream (stream.cpp) and --dict (dict.cpp)
+ *
+ * Both keep codec state between calls (the history of a stream or a loaded dictionary), so they
+ * call lz4, zstd, zlib, zlib-ng and brotli directly instead of through comp_desc[]. Messages and
+ * records are small, lengths are clamped here to the 32-bit arguments of the libraries.
+ */
+
+#ifndef LZBENCH_STATE_CODECS_H
+#define LZBENCH_STATE_CODECS_H
+
+#include "lzbench.h"
+#include <string.h>
+
+#ifndef BENCH_REMOVE_BROTLI
+#include "brotli/encode.h"
+#include "brotli/decode.h"
+#endif
+#ifndef BENCH_REMOVE_LZ4
+#include "lz/lz4/lib/lz4.h"
+#endif
+#ifndef BENCH_REMOVE_ZLIB
+#include "zlib/zlib.h"
+#endif
+#ifndef BENCH_REMOVE_ZLIB_NG
+#undef z_const
+#undef Z_NULL
+#include "zlib-ng/zlib-ng.h"
+#endif
+#ifndef BENCH_REMOVE_ZSTD
+#include "zstd/lib/zstd.h"
+#endif
+
+
+// the entry of a comp_desc[] codec name in a wrapper table ended by a NULL name
+template <typename desc_t>
+static inline const desc_t* find_state_codec(const desc_t* table, const char* name)
+{
+    for (int i=0; table[i].codec; i++)
+        if (!strcmp(table[i].codec, name)) return &table[i];
+    return NULL;
+}
+
+
+#ifndef BENCH_REMOVE_LZ4
+#define LZ4_OUT_SIZE(outsize) ((int)MIN(outsize, (size_t)LZ4_MAX_INPUT_SIZE))
+
+// compresses one message or record with the history (or the attached dictionary) of stream
+static inline int64_t lz4_compress_continue(LZ4_stream_t* stream, const uint8_t* in, size_t insize, uint8_t* out, size_t outsize, int acceleration)
+{
+    int clen = LZ4_compress_fast_continue(stream, (const char*)in, (char*)out, (int)insize, LZ4_OUT_SIZE(outsize), acceleration);
+    return clen > 0 ? clen : -1;
+}
+#endif
+
+
+#ifndef BENCH_REMOVE_ZSTD
+// the level is a parameter of the context, as ZSTD_compressStream2() and ZSTD_compress2() expect
+static inline ZSTD_CCtx* zstd_create_cctx(int level)
+{
+    ZSTD_CCtx* cctx = ZSTD_createCCtx();
+    if (cctx) ZSTD_CCtx_setParameter(cctx, ZSTD_c_compressionLevel, level);
+    return cctx;
+}
+#endif
+
+
+#if !defined(BENCH_REMOVE_ZLIB) || !defined(BENCH_REMOVE_ZLIB_NG)
+// points a z_stream or zng_stream at one message or record
+template <typename stream_t>
+static inline void zlib_set_buffers(stream_t* s, const uint8_t* in, size_t insize, uint8_t* out, size_t outsize)
+{
+    s->next_in = (uint8_t*)in;
+    s->avail_in = (uint32_t)insize;
+    s->next_out = out;
+    s->avail_out = (uint32_t)MIN(outsize, (size_t)UINT32_MAX);
+}
+#endif
+
+
+#ifndef BENCH_REMOVE_BROTLI
+// runs the encoder until op (BROTLI_OPERATION_FLUSH or _FINISH) is done, -1 when out is full
+static inline int64_t brotli_encode(BrotliEncoderState* s, BrotliEncoderOperation op, const uint8_t* in, size_t insize, uint8_t* out, size_t outsize)
+{
+    size_t avail_in = insize, avail_out = outsize;
+    const uint8_t* next_in = in;
+    uint8_t* next_out = out;
+
+    do {
+        if (!BrotliEncoderCompressStream(s, op, &avail_in, &next_in, &avail_out, &next_out, NULL) || !avail_out) return -1;
+    } while (avail_in || BrotliEncoderHasMoreOutput(s) || (op == BROTLI_OPERATION_FINISH && !BrotliEncoderIsFinished(s)));
+    return outsize - avail_out;
+}
+
+// decodes all of in, the end of the brotli stream has to be reached when last is set
+static inline int64_t brotli_decode(BrotliDecoderState* s, const uint8_t* in, size_t insize, uint8_t* out, size_t outsize, bool last)
+{
+    size_t avail_in = insize, avail_out = outsize;
+    const uint8_t* next_in = in;
+    uint8_t* next_out = out;
+
+    BrotliDecoderResult ret = BrotliDecoderDecompressStream(s, &avail_in, &next_in, &avail_out, &next_out, NULL);
+    if (ret == BROTLI_DECODER_RESULT_ERROR || avail_in || (last && ret != BROTLI_DECODER_RESULT_SUCCESS)) return -1;
+    return outsize - avail_out;
+}
+#endif
+
+#endif
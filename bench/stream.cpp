@@ -0,0 +1,570 @@
+/*
+ * Copyright (c) Przemyslaw Skibinski <inikep@gmail.com>
+ * All rights reserved.
+ *
+ * This source code is dual-licensed under the GPLv2 and GPLv3 licenses.
+ * For additional details, refer to the LICENSE file located in the root
+ * directory of this source tree.
+ *
+ * stream.cpp: small-message stream benchmark with history kept between messages (--stream)
+ *
+ * Every input is cut into messages, of random sizes from a MIN-MAX range (a fixed seed) or at
+ * a delimiter, and every -e codec/level compresses them in order on one long-lived stream,
+ * flushing after every message so that each one can be sent on its own:
+ *   lz4       LZ4_compress_fast_continue() / LZ4_decompress_safe_continue()
+ *   zstd      ZSTD_compressStream2() with ZSTD_e_flush
+ *   zlib      deflate() and inflate() with Z_SYNC_FLUSH, the same for zlib-ng
+ *   brotli    BrotliEncoderCompressStream() with BROTLI_OPERATION_FLUSH
+ * The same messages are also compressed independently with the regular codec functions. The
+ * report compares the ratios and gives latency percentiles of single messages (for every message
+ * the best of STREAM_RUNS passes over the whole stream). Other codecs are skipped.
+ */
+
+#include "lzbench.h"
+#include "state_codecs.h"
+#include "util.h"
+#include <algorithm> // sort
+#include <stdlib.h>
+#include <string.h>
+
+#define STREAM_DEFAULT_CODECS "lz4/zstd,1,3/zlib,1,6/zlib-ng,1,6/brotli,1,5"
+#define STREAM_DEFAULT_MIN    200
+#define STREAM_DEFAULT_MAX    4096
+#define STREAM_MAX_MESSAGE    (1 << 20)  // longer delimited messages are cut
+#define STREAM_OVERHEAD       64         // flush markers and block headers added to a message
+#define STREAM_RUNS           3
+
+typedef void* (*stream_init_func)(int level);
+typedef int64_t (*stream_func)(void* state, const uint8_t* in, size_t insize, uint8_t* out, size_t outsize);
+typedef void (*stream_free_func)(void* state);
+
+typedef struct
+{
+    const char* codec;    // name in comp_desc[]
+    stream_init_func cinit;
+    stream_func compress;
+    stream_free_func cfree;
+    stream_init_func dinit;
+    stream_func decompress;
+    stream_free_func dfree;
+} stream_desc_t;
+
+typedef struct
+{
+    size_t min_size, max_size;
+    int delimiter;        // -1 for random sizes
+} stream_spec_t;
+
+typedef struct
+{
+    uint64_t size, stream_size, independent_size;
+    double c[3], d[3], ic[3], id[3];  // p50, p99 and max latency in us
+} stream_stats_t;
+
+
+#ifndef BENCH_REMOVE_LZ4
+typedef struct
+{
+    LZ4_stream_t stream;
+    int acceleration;
+} lz4_state_t;
+
+static void* lz4_cinit(int level)
+{
+    lz4_state_t* s = (lz4_state_t*)malloc(sizeof(lz4_state_t));
+    if (!s) return NULL;
+    LZ4_initStream(&s->stream, sizeof(s->stream));
+    s->acceleration = MAX(level, 1);
+    return s;
+}
+
+// the history is the previous messages, which stay in place in the input buffer
+static int64_t lz4_compress(void* state, const uint8_t* in, size_t insize, uint8_t* out, size_t outsize)
+{
+    lz4_state_t* s = (lz4_state_t*)state;
+    return lz4_compress_continue(&s->stream, in, insize, out, outsize, s->acceleration);
+}
+
+static void* lz4_dinit(int)
+{
+    LZ4_streamDecode_t* s = (LZ4_streamDecode_t*)malloc(sizeof(LZ4_streamDecode_t));
+    if (s) LZ4_setStreamDecode(s, NULL, 0);
+    return s;
+}
+
+// messages are decoded one after another into one buffer, so the history stays in place
+static int64_t lz4_decompress(void* state, const uint8_t* in, size_t insize, uint8_t* out, size_t outsize)
+{
+    return LZ4_decompress_safe_continue((LZ4_streamDecode_t*)state, (const char*)in, (char*)out, (int)insize, LZ4_OUT_SIZE(outsize));
+}
+#endif
+
+
+#ifndef BENCH_REMOVE_ZSTD
+static void* zstd_cinit(int level) { return zstd_create_cctx(level); }
+
+static int64_t zstd_compress(void* state, const uint8_t* in, size_t insize, uint8_t* out, size_t outsize)
+{
+    ZSTD_inBuffer input = { in, insize, 0 };
+    ZSTD_outBuffer output = { out, outsize, 0 };
+
+    while (true)
+    {
+        size_t remaining = ZSTD_compressStream2((ZSTD_CCtx*)state, &output, &input, ZSTD_e_flush);
+        if (ZSTD_isError(remaining)) return -1;
+        if (remaining == 0) return output.pos;
+        if (output.pos == output.size) return -1;
+    }
+}
+
+static void zstd_cfree(void* state) { ZSTD_freeCCtx((ZSTD_CCtx*)state); }
+static void* zstd_dinit(int) { return ZSTD_createDCtx(); }
+
+static int64_t zstd_decompress(void* state, const uint8_t* in, size_t insize, uint8_t* out, size_t outsize)
+{
+    ZSTD_inBuffer input = { in, insize, 0 };
+    ZSTD_outBuffer output = { out, outsize, 0 };
+
+    while (input.pos < input.size || output.pos < output.size)
+    {
+        size_t in_pos = input.pos, out_pos = output.pos;
+        if (ZSTD_isError(ZSTD_decompressStream((ZSTD_DCtx*)state, &output, &input))) return -1;
+        if (input.pos == in_pos && output.pos == out_pos) break; // everything flushed is decoded
+    }
+    return output.pos;
+}
+
+static void zstd_dfree(void* state) { ZSTD_freeDCtx((ZSTD_DCtx*)state); }
+#endif
+
+
+#if !defined(BENCH_REMOVE_ZLIB) || !defined(BENCH_REMOVE_ZLIB_NG)
+/*
+ * The same functions for zlib and zlib-ng: a sync flush ends every message on a byte boundary
+ * with an empty stored block. Messages are at most STREAM_MAX_MESSAGE, so lengths fit 32 bits.
+ */
+#define ZLIB_STREAM_FUNCS(prefix, stream_t, deflateInit_f, deflate_f, deflateEnd_f, inflateInit_f, inflate_f, inflateEnd_f) \
+static void* prefix##_cinit(int level) \
+{ \
+    stream_t* s = (stream_t*)calloc(1, sizeof(stream_t)); \
+    if (s && deflateInit_f(s, level) != Z_OK) { free(s); s = NULL; } \
+    return s; \
+} \
+static int64_t prefix##_compress(void* state, const uint8_t* in, size_t insize, uint8_t* out, size_t outsize) \
+{ \
+    stream_t* s = (stream_t*)state; \
+    zlib_set_buffers(s, in, insize, out, outsize); \
+    if (deflate_f(s, Z_SYNC_FLUSH) != Z_OK || s->avail_in || !s->avail_out) return -1; \
+    return s->next_out - out; \
+} \
+static void prefix##_cfree(void* state) { deflateEnd_f((stream_t*)state); free(state); } \
+static void* prefix##_dinit(int) \
+{ \
+    stream_t* s = (stream_t*)calloc(1, sizeof(stream_t)); \
+    if (s && inflateInit_f(s) != Z_OK) { free(s); s = NULL; } \
+    return s; \
+} \
+static int64_t prefix##_decompress(void* state, const uint8_t* in, size_t insize, uint8_t* out, size_t outsize) \
+{ \
+    stream_t* s = (stream_t*)state; \
+    zlib_set_buffers(s, in, insize, out, outsize); \
+    int ret = inflate_f(s, Z_SYNC_FLUSH); \
+    if ((ret != Z_OK && ret != Z_STREAM_END) || s->avail_in) return -1; \
+    return s->next_out - out; \
+} \
+static void prefix##_dfree(void* state) { inflateEnd_f((stream_t*)state); free(state); }
+#endif
+
+#ifndef BENCH_REMOVE_ZLIB
+ZLIB_STREAM_FUNCS(zlib, z_stream, deflateInit, deflate, deflateEnd, inflateInit, inflate, inflateEnd)
+#endif
+#ifndef BENCH_REMOVE_ZLIB_NG
+ZLIB_STREAM_FUNCS(zlib_ng, zng_stream, zng_deflateInit, zng_deflate, zng_deflateEnd, zng_inflateInit, zng_inflate, zng_inflateEnd)
+#endif
+
+
+#ifndef BENCH_REMOVE_BROTLI
+static void* brotli_cinit(int level)
+{
+    BrotliEncoderState* s = BrotliEncoderCreateInstance(NULL, NULL, NULL);
+    if (s) BrotliEncoderSetParameter(s, BROTLI_PARAM_QUALITY, level);
+    return s;
+}
+
+static int64_t brotli_compress(void* state, const uint8_t* in, size_t insize, uint8_t* out, size_t outsize)
+{
+    return brotli_encode((BrotliEncoderState*)state, BROTLI_OPERATION_FLUSH, in, insize, out, outsize);
+}
+
+static void brotli_cfree(void* state) { BrotliEncoderDestroyInstance((BrotliEncoderState*)state); }
+static void* brotli_dinit(int) { return BrotliDecoderCreateInstance(NULL, NULL, NULL); }
+
+static int64_t brotli_decompress(void* state, const uint8_t* in, size_t insize, uint8_t* out, size_t outsize)
+{
+    return brotli_decode((BrotliDecoderState*)state, in, insize, out, outsize, false);
+}
+
+static void brotli_dfree(void* state) { BrotliDecoderDestroyInstance((BrotliDecoderState*)state); }
+#endif
+
+
+static const stream_desc_t stream_codecs[] =
+{
+#ifndef BENCH_REMOVE_LZ4
+    { "lz4",      lz4_cinit,     lz4_compress,     free,          lz4_dinit,     lz4_decompress,     free },
+    { "lz4fast",  lz4_cinit,     lz4_compress,     free,          lz4_dinit,     lz4_decompress,     free },
+#endif
+#ifndef BENCH_REMOVE_ZSTD
+    { "zstd",     zstd_cinit,    zstd_compress,    zstd_cfree,    zstd_dinit,    zstd_decompress,    zstd_dfree },
+#endif
+#ifndef BENCH_REMOVE_ZLIB
+    { "zlib",     zlib_cinit,    zlib_compress,    zlib_cfree,    zlib_dinit,    zlib_decompress,    zlib_dfree },
+#endif
+#ifndef BENCH_REMOVE_ZLIB_NG
+    { "zlib-ng",  zlib_ng_cinit, zlib_ng_compress, zlib_ng_cfree, zlib_ng_dinit, zlib_ng_decompress, zlib_ng_dfree },
+#endif
+#ifndef BENCH_REMOVE_BROTLI
+    { "brotli",   brotli_cinit,  brotli_compress,  brotli_cfree,  brotli_dinit,  brotli_decompress,  brotli_dfree },
+#endif
+    { NULL, NULL, NULL, NULL, NULL, NULL, NULL }
+};
+
+
+// SPEC is MIN-MAX (message sizes in bytes) or delim=C with a character, \n, \r, \t, \0 or 0xHH
+static bool parse_spec(const char* text, stream_spec_t& spec)
+{
+    char* end;
+
+    spec.min_size = STREAM_DEFAULT_MIN;
+    spec.max_size = STREAM_DEFAULT_MAX;
+    spec.delimiter = -1;
+    if (!text) return true;
+
+    if (!strncmp(text, "delim=", 6)) {
+        const char* c = text + 6;
+        if (c[0] && !c[1]) spec.delimiter = (uint8_t)c[0];
+        else if (c[0] == '\\' && c[1] && !c[2]) {
+            switch (c[1]) {
+                case 'n': spec.delimiter = '\n'; break;
+                case 'r': spec.delimiter = '\r'; break;
+                case 't': spec.delimiter = '\t'; break;
+                case '0': spec.delimiter = 0; break;
+            }
+        }
+        else if (!strncmp(c, "0x", 2) && c[2]) {
+            unsigned long value = strtoul(c + 2, &end, 16);
+            if (*end == 0 && value < 256) spec.delimiter = (int)value;
+        }
+        return spec.delimiter >= 0;
+    }
+
+    spec.min_size = strtoul(text, &end, 10);
+    if (*end != '-') return false;
+    spec.max_size = strtoul(end + 1, &end, 10);
+    return *end == 0 && spec.min_size >= 1 && spec.min_size <= spec.max_size && spec.max_size <= STREAM_MAX_MESSAGE;
+}
+
+
+bool lzbench_stream_spec_valid(const char* text)
+{
+    stream_spec_t spec;
+    if (parse_spec(text, spec)) return true;
+    fprintf(stderr, "--stream: expected MIN-MAX message sizes of 1 to %d bytes or delim=C (a character, \\n, \\r, \\t, \\0 or 0xHH)\n", STREAM_MAX_MESSAGE);
+    return false;
+}
+
+
+// splitmix64, with a fixed seed every codec and every run gets the same messages
+static uint64_t next_random(uint64_t& state)
+{
+    uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+
+// the sizes of messages of inbuf; a delimiter ends the message it belongs to
+static void split_messages(const stream_spec_t& spec, const uint8_t* inbuf, size_t insize, std::vector<size_t>& sizes)
+{
+    uint64_t seed = 0;
+
+    for (size_t pos = 0; pos < insize; )
+    {
+        size_t size;
+        if (spec.delimiter >= 0) {
+            const uint8_t* p = (const uint8_t*)memchr(inbuf + pos, spec.delimiter, MIN(insize - pos, (size_t)STREAM_MAX_MESSAGE));
+            size = p ? p - (inbuf + pos) + 1 : MIN(insize - pos, (size_t)STREAM_MAX_MESSAGE);
+        } else {
+            size = spec.min_size + (size_t)(next_random(seed) % (spec.max_size - spec.min_size + 1));
+            size = MIN(size, insize - pos);
+        }
+        sizes.push_back(size);
+        pos += size;
+    }
+}
+
+
+static void percentiles(std::vector<uint64_t>& times, double* out)
+{
+    std::sort(times.begin(), times.end());
+    for (int i=0; i<3; i++) out[i] = 0;
+    if (times.empty()) return;
+    out[0] = times[(size_t)(0.5 * (times.size() - 1) + 0.5)] / 1000.0;
+    out[1] = times[(size_t)(0.99 * (times.size() - 1) + 0.5)] / 1000.0;
+    out[2] = times.back() / 1000.0;
+}
+
+
+static void keep_best(std::vector<uint64_t>& best, size_t i, int run, uint64_t nanosec)
+{
+    if (run == 0 || nanosec < best[i]) best[i] = nanosec;
+}
+
+
+/*
+ * Compresses the messages in order on one stream and decompresses them in order, STREAM_RUNS
+ * times with a new state each time. Returns false after printing an error.
+ */
+static bool run_stream(lzbench_params_t *params, const stream_desc_t* sd, int level, const char* name, const uint8_t* inbuf, size_t insize,
+                       const std::vector<size_t>& sizes, uint8_t* compbuf, size_t compsize, uint8_t* decomp, stream_stats_t& st, bench_rate_t rate)
+{
+    bench_timer_t start_ticks, end_ticks;
+    std::vector<uint64_t> ctimes(sizes.size()), dtimes(sizes.size());
+    std::vector<size_t> csizes(sizes.size());
+
+    for (int r=0; r<STREAM_RUNS; r++)
+    {
+        void* state = sd->cinit(level);
+        size_t inpos = 0, outpos = 0;
+        if (!state) { fprintf(stderr, "%s: --stream compression init error\n", name); return false; }
+        for (size_t i=0; i<sizes.size(); i++)
+        {
+            GetTime(start_ticks);
+            int64_t clen = sd->compress(state, inbuf + inpos, sizes[i], compbuf + outpos, compsize - outpos);
+            GetTime(end_ticks);
+            if (clen <= 0) {
+                fprintf(stderr, "%s: --stream compression error in message %llu\n", name, (unsigned long long)i);
+                sd->cfree(state);
+                return false;
+            }
+            keep_best(ctimes, i, r, GetDiffTime(rate, start_ticks, end_ticks));
+            csizes[i] = clen;
+            inpos += sizes[i];
+            outpos += clen;
+        }
+        sd->cfree(state);
+        st.stream_size = outpos;
+
+        if (params->compress_only) continue;
+        state = sd->dinit(level);
+        if (!state) { fprintf(stderr, "%s: --stream decompression init error\n", name); return false; }
+        memset(decomp, 0, insize);
+        inpos = outpos = 0;
+        for (size_t i=0; i<sizes.size(); i++)
+        {
+            GetTime(start_ticks);
+            int64_t dlen = sd->decompress(state, compbuf + inpos, csizes[i], decomp + outpos, insize - outpos);
+            GetTime(end_ticks);
+            if (dlen != (int64_t)sizes[i] || memcmp(inbuf + outpos, decomp + outpos, sizes[i]) != 0) {
+                fprintf(stderr, "%s: --stream decompression error in message %llu\n", name, (unsigned long long)i);
+                sd->dfree(state);
+                return false;
+            }
+            keep_best(dtimes, i, r, GetDiffTime(rate, start_ticks, end_ticks));
+            inpos += csizes[i];
+            outpos += sizes[i];
+        }
+        sd->dfree(state);
+    }
+
+    percentiles(ctimes, st.c);
+    if (!params->compress_only) percentiles(dtimes, st.d);
+    return true;
+}
+
+
+/*
+ * Every message compressed and decompressed on its own with the regular codec functions;
+ * messages a codec fails to compress (e.g. zlib with output larger than input) are sent raw.
+ */
+static bool run_independent(lzbench_params_t *params, const codec_candidate_t& c, const char* name, const uint8_t* inbuf, size_t insize,
+                            const std::vector<size_t>& sizes, size_t max_message, uint8_t* compbuf, size_t compsize, uint8_t* decomp, stream_stats_t& st, bench_rate_t rate)
+{
+    bench_timer_t start_ticks, end_ticks;
+    std::vector<uint64_t> ctimes(sizes.size()), dtimes(sizes.size());
+    std::vector<size_t> csizes(sizes.size());
+    char* workmem = c.desc->init ? c.desc->init(max_message, c.level, c.desc->additional_param) : NULL;
+    codec_options_t codec_options = { c.level, c.desc->additional_param, workmem, 0, NULL };
+    bool ok = true;
+
+    for (int r=0; r<STREAM_RUNS && ok; r++)
+    {
+        size_t inpos = 0, outpos = 0, raw = 0;
+        for (size_t i=0; i<sizes.size(); i++)
+        {
+            GetTime(start_ticks);
+            int64_t clen = c.desc->compress((char*)inbuf + inpos, sizes[i], (char*)compbuf + outpos, compsize - outpos, &codec_options);
+            GetTime(end_ticks);
+            keep_best(ctimes, i, r, GetDiffTime(rate, start_ticks, end_ticks));
+            csizes[i] = (clen > 0) ? clen : 0;
+            inpos += sizes[i];
+            outpos += csizes[i];
+            raw += (clen > 0) ? 0 : sizes[i];
+        }
+        st.independent_size = outpos + raw;
+
+        inpos = outpos = 0;
+        for (size_t i=0; i<sizes.size() && ok && !params->compress_only; i++)
+        {
+            int64_t dlen = sizes[i];
+            GetTime(start_ticks);
+            if (csizes[i]) dlen = c.desc->decompress((char*)compbuf + inpos, csizes[i], (char*)decomp + outpos, sizes[i], &codec_options);
+            else memcpy(decomp + outpos, inbuf + outpos, sizes[i]);
+            GetTime(end_ticks);
+            if (dlen != (int64_t)sizes[i] || memcmp(inbuf + outpos, decomp + outpos, sizes[i]) != 0) {
+                fprintf(stderr, "%s: decompression error in message %llu\n", name, (unsigned long long)i);
+                ok = false;
+                break;
+            }
+            keep_best(dtimes, i, r, GetDiffTime(rate, start_ticks, end_ticks));
+            inpos += csizes[i];
+            outpos += sizes[i];
+        }
+    }
+
+    if (c.desc->deinit) c.desc->deinit(workmem);
+    percentiles(ctimes, st.ic);
+    if (!params->compress_only) percentiles(dtimes, st.id);
+    return ok;
+}
+
+
+static void print_stream_row(lzbench_params_t *params, const std::string& name, const char* filename, size_t messages, const stream_stats_t& st)
+{
+    double saved = st.independent_size ? (1 - (double)st.stream_size / st.independent_size) * 100 : 0;
+
+    if (params->textformat == NDJSON) {
+        printf("{\"type\":\"stream\",\"name\":%s,\"file\":%s,\"messages\":%llu,\"orig_size\":%llu,\"stream_size\":%llu,\"independent_size\":%llu",
+               json_string(name).c_str(), json_string(filename).c_str(), (unsigned long long)messages, (unsigned long long)st.size,
+               (unsigned long long)st.stream_size, (unsigned long long)st.independent_size);
+        printf(",\"clat_us\":[%.3f,%.3f,%.3f],\"dlat_us\":[%.3f,%.3f,%.3f],\"independent_clat_us\":[%.3f,%.3f,%.3f],\"independent_dlat_us\":[%.3f,%.3f,%.3f]}\n",
+               st.c[0], st.c[1], st.c[2], st.d[0], st.d[1], st.d[2], st.ic[0], st.ic[1], st.ic[2], st.id[0], st.id[1], st.id[2]);
+        return;
+    }
+
+    printf("%-23s %7.2f%% %7.2f%% %6.1f%%  %7.2f %7.2f", name.c_str(), st.stream_size * 100.0 / st.size, st.independent_size * 100.0 / st.size, saved, st.c[0], st.c[1]);
+    if (!params->compress_only) printf("  %7.2f %7.2f", st.d[0], st.d[1]);
+    printf("  %7.2f", st.ic[0]);
+    if (!params->compress_only) printf(" %7.2f", st.id[0]);
+    printf("\n");
+}
+
+
+int lzbench_stream(lzbench_params_t *params, const char** inFileNames, unsigned ifnIdx, char* encoder_list, const char* spec_text)
+{
+    std::vector<codec_candidate_t> all, candidates;
+    std::vector<const stream_desc_t*> stream_descs;
+    stream_spec_t spec;
+    bench_rate_t rate;
+
+    InitTimer(rate);
+    parse_spec(spec_text, spec);
+    lzbench_expand_codec_list(params, encoder_list ? encoder_list : STREAM_DEFAULT_CODECS, all);
+    for (size_t k=0; k<all.size(); k++)
+    {
+        const stream_desc_t* sd = find_state_codec(stream_codecs, all[k].desc->name);
+        if (!sd) {
+            fprintf(stderr, "--stream: %s is not supported (use lz4, lz4fast, zstd, zlib, zlib-ng or brotli), skipped\n", all[k].desc->name);
+            continue;
+        }
+        if (!all[k].kv.empty())
+            fprintf(stderr, "warning: --stream ignores parameters of %s\n", all[k].desc->name);
+        candidates.push_back(all[k]);
+        stream_descs.push_back(sd);
+    }
+    if (candidates.empty()) return 1;
+
+    for (unsigned i=0; i<ifnIdx; i++)
+    {
+        FILE* in;
+        if (UTIL_isDirectory(inFileNames[i])) {
+            fprintf(stderr, "warning: use -r to process directories (%s)\n", inFileNames[i]);
+            continue;
+        }
+        if (!(in = fopen(inFileNames[i], "rb"))) {
+            perror(inFileNames[i]);
+            continue;
+        }
+
+        fseeko(in, 0L, SEEK_END);
+        size_t insize = ftello(in);
+        rewind(in);
+
+        std::vector<size_t> sizes;
+        uint8_t* inbuf = (uint8_t*)alloc_and_touch(insize + lzbench_max_padding(), false);
+        uint8_t* decomp = (uint8_t*)alloc_and_touch(insize + lzbench_max_padding(), false);
+        size_t compsize = 0;
+        uint8_t* compbuf = NULL;
+        if (inbuf && decomp)
+        {
+            insize = fread(inbuf, 1, insize, in);
+            split_messages(spec, inbuf, insize, sizes);
+            compsize = GET_COMPRESS_BOUND(insize) + sizes.size() * STREAM_OVERHEAD;
+            compbuf = (uint8_t*)alloc_and_touch(compsize, false);
+        }
+        fclose(in);
+        if (!compbuf)
+        {
+            printf("Not enough memory!");
+            free(inbuf);
+            free(decomp);
+            return 3;
+        }
+
+        const char* pch = strrchr(inFileNames[i], '\\');
+        const char* filename = pch ? pch+1 : inFileNames[i];
+        size_t max_message = 0;
+        for (size_t m=0; m<sizes.size(); m++) max_message = MAX(max_message, sizes[m]);
+
+        if (params->textformat != NDJSON && !sizes.empty()) {
+            if (spec.delimiter >= 0)
+                printf("\nMessage stream of %s: %llu messages ended by 0x%02X (avg %llu bytes), history kept between messages:\n", filename,
+                       (unsigned long long)sizes.size(), spec.delimiter, (unsigned long long)(insize / sizes.size()));
+            else
+                printf("\nMessage stream of %s: %llu messages of %llu-%llu bytes (avg %llu), history kept between messages:\n", filename,
+                       (unsigned long long)sizes.size(), (unsigned long long)spec.min_size, (unsigned long long)spec.max_size, (unsigned long long)(insize / sizes.size()));
+            printf("%-23s %8s %8s %7s  %15s", "Compressor name", "Stream", "Indep.", "Saved", "c p50/p99 us");
+            if (!params->compress_only) printf("  %15s", "d p50/p99 us");
+            printf("  %s\n", params->compress_only ? "indep c p50" : "indep c/d p50");
+        }
+
+        for (size_t k=0; k<candidates.size() && !sizes.empty(); k++)
+        {
+            const codec_candidate_t& c = candidates[k];
+            std::string name;
+            stream_stats_t st;
+
+            if (c.desc->first_level == 0 && c.desc->last_level == 0)
+                format(name, "%s", c.desc->name_version);
+            else
+                format(name, "%s -%d", c.desc->name_version, c.level);
+            memset(&st, 0, sizeof(st));
+            st.size = insize;
+
+            LZBENCH_STDERR(2, "%s streaming %s     \r", name.c_str(), filename);
+            if (!run_stream(params, stream_descs[k], c.level, name.c_str(), inbuf, insize, sizes, compbuf, compsize, decomp, st, rate)
+                || !run_independent(params, c, name.c_str(), inbuf, insize, sizes, max_message, compbuf, compsize, decomp, st, rate)) {
+                g_exit_result = 10;
+                continue;
+            }
+            print_stream_row(params, name, filename, sizes.size(), st);
+        }
+
+        free(inbuf);
+        free(decomp);
+        free(compbuf);
+    }
+
+    return g_exit_result;
+}
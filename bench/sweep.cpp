@@ -0,0 +1,159 @@
+/*
+ * Copyright (c) Przemyslaw Skibinski <inikep@gmail.com>
+ * All rights reserved.
+ *
+ * This source code is dual-licensed under the GPLv2 and GPLv3 licenses.
+ * For additional details, refer to the LICENSE file located in the root
+ * directory of this source tree.
+ *
+ * sweep.cpp: chunk size sweep report (-b with a list of sizes)
+ *
+ * For every file and codec/level/parameters the results are printed as a curve over
+ * chunk sizes. The chunk size with the best ratio among those that reach --sweep-floor
+ * is marked with '*'. With -o7 every curve is a "sweep" record with the best chunk size;
+ * -o4 (CSV) and -o8 (HTML) leave the report out.
+ */
+
+#include "lzbench.h"
+#include <algorithm> // find
+#include <stdlib.h>  // strtoul
+
+#define SWEEP_MAX_FLOOR 1000000  // MB/s
+
+
+// --sweep-floor=C[,D]: minimum compression and decompression speeds in MB/s
+bool lzbench_sweep_floor_parse(const char* text, lzbench_params_t *params)
+{
+    char* end;
+    unsigned long cspeed = strtoul(text, &end, 10), dspeed = 0;
+    bool ok = end != text;
+
+    if (ok && *end == ',') {
+        const char* d = end + 1;
+        dspeed = strtoul(d, &end, 10);
+        ok = end != d;
+    }
+    if (!ok || *end != 0 || cspeed > SWEEP_MAX_FLOOR || dspeed > SWEEP_MAX_FLOOR) {
+        fprintf(stderr, "--sweep-floor: expected C[,D] with speeds of 0 to %d MB/s\n", SWEEP_MAX_FLOOR);
+        return false;
+    }
+    params->sweep_cspeed = (uint32_t)cspeed;
+    params->sweep_dspeed = (uint32_t)dspeed;
+    return true;
+}
+
+
+static void print_speed_cell(double speed)
+{
+    if (speed == 0) printf("      ERROR");
+    else if (speed < 10) printf("%6.2f MB/s", speed);
+    else if (speed < 100) printf("%6.1f MB/s", speed);
+    else printf("%6d MB/s", (int)speed);
+}
+
+
+// the row with the best ratio among those that reach --sweep-floor, -1 if none does
+static int best_of_curve(lzbench_params_t *params, const std::vector<const string_table_t*>& rows)
+{
+    int best = -1;
+    for (size_t i=0; i<rows.size(); i++)
+    {
+        const string_table_t& r = *rows[i];
+        double cspeed = r.col2_ctime ? r.col5_origsize * 1000.0 / r.col2_ctime : 0;
+        double dspeed = r.col3_dtime ? r.col5_origsize * 1000.0 / r.col3_dtime : 0;
+        if (!cspeed || (!dspeed && !params->compress_only)) continue;
+        if (cspeed < params->sweep_cspeed || (dspeed < params->sweep_dspeed && !params->compress_only)) continue;
+        if (best < 0 || r.col4_comprsize < rows[best]->col4_comprsize)
+            best = (int)i;
+    }
+    return best;
+}
+
+
+static std::string curve_name(const std::vector<const string_table_t*>& rows)
+{
+    std::string name = rows[0]->col1_algname;
+    size_t suffix = name.rfind(" b=");
+    if (suffix != std::string::npos) name.erase(suffix);
+    return name;
+}
+
+
+static void print_curve(lzbench_params_t *params, const std::vector<const string_table_t*>& rows)
+{
+    int best = best_of_curve(params, rows);
+
+    printf("%s\n", curve_name(rows).c_str());
+
+    for (size_t i=0; i<rows.size(); i++)
+    {
+        const string_table_t& r = *rows[i];
+        std::string size = format_chunk_size(r.chunk_size);
+        printf("  %-11s", size.c_str() + 3);
+        print_speed_cell(r.col2_ctime ? r.col5_origsize * 1000.0 / r.col2_ctime : 0);
+        print_speed_cell(r.col3_dtime ? r.col5_origsize * 1000.0 / r.col3_dtime : 0);
+        printf("%12llu %6.2f%s\n", (unsigned long long)r.col4_comprsize, r.col4_comprsize * 100.0 / r.col5_origsize, (int)i == best ? "  *" : "");
+    }
+    if (best < 0)
+        printf("  no chunk size reaches the speed floor\n");
+}
+
+
+// one NDJSON record per curve, the rows themselves are already printed as "result" records
+static void print_json_curve(lzbench_params_t *params, const std::vector<const string_table_t*>& rows)
+{
+    int best = best_of_curve(params, rows);
+
+    printf("{\"type\":\"sweep\",\"name\":%s,\"file\":%s,\"chunk_sizes\":[", json_string(curve_name(rows)).c_str(), json_string(rows[0]->col6_filename).c_str());
+    for (size_t i=0; i<rows.size(); i++)
+        printf("%s%llu", i ? "," : "", (unsigned long long)rows[i]->chunk_size);
+    printf("],\"cspeed_floor\":%u,\"dspeed_floor\":%u,\"best_chunk_size\":", params->sweep_cspeed, params->sweep_dspeed);
+    if (best < 0)
+        printf("null}\n");
+    else
+        printf("%llu}\n", (unsigned long long)rows[best]->chunk_size);
+}
+
+
+void lzbench_sweep_report(lzbench_params_t *params)
+{
+    std::vector<std::string> files;
+
+    for (size_t i=0; i<params->results.size(); i++)
+        if (std::find(files.begin(), files.end(), params->results[i].col6_filename) == files.end())
+            files.push_back(params->results[i].col6_filename);
+
+    for (size_t f=0; f<files.size(); f++)
+    {
+        std::vector<bool> done(params->results.size(), false);
+
+        if (params->textformat != NDJSON) {
+            printf("\nChunk size sweep for %s, '*' = the best ratio", files[f].c_str());
+            if (params->sweep_cspeed || params->sweep_dspeed)
+                printf(" with compression >= %u MB/s and decompression >= %u MB/s", params->sweep_cspeed, params->sweep_dspeed);
+            printf(":\nChunk size    Compress. Decompress. Compr. size  Ratio\n");
+        }
+
+        // results are grouped by codec/level/parameters in order of appearance, chunk sizes are ascending
+        for (size_t i=0; i<params->results.size(); i++)
+        {
+            const string_table_t& first = params->results[i];
+            if (done[i] || first.col6_filename != files[f]) continue;
+
+            std::vector<const string_table_t*> curve;
+            for (size_t j=i; j<params->results.size(); j++)
+            {
+                const string_table_t& r = params->results[j];
+                if (!done[j] && r.col6_filename == files[f] && r.codec == first.codec && r.level == first.level && r.codec_params == first.codec_params)
+                {
+                    curve.push_back(&r);
+                    done[j] = true;
+                }
+            }
+            if (params->textformat == NDJSON)
+                print_json_curve(params, curve);
+            else
+                print_curve(params, curve);
+        }
+    }
+}